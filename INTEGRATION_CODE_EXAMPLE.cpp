@@ -54,8 +54,8 @@ void MainWindow::setupUI()
     SecurityIntelligenceCenter *secCenter = qobject_cast<SecurityIntelligenceCenter*>(securityPage);
     if (secCenter) {
         connect(secCenter, &SecurityIntelligenceCenter::threatDetected, 
-                this, [](QString module, int severity) {
-            qDebug() << "⚠️ Threat detected in" << module << "- Severity:" << severity;
+                this, [](QString module, int severity, double score) {
+            qDebug() << "⚠️ Threat detected in" << module << "- Severity:" << severity << "- Score:" << score;
         });
         
         connect(secCenter, &SecurityIntelligenceCenter::riskUpdated, 
@@ -1,4 +1,4 @@
-QT       += core gui charts
+QT       += core gui charts network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -18,7 +18,40 @@ SOURCES += \
     analyticsmodule.cpp \
     cityintelligencemodule.cpp \
     smartstationpage.cpp \
-    smarthomesecuritypage.cpp
+    smarthomesecuritypage.cpp \
+    energyaccountingengine.cpp \
+    stationoccupancyengine.cpp \
+    rfidingest.cpp \
+    rfidlogmodel.cpp \
+    transitscheduleengine.cpp \
+    recyclingmodel.cpp \
+    lightingmodel.cpp \
+    simulationthread.cpp \
+    cityeventbus.cpp \
+    threatruleengine.cpp \
+    anomalydetector.cpp \
+    livenesstracker.cpp \
+    citystabilitymodel.cpp \
+    riskforecaster.cpp \
+    forecastthread.cpp \
+    recommendationengine.cpp \
+    whatifsimulator.cpp \
+    actionexecutor.cpp \
+    routeoptimizer.cpp \
+    fillratepredictor.cpp \
+    rewardsledger.cpp \
+    spatialindex.cpp \
+    citylayout.cpp \
+    citymapwidget.cpp \
+    heatmaplayer.cpp \
+    uiupdatescheduler.cpp \
+    pagelifecycle.cpp \
+    tickdriver.cpp \
+    metricsregistry.cpp \
+    performancehud.cpp \
+    metricsserver.cpp \
+    tracer.cpp \
+    cityconditions.cpp
 
 HEADERS += \
     mainwindow.h \
@@ -29,7 +62,42 @@ HEADERS += \
     analyticsmodule.h \
     cityintelligencemodule.h \
     smartstationpage.h \
-    smarthomesecuritypage.h
+    smarthomesecuritypage.h \
+    energyaccountingengine.h \
+    stationoccupancyengine.h \
+    rfidingest.h \
+    rfidlogmodel.h \
+    transitscheduleengine.h \
+    snapshotbuffer.h \
+    recyclingmodel.h \
+    lightingmodel.h \
+    simulationthread.h \
+    cityeventbus.h \
+    threatruleengine.h \
+    anomalydetector.h \
+    livenesstracker.h \
+    citystabilitymodel.h \
+    riskforecaster.h \
+    forecastthread.h \
+    recommendationengine.h \
+    whatifsimulator.h \
+    actionexecutor.h \
+    routeoptimizer.h \
+    fillratepredictor.h \
+    rewardsledger.h \
+    spatialindex.h \
+    citylayout.h \
+    citymapwidget.h \
+    heatmaplayer.h \
+    uiupdatescheduler.h \
+    pagelifecycle.h \
+    tickdriver.h \
+    metricsregistry.h \
+    performancehud.h \
+    metricsserver.h \
+    tracer.h \
+    spscqueue.h \
+    cityconditions.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,184 @@
+#include "actionexecutor.h"
+#include "simulationthread.h"
+#include "cityconditions.h"
+#include "citylayout.h"
+#include "metricsregistry.h"
+#include <QDateTime>
+#include <QMutexLocker>
+
+ActionExecutor::ActionExecutor(SimulationThread *simulation, CityConditions *conditions, QObject *parent)
+    : QObject(parent)
+    , m_simulation(simulation)
+    , m_conditions(conditions)
+    , m_stability(CityStabilityModel::instance())
+    , m_nextId(1)
+{
+    m_batchTimer = new QTimer(this);
+    m_batchTimer->setSingleShot(true);
+    m_batchTimer->setInterval(BATCH_MS);
+    connect(m_batchTimer, &QTimer::timeout, this, &ActionExecutor::flush);
+
+    // Only runs while commands are in flight
+    m_pollTimer = new QTimer(this);
+    m_pollTimer->setInterval(POLL_MS);
+    connect(m_pollTimer, &QTimer::timeout, this, &ActionExecutor::poll);
+    
+    m_inFlightMetric = MetricsRegistry::instance()->gauge("queue_depth", "Actions");
+}
+
+quint64 ActionExecutor::submit(const Recommendation &recommendation, const QString &source)
+{
+    const int candidate = recommendation.zone * RecommendationEngine::ACTION_COUNT + recommendation.action;
+    quint64 existing = m_candidateCommand.value(candidate, 0);
+    if (existing != 0) {
+        QStringList &sources = m_tracked[existing].sources;
+        if (!sources.contains(source)) sources.append(source);
+        return existing;
+    }
+
+    ActionOutcome outcome;
+    outcome.id = m_nextId++;
+    outcome.action = recommendation.action;
+    outcome.zone = recommendation.zone;
+    outcome.text = recommendation.text;
+    outcome.sources.append(source);
+    outcome.issuedMs = QDateTime::currentMSecsSinceEpoch();
+    outcome.appliedMs = 0;
+    outcome.measuredMs = 0;
+    outcome.penaltyBefore = m_stability->zonePenalty(recommendation.zone);
+    outcome.penaltyAfter = outcome.penaltyBefore;
+    outcome.scoreBefore = m_stability->cityScore();
+    outcome.scoreAfter = outcome.scoreBefore;
+
+    m_tracked.insert(outcome.id, outcome);
+    m_candidateCommand.insert(candidate, outcome.id);
+    m_pending.append({outcome.id, recommendation.action, recommendation.zone,
+                      m_stability->zoneName(recommendation.zone)});
+    m_inFlightMetric->set(m_tracked.size());
+
+    if (!m_batchTimer->isActive()) m_batchTimer->start();
+    if (!m_pollTimer->isActive()) m_pollTimer->start();
+    return outcome.id;
+}
+
+void ActionExecutor::flush()
+{
+    if (m_pending.isEmpty()) return;
+
+    QVector<ActionCommand> batch;
+    batch.swap(m_pending);
+
+    // Field units and access policy live on the GUI thread; the boost is
+    // undone once it has run its course
+    for (const ActionCommand &command : batch) {
+        switch (command.action) {
+        case RecommendationEngine::DispatchPatrol:
+            dispatchPatrol(command);
+            break;
+        case RecommendationEngine::HardenAccess:
+            m_conditions->hardenAccess(command.zone, HARDEN_MS);
+            break;
+        case RecommendationEngine::BoostLighting: {
+            const QString zoneName = command.zoneName;
+            const int generation = ++m_boostGeneration[zoneName];
+            QTimer::singleShot(BOOST_MS, this, [this, zoneName, generation]() { endBoost(zoneName, generation); });
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // Devices are matched by location, which is how zones are named
+    m_simulation->post([this, batch](RecyclingModel &recycling, LightingModel &lighting) {
+        for (const ActionCommand &command : batch) {
+            switch (command.action) {
+            case RecommendationEngine::DispatchCollection:
+                for (int bin = 0; bin < recycling.binCount(); ++bin) {
+                    if (recycling.binLocation(bin) == command.zoneName) recycling.setFillLevel(bin, 0.0);
+                }
+                break;
+            case RecommendationEngine::BoostLighting:
+                for (int pole = 0; pole < lighting.poleCount(); ++pole) {
+                    if (lighting.poleLocation(pole) == command.zoneName) lighting.setPoleBoosted(pole, true);
+                }
+                break;
+            default:
+                // Patrols and hardening were handled before the post
+                break;
+            }
+        }
+
+        qint64 appliedMs = QDateTime::currentMSecsSinceEpoch();
+        QMutexLocker locker(&m_ackMutex);
+        for (const ActionCommand &command : batch) m_acks.append({command.id, appliedMs});
+    });
+}
+
+void ActionExecutor::poll()
+{
+    {
+        QMutexLocker locker(&m_ackMutex);
+        if (!m_acks.isEmpty()) m_draining.swap(m_acks);
+    }
+
+    QVector<ActionOutcome> applied;
+    for (const Ack &ack : m_draining) {
+        if (!m_tracked.contains(ack.id)) continue;
+        ActionOutcome outcome = m_tracked.value(ack.id);
+        outcome.appliedMs = ack.appliedMs;
+        m_tracked.insert(ack.id, outcome);
+        m_applied.append(ack.id);
+        applied.append(outcome);
+    }
+    m_draining.clear();
+
+    // Measurements fall due in the order commands were applied
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    QVector<ActionOutcome> completed;
+    int due = 0;
+    while (due < m_applied.size()) {
+        ActionOutcome outcome = m_tracked.value(m_applied[due]);
+        if (nowMs - outcome.appliedMs < MEASURE_DELAY_MS) break;
+
+        outcome.measuredMs = nowMs;
+        outcome.penaltyAfter = m_stability->zonePenalty(outcome.zone);
+        outcome.scoreAfter = m_stability->cityScore();
+        m_tracked.remove(outcome.id);
+        m_candidateCommand.remove(outcome.zone * RecommendationEngine::ACTION_COUNT + outcome.action);
+        completed.append(outcome);
+        ++due;
+    }
+    m_applied.remove(0, due);
+    m_inFlightMetric->set(m_tracked.size());
+
+    if (m_tracked.isEmpty()) m_pollTimer->stop();
+
+    // Listeners may submit again, so notify once the books are straight
+    for (const ActionOutcome &outcome : applied) emit commandApplied(outcome);
+    for (const ActionOutcome &outcome : completed) emit commandCompleted(outcome);
+}
+
+void ActionExecutor::dispatchPatrol(const ActionCommand &command)
+{
+    CityLayout *layout = CityLayout::instance();
+    QPointF point = layout->locate(command.zoneName);
+    CityEntity patrol = layout->dispatchPatrol(point.x(), point.y());
+    // With every unit out the command still completes and measures no relief
+    if (patrol.id.isEmpty()) return;
+
+    const QString patrolId = patrol.id;
+    QTimer::singleShot(CityLayout::PATROL_ON_CALL_MS, this, [patrolId]() {
+        CityLayout::instance()->returnPatrol(patrolId);
+    });
+}
+
+void ActionExecutor::endBoost(const QString &zoneName, int generation)
+{
+    if (m_boostGeneration.value(zoneName) != generation) return;
+    m_simulation->post([zoneName](RecyclingModel &, LightingModel &lighting) {
+        for (int pole = 0; pole < lighting.poleCount(); ++pole) {
+            if (lighting.poleLocation(pole) == zoneName) lighting.setPoleBoosted(pole, false);
+        }
+    });
+}
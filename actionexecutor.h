@@ -0,0 +1,115 @@
+#ifndef ACTIONEXECUTOR_H
+#define ACTIONEXECUTOR_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include "recommendationengine.h"
+
+class SimulationThread;
+class CityConditions;
+class MetricGauge;
+
+// One device-level command derived from an approved recommendation
+struct ActionCommand
+{
+    quint64 id;
+    int action;              // RecommendationEngine::Action
+    int zone;
+    QString zoneName;
+};
+
+// A command tracked from approval to its measured effect
+struct ActionOutcome
+{
+    quint64 id;
+    int action;
+    int zone;
+    QString text;
+    QStringList sources;     // pages that approved it, notified of its result
+    qint64 issuedMs;
+    qint64 appliedMs;        // acknowledged by the simulation thread
+    qint64 measuredMs;
+    double penaltyBefore;    // zone penalty at approval
+    double penaltyAfter;     // zone penalty MEASURE_DELAY_MS after applying
+    int scoreBefore;
+    int scoreAfter;
+
+    qint64 latencyMs() const { return appliedMs - issuedMs; }
+};
+
+// Turns approved recommendations into commands for the city models and
+// follows each one through to its effect. Commands submitted in the same
+// BATCH_MS window go to the simulation thread as one post; a command for a
+// zone and action that is already in flight is not issued again, so two
+// pages approving the same recommendation dispatch one crew and both
+// hear how it went. Each command changes real state: a collection empties
+// the zone's bins, a lighting boost holds its poles at full for BOOST_MS,
+// a patrol sends the nearest free unit for CityLayout::PATROL_ON_CALL_MS
+// and hardening lasts HARDEN_MS. CityConditions turns that state into
+// risk, so the zone penalty measured MEASURE_DELAY_MS after the batch ran
+// is what the intervention actually did.
+// GUI thread only, apart from the acknowledgements.
+class ActionExecutor : public QObject
+{
+    Q_OBJECT
+
+public:
+    ActionExecutor(SimulationThread *simulation, CityConditions *conditions, QObject *parent = nullptr);
+
+    // Returns the command id. An in-flight duplicate returns the original's
+    // id and adds source to the pages that hear about its result.
+    quint64 submit(const Recommendation &recommendation, const QString &source);
+    bool isInFlight(quint64 id) const { return m_tracked.contains(id); }
+
+    static const int BATCH_MS = 100;
+    static const int POLL_MS = 250;
+    static const int MEASURE_DELAY_MS = 30000;
+    static const int BOOST_MS = 300000;
+    static const int HARDEN_MS = 300000;
+
+signals:
+    void commandApplied(const ActionOutcome &outcome);
+    void commandCompleted(const ActionOutcome &outcome);
+
+private slots:
+    void flush();
+    void poll();
+
+private:
+    struct Ack
+    {
+        quint64 id;
+        qint64 appliedMs;
+    };
+
+    void dispatchPatrol(const ActionCommand &command);
+    void endBoost(const QString &zoneName, int generation);
+
+    SimulationThread *m_simulation;
+    CityConditions *m_conditions;
+    CityStabilityModel *m_stability;
+    quint64 m_nextId;
+
+    QTimer *m_batchTimer;
+    QTimer *m_pollTimer;
+    QVector<ActionCommand> m_pending;
+    MetricGauge *m_inFlightMetric;
+
+    // In flight, keyed by id and by recommendation candidate
+    QHash<quint64, ActionOutcome> m_tracked;
+    QHash<int, quint64> m_candidateCommand;
+    QVector<quint64> m_applied;    // oldest first, so due measurements lead
+    QHash<QString, int> m_boostGeneration;  // per zone, so a later boost is not cut short
+
+    // Filled by the simulation thread
+    QMutex m_ackMutex;
+    QVector<Ack> m_acks;
+    QVector<Ack> m_draining;
+};
+
+#endif // ACTIONEXECUTOR_H
@@ -1,4 +1,7 @@
 #include "analyticsmodule.h"
+#include "metricsregistry.h"
+#include "tickdriver.h"
+#include "tracer.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -22,10 +25,12 @@ AnalyticsModule::AnalyticsModule(QWidget *parent)
     setupUI();
     applyStyles();
     
-    // Setup auto-update timer
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer, &QTimer::timeout, this, &AnalyticsModule::updateAnalyticsData);
-    m_updateTimer->start(10000); // Update every 10 seconds
+    // Auto-update tick
+    m_updateTick = TickDriver::instance()->add("Analytics", 10000, this, [this]() { updateAnalyticsData(); });
+    
+    // Nothing to refresh while the page is hidden
+    m_lifecycle = new PageLifecycle(this);
+    m_lifecycle->manage(m_updateTick, 0, 0);
 }
 
 AnalyticsModule::~AnalyticsModule()
@@ -551,6 +556,8 @@ void AnalyticsModule::updateAnalyticsData()
 
 void AnalyticsModule::onRefreshData()
 {
+    SCOPED_LATENCY("chart_update_us", "Analytics");
+    TRACE_SCOPE("AnalyticsModule::onRefreshData");
     generateRecyclingData();
     generateSafetyData();
     generateEnergyData();
@@ -597,6 +604,8 @@ void AnalyticsModule::onDateRangeChanged()
 
 void AnalyticsModule::addLogMessage(const QString &message)
 {
+    static MetricCounter *messages = MetricsRegistry::instance()->counter("log_messages_total", "Analytics");
+    messages->add();
     qDebug() << "[ANALYTICS]" << message;
 }
 
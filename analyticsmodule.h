@@ -6,7 +6,6 @@
 #include <QPushButton>
 #include <QComboBox>
 #include <QDateEdit>
-#include <QTimer>
 #include <QVector>
 #include <QtCharts/QChart>
 #include <QtCharts/QBarSeries>
@@ -14,6 +13,7 @@
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QPieSeries>
 #include <QtCharts/QChartView>
+#include "pagelifecycle.h"
 
 class AnalyticsModule : public QWidget
 {
@@ -86,7 +86,8 @@ private:
     QChartView *m_overviewChartView;
     
     // Data tracking
-    QTimer *m_updateTimer;
+    int m_updateTick;
+    PageLifecycle *m_lifecycle;
     QVector<double> m_recyclingData;
     QVector<double> m_safetyData;
     QVector<double> m_energyData;
@@ -0,0 +1,189 @@
+#include "anomalydetector.h"
+#include <QDateTime>
+#include <QtMath>
+
+namespace {
+// EWMA weight once warmed up; warm-up uses 1/n for an exact running mean
+const double MEAN_ALPHA = 0.01;
+// Hour-of-day baselines move slowly so one odd evening does not stick
+const double SEASONAL_ALPHA = 0.02;
+// Median steps are this fraction of the current spread
+const double MEDIAN_RATE = 0.05;
+// Multiplicative MAD step; equilibrium is the median absolute deviation
+const double MAD_RATE = 0.02;
+// 1.4826 * MAD estimates sigma for normally distributed data
+const double MAD_TO_SIGMA = 1.4826;
+
+double minimumScale(double level)
+{
+    // Keeps flat series from producing infinite scores
+    return 1e-6 + 0.01 * qAbs(level);
+}
+}
+
+AnomalyDetector::AnomalyDetector()
+{
+    for (int k = 0; k < EVENT_KIND_COUNT; ++k) {
+        m_watched[k] = false;
+        m_seasonal[k] = false;
+        m_threshold[k] = DEFAULT_THRESHOLD;
+    }
+}
+
+void AnomalyDetector::watchKind(quint16 kind, bool seasonal, double threshold)
+{
+    if (kind >= EVENT_KIND_COUNT) return;
+    m_watched[kind] = true;
+    m_seasonal[kind] = seasonal;
+    m_threshold[kind] = threshold;
+}
+
+quint32 AnomalyDetector::seriesFor(quint16 kind, quint32 sensor)
+{
+    QVector<quint32> &lookup = m_seriesOf[kind];
+    if (static_cast<int>(sensor) >= lookup.size()) {
+        int oldSize = lookup.size();
+        lookup.resize(static_cast<int>(sensor) + 1);
+        for (int i = oldSize; i < lookup.size(); ++i) lookup[i] = NO_SERIES;
+    }
+
+    quint32 series = lookup[sensor];
+    if (series != NO_SERIES) return series;
+
+    series = static_cast<quint32>(m_count.size());
+    lookup[sensor] = series;
+
+    m_kind.append(kind);
+    m_sensor.append(sensor);
+    m_mean.append(0.0f);
+    m_variance.append(0.0f);
+    m_median.append(0.0f);
+    m_mad.append(0.0f);
+    m_count.append(0);
+    m_lastAlertSec.append(0);
+
+    if (m_seasonal[kind]) {
+        m_seasonalSlot.append(static_cast<quint32>(m_hourMask.size()));
+        m_hourMask.append(0);
+        m_hourBaseline.resize(m_hourBaseline.size() + HOURS);
+    } else {
+        m_seasonalSlot.append(NO_SERIES);
+    }
+    return series;
+}
+
+bool AnomalyDetector::score(quint32 series, double value, int hour, qint64 timestampMs, AnomalyHit &hit)
+{
+    // Seasonal series are judged on the residual from their hour's baseline
+    double baseline = 0.0;
+    float *hours = nullptr;
+    quint32 slot = m_seasonalSlot[series];
+    if (slot != NO_SERIES) {
+        hours = m_hourBaseline.data() + slot * HOURS;
+        quint32 &mask = m_hourMask[slot];
+        if (!(mask & (1u << hour))) {
+            // First reading in this hour: continue from the latest learned hour
+            hours[hour] = static_cast<float>(value);
+            for (int back = 1; back < HOURS; ++back) {
+                int h = (hour - back + HOURS) % HOURS;
+                if (mask & (1u << h)) {
+                    hours[hour] = hours[h];
+                    break;
+                }
+            }
+            mask |= 1u << hour;
+        }
+        baseline = hours[hour];
+    }
+
+    double residual = value - baseline;
+    quint32 &count = m_count[series];
+    float &mean = m_mean[series];
+    float &variance = m_variance[series];
+    float &median = m_median[series];
+    float &mad = m_mad[series];
+
+    if (count == 0) {
+        mean = static_cast<float>(residual);
+        median = static_cast<float>(residual);
+        variance = 0.0f;
+        mad = 0.0f;
+        count = 1;
+        return false;
+    }
+
+    const double threshold = m_threshold[m_kind[series]];
+    const double floor = minimumScale(baseline + median);
+    const double sigma = qMax(static_cast<double>(qSqrt(variance)), floor);
+    const double robustSigma = qMax(MAD_TO_SIGMA * mad, floor);
+
+    const double ewmaZ = qAbs(residual - mean) / sigma;
+    const double robustZ = qAbs(residual - median) / robustSigma;
+    const double z = qMin(ewmaZ, robustZ);
+    const bool warm = count >= static_cast<quint32>(WARMUP_SAMPLES);
+    const bool anomalous = warm && z > threshold;
+
+    // Learn from a winsorised reading so anomalies cannot drag the baselines
+    double learned = residual;
+    if (warm) learned = qBound(mean - threshold * sigma, residual, mean + threshold * sigma);
+
+    double alpha = qMax(MEAN_ALPHA, 1.0 / (count + 1));
+    double delta = learned - mean;
+    mean += static_cast<float>(alpha * delta);
+    variance = static_cast<float>((1.0 - alpha) * (variance + alpha * delta * delta));
+
+    double step = MEDIAN_RATE * robustSigma;
+    if (learned > median) median += static_cast<float>(qMin(step, learned - median));
+    else if (learned < median) median -= static_cast<float>(qMin(step, median - learned));
+
+    double deviation = qAbs(learned - median);
+    if (mad == 0.0f) mad = static_cast<float>(deviation);
+    else mad *= deviation > mad ? static_cast<float>(1.0 + MAD_RATE) : static_cast<float>(1.0 - MAD_RATE);
+
+    if (hours) hours[hour] += static_cast<float>(SEASONAL_ALPHA * (baseline + learned - hours[hour]));
+    if (count < 0xFFFFFFFFu) ++count;
+
+    if (!anomalous) return false;
+
+    quint32 nowSec = static_cast<quint32>(timestampMs / 1000);
+    quint32 &lastAlert = m_lastAlertSec[series];
+    if (lastAlert != 0 && nowSec - lastAlert < static_cast<quint32>(ALERT_COOLDOWN_SECONDS)) return false;
+    lastAlert = nowSec;
+
+    hit.kind = m_kind[series];
+    hit.sensor = m_sensor[series];
+    hit.value = value;
+    hit.expected = baseline + median;
+    hit.score = z;
+    hit.timestampMs = timestampMs;
+    return true;
+}
+
+int AnomalyDetector::observe(const QVector<CityEvent> &events, QVector<AnomalyHit> &out)
+{
+    int before = out.size();
+    // Local hour straight from the timestamp; the UTC offset is fixed per batch
+    const qint64 offsetMs = static_cast<qint64>(QDateTime::currentDateTime().offsetFromUtc()) * 1000;
+
+    AnomalyHit hit;
+    for (const CityEvent &event : events) {
+        if (event.kind >= EVENT_KIND_COUNT || !m_watched[event.kind]) continue;
+
+        quint32 series = seriesFor(event.kind, event.sensor);
+        int hour = static_cast<int>(((event.timestampMs + offsetMs) / 3600000) % HOURS);
+        if (score(series, event.value, hour, event.timestampMs, hit)) out.append(hit);
+    }
+    return out.size() - before;
+}
+
+qint64 AnomalyDetector::memoryBytes() const
+{
+    qint64 perSeries = sizeof(quint16) + 3 * sizeof(quint32) + 4 * sizeof(float) + sizeof(quint32);
+    qint64 bytes = perSeries * m_count.size();
+    bytes += static_cast<qint64>(m_hourBaseline.size()) * sizeof(float);
+    bytes += static_cast<qint64>(m_hourMask.size()) * sizeof(quint32);
+    for (int k = 0; k < EVENT_KIND_COUNT; ++k) {
+        bytes += static_cast<qint64>(m_seriesOf[k].size()) * sizeof(quint32);
+    }
+    return bytes;
+}
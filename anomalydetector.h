@@ -0,0 +1,75 @@
+#ifndef ANOMALYDETECTOR_H
+#define ANOMALYDETECTOR_H
+
+#include <QVector>
+#include "cityeventbus.h"
+
+// One anomalous reading
+struct AnomalyHit
+{
+    quint16 kind;
+    quint32 sensor;
+    double value;
+    double expected;     // baseline the value was judged against
+    double score;        // robust z-score
+    qint64 timestampMs;
+};
+
+// Streaming anomaly detector for per-sensor series. A series is one
+// (event kind, sensor) pair and keeps O(1) state: EWMA mean/variance, a
+// streaming median and MAD, and - for seasonal kinds - an hour-of-day
+// baseline the other statistics are computed against. A reading is
+// anomalous when both the EWMA z-score and the MAD z-score exceed the
+// kind's threshold, which keeps heavy-tailed feeds from alerting on
+// every burst. State is stored column-wise (about 40 bytes per series,
+// plus 100 bytes for seasonal ones), so a million series fit in a few
+// hundred MB.
+class AnomalyDetector
+{
+public:
+    AnomalyDetector();
+
+    // Only watched kinds create series; others are ignored
+    void watchKind(quint16 kind, bool seasonal, double threshold = DEFAULT_THRESHOLD);
+
+    // Scores and learns every event of a watched kind; appends anomalies
+    // to out and returns the number appended
+    int observe(const QVector<CityEvent> &events, QVector<AnomalyHit> &out);
+
+    int seriesCount() const { return m_count.size(); }
+    qint64 memoryBytes() const;
+
+    static constexpr double DEFAULT_THRESHOLD = 5.0;
+    static const int WARMUP_SAMPLES = 30;
+    static const int ALERT_COOLDOWN_SECONDS = 60;
+
+private:
+    static constexpr quint32 NO_SERIES = 0xFFFFFFFFu;
+    static constexpr int HOURS = 24;
+
+    quint32 seriesFor(quint16 kind, quint32 sensor);
+    bool score(quint32 series, double value, int hour, qint64 timestampMs, AnomalyHit &hit);
+
+    // Per-kind configuration and sensor -> series lookup
+    bool m_watched[EVENT_KIND_COUNT];
+    bool m_seasonal[EVENT_KIND_COUNT];
+    double m_threshold[EVENT_KIND_COUNT];
+    QVector<quint32> m_seriesOf[EVENT_KIND_COUNT];
+
+    // Series state, one entry per series
+    QVector<quint16> m_kind;
+    QVector<quint32> m_sensor;
+    QVector<float> m_mean;
+    QVector<float> m_variance;
+    QVector<float> m_median;
+    QVector<float> m_mad;
+    QVector<quint32> m_count;
+    QVector<quint32> m_lastAlertSec;
+    QVector<quint32> m_seasonalSlot;   // NO_SERIES when not seasonal
+
+    // Seasonal pool: HOURS baselines per slot plus a learned-hours mask
+    QVector<float> m_hourBaseline;
+    QVector<quint32> m_hourMask;
+};
+
+#endif // ANOMALYDETECTOR_H
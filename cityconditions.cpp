@@ -0,0 +1,69 @@
+#include "cityconditions.h"
+#include "simulationthread.h"
+#include "citylayout.h"
+#include "tickdriver.h"
+#include <QDateTime>
+
+CityConditions::CityConditions(SimulationThread *simulation, QObject *parent)
+    : QObject(parent)
+    , m_simulation(simulation)
+    , m_stability(CityStabilityModel::instance())
+{
+    TickDriver::instance()->add("City conditions", TICK_MS, this, [this]() { tick(); });
+}
+
+void CityConditions::hardenAccess(int zone, int durationMs)
+{
+    qint64 untilMs = QDateTime::currentMSecsSinceEpoch() + durationMs;
+    m_hardenedUntil.insert(zone, qMax(untilMs, m_hardenedUntil.value(zone, 0)));
+}
+
+void CityConditions::tick()
+{
+    // The one consumer of the condition frames
+    SnapshotBuffer<ConditionSnapshot> &frames = m_simulation->conditionFrames();
+    frames.update();
+    const double seconds = TICK_MS / 1000.0;
+
+    for (const ZoneCondition &condition : frames.current().zones) {
+        m_stability->setConditionRisk(condition.zone, CityStabilityModel::WasteRisk,
+                                      WASTE_RISK_PER_FULL_BIN * condition.binOverflow);
+        m_stability->setConditionRisk(condition.zone, CityStabilityModel::EnergyRisk,
+                                      ENERGY_RISK_PER_BOOSTED_POLE * condition.boostedPoles);
+        if (condition.boostedPoles > 0) {
+            m_stability->relieve(condition.zone, CityStabilityModel::SafetyRisk, LIGHTING_RELIEF * seconds);
+        }
+    }
+
+    // Only zones with safety risk to work off are worth a spatial query
+    for (int zone = 0; zone < m_stability->zoneCount(); ++zone) {
+        if (m_stability->risk(zone, CityStabilityModel::SafetyRisk)
+                <= m_stability->baseline(zone, CityStabilityModel::SafetyRisk)) continue;
+        if (hasPatrolNear(zone)) {
+            m_stability->relieve(zone, CityStabilityModel::SafetyRisk, PATROL_RELIEF * seconds);
+        }
+    }
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    for (QHash<int, qint64>::iterator it = m_hardenedUntil.begin(); it != m_hardenedUntil.end();) {
+        if (it.value() <= nowMs) {
+            it = m_hardenedUntil.erase(it);
+            continue;
+        }
+        m_stability->relieve(it.key(), CityStabilityModel::CyberRisk, HARDENING_RELIEF * seconds);
+        ++it;
+    }
+}
+
+bool CityConditions::hasPatrolNear(int zone) const
+{
+    // Units parked at their station are not on a call and cover nothing
+    CityLayout *layout = CityLayout::instance();
+    QPointF centre = layout->locate(m_stability->zoneName(zone));
+    QVector<CityEntity> patrols = layout->withinRadius(centre.x(), centre.y(), PATROL_COVER_METRES,
+                                                       CityLayout::typeBit(CityLayout::Patrol));
+    for (const CityEntity &patrol : patrols) {
+        if (layout->isPatrolOnCall(patrol.id)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,45 @@
+#ifndef CITYCONDITIONS_H
+#define CITYCONDITIONS_H
+
+#include <QObject>
+#include <QHash>
+#include "citystabilitymodel.h"
+
+class SimulationThread;
+
+// Feeds what is actually out in the city into the CityStabilityModel
+// every TICK_MS. Overfull bins hold a zone's waste risk up and boosted
+// poles add to its energy risk for as long as the simulation reports
+// them. Field responses work risk above baseline off while they are in
+// place: a patrol unit on a call near the zone and boosted lights for
+// safety risk, hardened access for cyber risk until it lapses.
+// GUI thread only.
+class CityConditions : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CityConditions(SimulationThread *simulation, QObject *parent = nullptr);
+
+    void hardenAccess(int zone, int durationMs);
+    bool isHardened(int zone) const { return m_hardenedUntil.contains(zone); }
+
+    static const int TICK_MS = 1000;
+    static constexpr double WASTE_RISK_PER_FULL_BIN = 4.0;
+    static constexpr double ENERGY_RISK_PER_BOOSTED_POLE = 1.0;
+    // Relief per second of risk above baseline
+    static constexpr double PATROL_RELIEF = 0.5;
+    static constexpr double LIGHTING_RELIEF = 0.2;
+    static constexpr double HARDENING_RELIEF = 0.5;
+    static constexpr double PATROL_COVER_METRES = 300.0;
+
+private:
+    void tick();
+    bool hasPatrolNear(int zone) const;
+
+    SimulationThread *m_simulation;
+    CityStabilityModel *m_stability;
+    QHash<int, qint64> m_hardenedUntil;
+};
+
+#endif // CITYCONDITIONS_H
@@ -0,0 +1,133 @@
+#include "cityeventbus.h"
+#include "metricsregistry.h"
+#include <QDateTime>
+#include <QMutexLocker>
+
+namespace {
+const int BACKLOG_MASK = CityEventBus::MAX_PENDING - 1;
+const int PUMP_BATCH = 4096;
+}
+
+CityEventBus::CityEventBus()
+    : m_backlogStart(0)
+    , m_backlogCount(0)
+    , m_dropped(0)
+{
+    m_depthMetric = MetricsRegistry::instance()->gauge("queue_depth", "Event bus");
+    m_eventsMetric = MetricsRegistry::instance()->counter("events_total", "Event bus");
+    m_backlog.resize(MAX_PENDING);
+    m_pumpBatch.resize(PUMP_BATCH);
+}
+
+CityEventBus *CityEventBus::instance()
+{
+    static CityEventBus bus;
+    return &bus;
+}
+
+quint32 CityEventBus::sensorId(const QString &name)
+{
+    QMutexLocker locker(&m_sensorMutex);
+    QHash<QString, quint32>::const_iterator it = m_sensorIds.constFind(name);
+    if (it != m_sensorIds.constEnd()) return it.value();
+
+    quint32 id = static_cast<quint32>(m_sensorNames.size());
+    m_sensorNames.append(name);
+    m_sensorIds.insert(name, id);
+    return id;
+}
+
+QString CityEventBus::sensorName(quint32 sensor) const
+{
+    QMutexLocker locker(&m_sensorMutex);
+    return m_sensorNames.value(static_cast<int>(sensor));
+}
+
+CityEventBus::Lane *CityEventBus::lane()
+{
+    static thread_local Lane *threadLane = nullptr;
+    if (!threadLane) {
+        threadLane = new Lane();
+        QMutexLocker locker(&m_laneMutex);
+        m_lanes.append(threadLane);
+    }
+    return threadLane;
+}
+
+void CityEventBus::publish(quint16 kind, quint32 sensor, double value, qint64 timestampMs)
+{
+    CityEvent event;
+    event.timestampMs = timestampMs > 0 ? timestampMs : QDateTime::currentMSecsSinceEpoch();
+    event.sensor = sensor;
+    event.kind = kind;
+    event.reserved = 0;
+    event.value = value;
+
+    if (!lane()->tryPush(event)) m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CityEventBus::publishBatch(const QVector<CityEvent> &events)
+{
+    const int accepted = lane()->pushBatch(events.constData(), events.size());
+    if (accepted < events.size()) m_dropped.fetch_add(events.size() - accepted, std::memory_order_relaxed);
+}
+
+void CityEventBus::pump()
+{
+    {
+        QMutexLocker locker(&m_laneMutex);
+        if (m_pumpLanes.size() != m_lanes.size()) m_pumpLanes = m_lanes;
+    }
+
+    CityEvent *backlog = m_backlog.data();
+    CityEvent *batch = m_pumpBatch.data();
+    quint64 overwritten = 0;
+    quint64 pumped = 0;
+    for (Lane *lane : m_pumpLanes) {
+        int count;
+        while ((count = lane->popBatch(batch, PUMP_BATCH)) > 0) {
+            pumped += count;
+            for (int i = 0; i < count; ++i) {
+                backlog[(m_backlogStart + m_backlogCount) & BACKLOG_MASK] = batch[i];
+                // A full ring has just overwritten its oldest event
+                if (m_backlogCount == MAX_PENDING) {
+                    m_backlogStart = (m_backlogStart + 1) & BACKLOG_MASK;
+                    ++overwritten;
+                } else {
+                    ++m_backlogCount;
+                }
+            }
+        }
+    }
+    if (pumped > 0) m_eventsMetric->add(pumped);
+    if (overwritten > 0) m_dropped.fetch_add(overwritten, std::memory_order_relaxed);
+    // Waiting for the consumer; drain() reads it just before emptying the backlog
+    m_depthMetric->set(m_backlogCount);
+}
+
+void CityEventBus::drain(QVector<CityEvent> &out, qint64 notBeforeMs)
+{
+    pump();
+    // Clearing keeps out's capacity, so steady state allocates nothing
+    out.clear();
+    out.reserve(m_backlogCount);
+    const CityEvent *backlog = m_backlog.constData();
+    for (int i = 0; i < m_backlogCount; ++i) {
+        const CityEvent &event = backlog[(m_backlogStart + i) & BACKLOG_MASK];
+        if (event.timestampMs >= notBeforeMs) out.append(event);
+    }
+    m_backlogStart = 0;
+    m_backlogCount = 0;
+}
+
+int CityEventBus::pendingEvents() const
+{
+    int pending = m_backlogCount;
+    for (const Lane *lane : m_pumpLanes) pending += lane->size();
+    return pending;
+}
+
+quint64 CityEventBus::droppedEvents() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,97 @@
+#ifndef CITYEVENTBUS_H
+#define CITYEVENTBUS_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <atomic>
+#include "spscqueue.h"
+
+class MetricCounter;
+class MetricGauge;
+
+// Kinds of telemetry flowing through the bus
+enum CityEventKind : quint16 {
+    EVENT_SPEED_READING = 0,   // km/h from a crosswalk radar
+    EVENT_BIN_DEPOSIT,         // kg added to a recycling bin
+    EVENT_HEARTBEAT,           // periodic "alive" from a field device
+    EVENT_AUTH_FAILURE,        // failed logins in one report
+    EVENT_GAS_LEVEL,           // ppm from a home gas sensor
+    EVENT_SMOKE_LEVEL,         // ppm from a home smoke sensor
+    EVENT_POLE_POWER,          // watts drawn by a streetlight pole
+    EVENT_STATION_TAPS,        // RFID taps at a station per reporting window
+    EVENT_KIND_COUNT
+};
+
+// Fixed-size telemetry record. Sensors are referred to by interned ids so
+// events stay trivially copyable and rule evaluation never touches strings.
+struct CityEvent
+{
+    qint64 timestampMs;
+    quint32 sensor;
+    quint16 kind;      // CityEventKind
+    quint16 reserved;
+    double value;
+};
+
+// Process-wide telemetry stream. Any thread may publish; each publishing
+// thread writes into its own SPSC lane, so publishing takes no lock. The
+// GUI thread pumps the lanes into a bounded backlog every PUMP_MS (the
+// main window owns that tick, so it runs before any consumer exists) and
+// drops the oldest events once the backlog is full. One consumer drains
+// the backlog in a single batch. pump() and drain() are GUI thread only.
+class CityEventBus
+{
+public:
+    static CityEventBus *instance();
+
+    // Sensor interning; callers cache the id
+    quint32 sensorId(const QString &name);
+    QString sensorName(quint32 sensor) const;
+
+    void publish(quint16 kind, quint32 sensor, double value, qint64 timestampMs = 0);
+    void publishBatch(const QVector<CityEvent> &events);
+
+    // Moves everything the lanes hold into the backlog
+    void pump();
+
+    // Pumps, then moves the backlog into out (which is cleared first),
+    // skipping events stamped before notBeforeMs
+    void drain(QVector<CityEvent> &out, qint64 notBeforeMs = 0);
+
+    // Events published but not yet drained
+    int pendingEvents() const;
+    quint64 droppedEvents() const;
+
+    static const int LANE_EVENTS = 1 << 16;
+    static const int MAX_PENDING = 1 << 18;
+    static const int PUMP_MS = 250;
+
+private:
+    typedef SpscQueue<CityEvent, LANE_EVENTS> Lane;
+
+    CityEventBus();
+    Lane *lane();   // the calling thread's, created on first use
+
+    // Lanes outlive their threads so nothing published is lost
+    mutable QMutex m_laneMutex;
+    QVector<Lane *> m_lanes;
+    QVector<Lane *> m_pumpLanes;       // GUI thread copy of m_lanes
+
+    // Ring of MAX_PENDING; GUI thread only
+    QVector<CityEvent> m_backlog;
+    int m_backlogStart;
+    int m_backlogCount;
+    QVector<CityEvent> m_pumpBatch;
+    std::atomic<quint64> m_dropped;
+    MetricGauge *m_depthMetric;
+    MetricCounter *m_eventsMetric;     // taken off the lanes, whether or not a consumer exists
+
+    mutable QMutex m_sensorMutex;
+    QHash<QString, quint32> m_sensorIds;
+    QStringList m_sensorNames;
+};
+
+#endif // CITYEVENTBUS_H
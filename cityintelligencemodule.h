@@ -7,18 +7,26 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QProgressBar>
-#include <QTimer>
 #include <QVector>
 #include <QtCharts/QChart>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QChartView>
+#include <QtCharts/QAreaSeries>
+#include "forecastthread.h"
+#include "recommendationengine.h"
+#include "whatifsimulator.h"
+#include "actionexecutor.h"
+#include "pagelifecycle.h"
+
+class SimulationThread;
 
 class CityIntelligenceModule : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit CityIntelligenceModule(QWidget *parent = nullptr);
+    CityIntelligenceModule(SimulationThread *simulation, ForecastThread *forecasting,
+                           ActionExecutor *actions, QWidget *parent = nullptr);
     ~CityIntelligenceModule();
 
 signals:
@@ -28,11 +36,16 @@ signals:
 
 private slots:
     void updateIntelligenceData();
+    void onStabilityScoreChanged(int score);
+    void refreshForecastChart();
     void onGeneratePrediction();
     void onRefreshForecasts();
     void onApplyRecommendation();
     void onIgnoreRecommendation();
+    void onActionApplied(const ActionOutcome &outcome);
+    void onActionCompleted(const ActionOutcome &outcome);
     void onRunSimulation();
+    void onSimulationFinished();
 
 private:
     // UI Creation Methods
@@ -52,8 +65,8 @@ private:
                            const QString &probability, const QString &timeframe);
     void generateNewRecommendation();
     void updateCityStability();
+    void drawForecastChart();
     void addDecisionLog(const QString &decision);
-    void addRiskDataPoint();
     QString getRiskLevelColor(int score);
     
     // City Stability Components
@@ -68,7 +81,11 @@ private:
     // Risk Forecast Chart
     QChart *m_riskChart;
     QLineSeries *m_riskSeries;
+    QLineSeries *m_riskUpperSeries;
+    QLineSeries *m_riskLowerSeries;
+    QAreaSeries *m_riskBand;
     QChartView *m_riskChartView;
+    QLabel *m_forecastNote;
     
     // AI Recommendations
     QLabel *m_currentRecommendationLabel;
@@ -85,12 +102,24 @@ private:
     QPushButton *m_refreshBtn;
     QPushButton *m_simulateBtn;
     
+    // Widget regions posted to the UI scheduler
+    enum UiRegion {
+        StabilityRegion,
+        ForecastRegion
+    };
+    
     // Data tracking
-    QTimer *m_updateTimer;
+    int m_updateTick;
     int m_cityStabilityScore;
-    QVector<double> m_riskForecast;
-    QStringList m_aiRecommendations;
-    int m_currentRecommendationIndex;
+    ForecastThread *m_forecasting;
+    int m_forecastTick;
+    PageLifecycle *m_lifecycle;
+    quint64 m_forecastSequence;
+    Recommendation m_recommendation;
+    bool m_hasRecommendation;
+    ActionExecutor *m_actions;
+    WhatIfSimulator *m_whatIf;
+    quint32 m_whatIfSeed;
     
     // Risk factors
     int m_infrastructureRisk;
@@ -98,6 +127,9 @@ private:
     int m_socialRisk;
     int m_economicRisk;
     
+    // Tags this page's commands in the action executor
+    const QString ACTION_SOURCE = "City Intelligence";
+    
     // Color definitions
     const QString COLOR_BACKGROUND = "#121212";
     const QString COLOR_PANEL = "#1E1E1E";
@@ -0,0 +1,237 @@
+#include "citylayout.h"
+#include <cmath>
+
+namespace {
+struct Landmark
+{
+    const char *name;
+    double x;
+    double y;
+};
+
+// Zones of the dashboard map, a 3 x 3 grid over the city, north row first
+const Landmark ZONES[] = {
+    {"North District", 667, 2750}, {"Central Plaza", 2000, 2750}, {"East District", 3333, 2750},
+    {"West Industrial", 667, 1650}, {"City Center", 2000, 1650}, {"Market Area", 3333, 1650},
+    {"South Residential", 667, 550}, {"Park Zone", 2000, 550}, {"Tech Campus", 3333, 550}
+};
+
+// Named places the pages use as locations
+const Landmark LANDMARKS[] = {
+    {"Main Street Plaza", 1200, 800}, {"Main Street North", 1200, 600}, {"Main Street South", 1200, 1000},
+    {"Main St & 1st Ave", 1250, 850}, {"City Hall", 1500, 1100}, {"Central Park East", 2100, 1500},
+    {"Downtown Central", 1900, 1500}, {"Shopping District", 900, 1900}, {"Park Avenue", 2000, 2600},
+    {"University Campus", 3200, 2400}, {"University Gate", 3100, 2300}, {"University Hub", 3250, 2500},
+    {"Residential Zone", 500, 2700}, {"Residential Zone A", 400, 2800}, {"School Zone", 700, 2500},
+    {"Industrial Park", 3600, 300}, {"Industrial Area", 3500, 400}, {"Sports Complex", 2700, 3100},
+    {"Hospital Road", 2600, 900}, {"Hospital Area", 2650, 950}, {"Business Park", 2900, 1300},
+    {"East Terminal", 3700, 1500}, {"West Plaza", 300, 1500}, {"South Gate", 2000, 150},
+    {"Airport Link", 3900, 3200}
+};
+
+// Patrol units start at their district stations
+const Landmark PATROLS[] = {
+    {"PATROL-1", 2000, 1650}, {"PATROL-2", 667, 2750}, {"PATROL-3", 3333, 550}
+};
+}
+
+CityLayout *CityLayout::instance()
+{
+    static CityLayout layout;
+    return &layout;
+}
+
+CityLayout::CityLayout()
+    : m_changesOverflowed(false)
+{
+    for (const Landmark &zone : ZONES) {
+        m_gazetteer.insert(QString(zone.name).toLower(), QPointF(zone.x, zone.y));
+        place(Zone, zone.name, zone.x, zone.y);
+    }
+    for (const Landmark &landmark : LANDMARKS) {
+        m_gazetteer.insert(QString(landmark.name).toLower(), QPointF(landmark.x, landmark.y));
+    }
+    for (const Landmark &patrol : PATROLS) place(Patrol, patrol.name, patrol.x, patrol.y);
+}
+
+CityEntity CityLayout::dispatchPatrol(double x, double y)
+{
+    QVector<CityEntity> patrols = nearest(x, y, m_patrolsOnCall.size() + 1, typeBit(Patrol));
+    for (const CityEntity &candidate : patrols) {
+        if (m_patrolsOnCall.contains(candidate.id)) continue;
+        place(Patrol, candidate.id, x, y);
+        m_patrolsOnCall.insert(candidate.id);
+        return candidate;
+    }
+
+    CityEntity none;
+    none.type = Patrol;
+    none.x = x;
+    none.y = y;
+    none.distance = 0.0;
+    return none;
+}
+
+void CityLayout::returnPatrol(const QString &id)
+{
+    m_patrolsOnCall.remove(id);
+    for (const Landmark &patrol : PATROLS) {
+        if (id == patrol.name) {
+            place(Patrol, id, patrol.x, patrol.y);
+            return;
+        }
+    }
+}
+
+QString CityLayout::key(EntityType type, const QString &id)
+{
+    return QString::number(type) + ":" + id;
+}
+
+void CityLayout::place(EntityType type, const QString &id, double x, double y)
+{
+    const QString entityKey = key(type, id);
+    QHash<QString, int>::const_iterator it = m_handles.constFind(entityKey);
+    if (it != m_handles.constEnd()) {
+        int handle = it.value();
+        if (m_index.x(handle) == x && m_index.y(handle) == y) return;
+        noteChange(type, m_index.x(handle), m_index.y(handle));
+        m_index.move(handle, x, y);
+        noteChange(type, x, y);
+        return;
+    }
+
+    int handle = m_index.insert(type, x, y);
+    noteChange(type, x, y);
+    if (handle >= m_ids.size()) {
+        m_ids.resize(handle + 1);
+        m_values.resize(handle + 1);
+    }
+    m_ids[handle] = id;
+    m_values[handle] = 0.0;
+    m_handles.insert(entityKey, handle);
+}
+
+void CityLayout::place(EntityType type, const QString &id, const QString &location)
+{
+    QPointF point = locate(location);
+    place(type, id, point.x(), point.y());
+}
+
+void CityLayout::remove(EntityType type, const QString &id)
+{
+    const QString entityKey = key(type, id);
+    int handle = m_handles.value(entityKey, -1);
+    if (handle < 0) return;
+    noteChange(type, m_index.x(handle), m_index.y(handle));
+    m_index.remove(handle);
+    m_ids[handle].clear();
+    m_handles.remove(entityKey);
+}
+
+bool CityLayout::position(EntityType type, const QString &id, double &x, double &y) const
+{
+    int handle = m_handles.value(key(type, id), -1);
+    if (handle < 0) return false;
+    x = m_index.x(handle);
+    y = m_index.y(handle);
+    return true;
+}
+
+void CityLayout::setValue(EntityType type, const QString &id, double value)
+{
+    int handle = m_handles.value(key(type, id), -1);
+    if (handle < 0 || m_values[handle] == value) return;
+    m_values[handle] = value;
+    noteChange(type, m_index.x(handle), m_index.y(handle), false);
+}
+
+void CityLayout::noteChange(int type, double x, double y, bool moved)
+{
+    if (m_changesOverflowed) return;
+    if (m_changes.size() >= MAX_PENDING_CHANGES) {
+        m_changes.clear();
+        m_changesOverflowed = true;
+        return;
+    }
+    m_changes.append({type, x, y, moved});
+}
+
+bool CityLayout::takeChanges(QVector<CityChange> &out)
+{
+    bool listed = !m_changesOverflowed;
+    out.append(m_changes);
+    m_changes.clear();
+    m_changesOverflowed = false;
+    return listed;
+}
+
+QPointF CityLayout::locate(const QString &location) const
+{
+    const QString name = location.trimmed().toLower();
+    QHash<QString, QPointF>::const_iterator it = m_gazetteer.constFind(name);
+    if (it != m_gazetteer.constEnd()) return it.value();
+
+    // No geocoder: spread unknown addresses over the city, stably per text
+    uint hash = qHash(name);
+    double x = (hash & 0xFFFF) / 65535.0 * CITY_WIDTH_METRES;
+    double y = (hash >> 16) / 65535.0 * CITY_HEIGHT_METRES;
+    return QPointF(x, y);
+}
+
+CityEntity CityLayout::entity(int handle, double x, double y) const
+{
+    CityEntity result;
+    result.type = m_index.type(handle);
+    result.id = m_ids[handle];
+    result.x = m_index.x(handle);
+    result.y = m_index.y(handle);
+    result.distance = std::hypot(result.x - x, result.y - y);
+    return result;
+}
+
+QVector<CityEntity> CityLayout::withinRadius(double x, double y, double radius, quint32 typeMask) const
+{
+    QVector<int> handles;
+    m_index.withinRadius(x, y, radius, typeMask, handles);
+    QVector<CityEntity> result;
+    result.reserve(handles.size());
+    for (int handle : handles) result.append(entity(handle, x, y));
+    return result;
+}
+
+QVector<CityEntity> CityLayout::withinBox(double minX, double minY, double maxX, double maxY, quint32 typeMask) const
+{
+    QVector<int> handles;
+    m_index.withinBox(minX, minY, maxX, maxY, typeMask, handles);
+    QVector<CityEntity> result;
+    result.reserve(handles.size());
+    // Distances from the box centre
+    for (int handle : handles) result.append(entity(handle, (minX + maxX) / 2, (minY + maxY) / 2));
+    return result;
+}
+
+QVector<CityEntity> CityLayout::nearest(EntityType fromType, const QString &fromId, int k, quint32 typeMask) const
+{
+    int from = m_handles.value(key(fromType, fromId), -1);
+    if (from < 0) return QVector<CityEntity>();
+
+    const double x = m_index.x(from);
+    const double y = m_index.y(from);
+    QVector<int> handles;
+    m_index.nearest(x, y, k, typeMask, handles, from);
+    QVector<CityEntity> result;
+    result.reserve(handles.size());
+    for (int handle : handles) result.append(entity(handle, x, y));
+    return result;
+}
+
+QVector<CityEntity> CityLayout::nearest(double x, double y, int k, quint32 typeMask) const
+{
+    QVector<int> handles;
+    m_index.nearest(x, y, k, typeMask, handles);
+    QVector<CityEntity> result;
+    result.reserve(handles.size());
+    for (int handle : handles) result.append(entity(handle, x, y));
+    return result;
+}
@@ -0,0 +1,106 @@
+#ifndef CITYLAYOUT_H
+#define CITYLAYOUT_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QPointF>
+#include "spatialindex.h"
+
+// A placed entity, as returned by queries
+struct CityEntity
+{
+    int type;                // CityLayout::EntityType
+    QString id;
+    double x;                // metres east of the depot
+    double y;                // metres north of the depot
+    double distance;         // from the query point, where it has one
+};
+
+// A position an entity arrived at or left, or where its value changed
+struct CityChange
+{
+    int type;
+    double x;
+    double y;
+    bool moved;
+};
+
+// Where everything in the city is. Pages place their zones, bins, poles,
+// crosswalks, stations, homes and patrol units here by id, and any page
+// can then ask what lies within a radius or box of a point, or which k
+// entities of some types are nearest, through one shared SpatialIndex.
+// Entities only carry free-text locations, so locate() turns those into
+// coordinates: known landmarks come from a gazetteer and anything else
+// (street addresses) is placed at a stable spot derived from its text.
+// GUI thread only.
+class CityLayout
+{
+public:
+    enum EntityType {
+        Zone,
+        Bin,
+        Pole,
+        Crosswalk,
+        Station,
+        Home,
+        Patrol,
+        ENTITY_TYPE_COUNT
+    };
+
+    static CityLayout *instance();
+
+    // Inserts or moves the entity
+    void place(EntityType type, const QString &id, double x, double y);
+    void place(EntityType type, const QString &id, const QString &location);
+    void remove(EntityType type, const QString &id);
+    bool position(EntityType type, const QString &id, double &x, double &y) const;
+    // Sends the nearest patrol unit not already on a call to the point and
+    // marks it busy; the returned id is empty when every unit is out
+    CityEntity dispatchPatrol(double x, double y);
+    // Moves a patrol unit back to its district station and frees it
+    void returnPatrol(const QString &id);
+    bool isPatrolOnCall(const QString &id) const { return m_patrolsOnCall.contains(id); }
+    // Per-entity reading for heat overlays (gas, crossing risk, occupancy,
+    // energy), scaled so that 1 is the level worth attention
+    void setValue(EntityType type, const QString &id, double value);
+    double value(int handle) const { return m_values.value(handle); }
+    QPointF locate(const QString &location) const;
+
+    QVector<CityEntity> withinRadius(double x, double y, double radius, quint32 typeMask) const;
+    QVector<CityEntity> withinBox(double minX, double minY, double maxX, double maxY, quint32 typeMask) const;
+    // Closest first; the first form skips the entity it starts from
+    QVector<CityEntity> nearest(EntityType fromType, const QString &fromId, int k, quint32 typeMask) const;
+    QVector<CityEntity> nearest(double x, double y, int k, quint32 typeMask) const;
+
+    const SpatialIndex &index() const { return m_index; }
+    // Positions touched since the last call, for a renderer that caches
+    // what it drew (the city map is the one consumer); false when there
+    // were more than MAX_PENDING_CHANGES and everything should be redrawn
+    bool takeChanges(QVector<CityChange> &out);
+
+    static quint32 typeBit(EntityType type) { return SpatialIndex::typeBit(type); }
+    static constexpr double CITY_WIDTH_METRES = 4000.0;
+    static constexpr double CITY_HEIGHT_METRES = 3300.0;
+    static const int MAX_PENDING_CHANGES = 4096;
+    // How long a dispatched patrol unit stays on scene
+    static const int PATROL_ON_CALL_MS = 120000;
+
+private:
+    CityLayout();
+    static QString key(EntityType type, const QString &id);
+    CityEntity entity(int handle, double x, double y) const;
+    void noteChange(int type, double x, double y, bool moved = true);
+
+    SpatialIndex m_index;
+    QHash<QString, int> m_handles;        // type:id -> index handle
+    QVector<QString> m_ids;               // per handle
+    QVector<double> m_values;             // per handle
+    QHash<QString, QPointF> m_gazetteer;  // lower-case landmark -> position
+    QVector<CityChange> m_changes;
+    bool m_changesOverflowed;
+    QSet<QString> m_patrolsOnCall;        // unavailable until they return to station
+};
+
+#endif // CITYLAYOUT_H
@@ -0,0 +1,438 @@
+#include "citymapwidget.h"
+#include "metricsregistry.h"
+#include "tickdriver.h"
+#include "tracer.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QElapsedTimer>
+#include <cmath>
+
+namespace {
+const double MARKER_RADIUS = 3.0;
+const double PATROL_RADIUS = 5.0;
+const int ZONE_LABEL_MIN_PX = 90;
+const int PATROL_LABEL_MIN_LEVEL = 3;
+
+// Everything except zones (drawn as fills) and patrols (drawn live)
+quint32 staticTypes()
+{
+    quint32 mask = 0;
+    for (int type = 0; type < CityLayout::ENTITY_TYPE_COUNT; ++type) {
+        if (type != CityLayout::Zone && type != CityLayout::Patrol) mask |= SpatialIndex::typeBit(type);
+    }
+    return mask;
+}
+
+QString clusterLabel(int count)
+{
+    if (count < 1000) return QString::number(count);
+    return QString("%1k").arg(count / 1000);
+}
+}
+
+CityMapWidget::CityMapWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_scale(TILE_SIZE / WORLD_METRES)
+    , m_fitted(false)
+    , m_dragging(false)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(360);
+    m_tiles.setMaxCost(TILE_CACHE_KB);
+
+    // Zones are points in the layout; each owns its cell of the 3 x 3 map
+    const double zoneWidth = CityLayout::CITY_WIDTH_METRES / 3;
+    const double zoneHeight = CityLayout::CITY_HEIGHT_METRES / 3;
+    QVector<CityEntity> zones = CityLayout::instance()->withinBox(
+        0, 0, CityLayout::CITY_WIDTH_METRES, CityLayout::CITY_HEIGHT_METRES,
+        CityLayout::typeBit(CityLayout::Zone));
+    for (const CityEntity &entity : zones) {
+        Zone zone;
+        zone.name = entity.id;
+        zone.rect = QRectF(entity.x - zoneWidth / 2, entity.y - zoneHeight / 2, zoneWidth, zoneHeight);
+        zone.status = Normal;
+        m_zones.append(zone);
+    }
+    m_centre = QPointF(CityLayout::CITY_WIDTH_METRES / 2, CityLayout::CITY_HEIGHT_METRES / 2);
+
+    // Pick up entity changes from the layout
+    m_refreshTick = TickDriver::instance()->add("City map", REFRESH_MS, this, [this]() { onRefresh(); });
+    
+    // Changes pile up in the layout's journal while the dashboard is hidden
+    // (or it overflows into a full redraw) and are applied on return
+    m_lifecycle = new PageLifecycle(this);
+    m_lifecycle->manage(m_refreshTick, 0, 0);
+    connect(m_lifecycle, &PageLifecycle::resumed, this, &CityMapWidget::onRefresh);
+}
+
+void CityMapWidget::setZoneStatus(const QString &zone, ZoneStatus status)
+{
+    for (Zone &entry : m_zones) {
+        if (entry.name != zone || entry.status == status) continue;
+        entry.status = status;
+        invalidate(entry.rect);
+        update();
+    }
+}
+
+void CityMapWidget::setHeatmap(int entityType)
+{
+    m_heatmap.setEntityType(entityType);
+    m_heatmap.update(*CityLayout::instance());
+    update();
+}
+
+void CityMapWidget::fitCity()
+{
+    if (width() <= 0 || height() <= 0) return;
+    double scale = qMin(width() / CityLayout::CITY_WIDTH_METRES, height() / CityLayout::CITY_HEIGHT_METRES) * 0.95;
+    m_scale = qBound(TILE_SIZE / WORLD_METRES / 2, scale, TILE_SIZE / tileMetres(MAX_LEVEL));
+    m_centre = QPointF(CityLayout::CITY_WIDTH_METRES / 2, CityLayout::CITY_HEIGHT_METRES / 2);
+    update();
+}
+
+quint64 CityMapWidget::tileKey(int level, int tx, int ty)
+{
+    return (static_cast<quint64>(level) << 40) | (static_cast<quint64>(tx) << 20) | static_cast<quint64>(ty);
+}
+
+double CityMapWidget::tileMetres(int level)
+{
+    return WORLD_METRES / (1 << level);
+}
+
+int CityMapWidget::levelFor(double scale) const
+{
+    // The coarsest level whose tiles are at least as sharp as the view
+    double level = std::ceil(std::log2(scale * WORLD_METRES / TILE_SIZE) - 1e-6);
+    return qBound(0, static_cast<int>(level), static_cast<int>(MAX_LEVEL));
+}
+
+QPointF CityMapWidget::worldToScreen(double x, double y) const
+{
+    return QPointF(width() / 2.0 + (x - m_centre.x()) * m_scale,
+                   height() / 2.0 - (y - m_centre.y()) * m_scale);
+}
+
+QPointF CityMapWidget::screenToWorld(const QPointF &point) const
+{
+    return QPointF(m_centre.x() + (point.x() - width() / 2.0) / m_scale,
+                   m_centre.y() - (point.y() - height() / 2.0) / m_scale);
+}
+
+QRect CityMapWidget::tileScreenRect(int level, int tx, int ty) const
+{
+    // Round both corners so neighbouring tiles meet without seams
+    const double metres = tileMetres(level);
+    QPointF topLeft = worldToScreen(tx * metres, (ty + 1) * metres);
+    QPointF bottomRight = worldToScreen((tx + 1) * metres, ty * metres);
+    return QRect(QPoint(qRound(topLeft.x()), qRound(topLeft.y())),
+                 QPoint(qRound(bottomRight.x()) - 1, qRound(bottomRight.y()) - 1));
+}
+
+void CityMapWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    SCOPED_LATENCY("paint_us", "City map");
+    TRACE_SCOPE("CityMapWidget::paintEvent");
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(COLOR_BACKGROUND));
+
+    // Visible tiles of the current level
+    const int level = levelFor(m_scale);
+    const int tiles = 1 << level;
+    const double metres = tileMetres(level);
+    QPointF topLeft = screenToWorld(QPointF(0, 0));
+    QPointF bottomRight = screenToWorld(QPointF(width(), height()));
+    int firstX = qMax(0, static_cast<int>(std::floor(topLeft.x() / metres)));
+    int lastX = qMin(tiles - 1, static_cast<int>(std::floor(bottomRight.x() / metres)));
+    int firstY = qMax(0, static_cast<int>(std::floor(bottomRight.y() / metres)));
+    int lastY = qMin(tiles - 1, static_cast<int>(std::floor(topLeft.y() / metres)));
+
+    QElapsedTimer budget;
+    budget.start();
+    bool pending = false;
+    for (int ty = firstY; ty <= lastY; ++ty) {
+        for (int tx = firstX; tx <= lastX; ++tx) {
+            QRect target = tileScreenRect(level, tx, ty);
+            const quint64 key = tileKey(level, tx, ty);
+            QPixmap *tile = m_tiles.object(key);
+            if (!tile && budget.elapsed() < TILE_BUDGET_MS) {
+                tile = new QPixmap(renderTile(level, tx, ty));
+                m_tiles.insert(key, tile, TILE_SIZE * TILE_SIZE * 4 / 1024);
+            }
+            if (tile) {
+                painter.drawPixmap(target, *tile);
+            } else {
+                drawFallback(painter, level, tx, ty, target);
+                pending = true;
+            }
+        }
+    }
+
+    // Heat overlay stretched over the world square
+    if (m_heatmap.isEnabled()) {
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        QRectF world(worldToScreen(0, WORLD_METRES), worldToScreen(WORLD_METRES, 0));
+        painter.drawImage(world, m_heatmap.image());
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    }
+
+    drawOverlay(painter);
+
+    // Out of budget: the remaining tiles render on the next frames
+    if (pending) update();
+}
+
+QPixmap CityMapWidget::renderTile(int level, int tx, int ty) const
+{
+    const double metres = tileMetres(level);
+    const double ppm = TILE_SIZE / metres;
+    const double minX = tx * metres;
+    const double minY = ty * metres;
+
+    QPixmap pixmap(TILE_SIZE, TILE_SIZE);
+    pixmap.fill(QColor(COLOR_BACKGROUND));
+    QPainter painter(&pixmap);
+
+    // Zone fills; tile pixels run downward, world metres northward
+    const QRectF tileWorld(minX, minY, metres, metres);
+    for (const Zone &zone : m_zones) {
+        if (!zone.rect.intersects(tileWorld)) continue;
+        QRectF area((zone.rect.x() - minX) * ppm,
+                    TILE_SIZE - (zone.rect.y() + zone.rect.height() - minY) * ppm,
+                    zone.rect.width() * ppm, zone.rect.height() * ppm);
+        QColor fill = statusColor(zone.status);
+        fill.setAlpha(zone.status == Normal ? 20 : 45);
+        painter.fillRect(area, fill);
+        painter.setPen(QPen(QColor(COLOR_BORDER), 2));
+        painter.drawRect(area);
+    }
+
+    // Bucket markers into cluster cells; a cell with one marker shows it
+    struct Cell
+    {
+        int count = 0;
+        int type = 0;
+        bool mixed = false;
+        QPointF at;
+    };
+    const int cells = TILE_SIZE / CLUSTER_SIZE;
+    QVector<Cell> grid(cells * cells);
+    QVector<int> handles;
+    const SpatialIndex &index = CityLayout::instance()->index();
+    index.withinBox(minX, minY, minX + metres, minY + metres, staticTypes(), handles);
+    for (int handle : handles) {
+        double px = (index.x(handle) - minX) * ppm;
+        double py = TILE_SIZE - (index.y(handle) - minY) * ppm;
+        int column = qBound(0, static_cast<int>(px / CLUSTER_SIZE), cells - 1);
+        int row = qBound(0, static_cast<int>(py / CLUSTER_SIZE), cells - 1);
+        Cell &cell = grid[row * cells + column];
+        if (cell.count == 0) {
+            cell.type = index.type(handle);
+            cell.at = QPointF(px, py);
+        } else if (cell.type != index.type(handle)) {
+            cell.mixed = true;
+        }
+        ++cell.count;
+    }
+
+    painter.setRenderHint(QPainter::Antialiasing);
+    QFont font = painter.font();
+    font.setPixelSize(8);
+    font.setBold(true);
+    painter.setFont(font);
+    for (int row = 0; row < cells; ++row) {
+        for (int column = 0; column < cells; ++column) {
+            const Cell &cell = grid[row * cells + column];
+            if (cell.count == 0) continue;
+            const QRectF bounds(column * CLUSTER_SIZE, row * CLUSTER_SIZE, CLUSTER_SIZE, CLUSTER_SIZE);
+            painter.setPen(Qt::NoPen);
+            if (cell.count == 1) {
+                // Kept inside its cell so it never spills into another tile
+                QPointF at(qBound(bounds.left() + MARKER_RADIUS, cell.at.x(), bounds.right() - MARKER_RADIUS),
+                           qBound(bounds.top() + MARKER_RADIUS, cell.at.y(), bounds.bottom() - MARKER_RADIUS));
+                painter.setBrush(typeColor(cell.type));
+                painter.drawEllipse(at, MARKER_RADIUS, MARKER_RADIUS);
+            } else {
+                painter.setBrush(cell.mixed ? QColor(COLOR_ACCENT) : typeColor(cell.type));
+                painter.drawEllipse(bounds.adjusted(1, 1, -1, -1));
+                painter.setPen(Qt::white);
+                painter.drawText(bounds, Qt::AlignCenter, clusterLabel(cell.count));
+            }
+        }
+    }
+    return pixmap;
+}
+
+bool CityMapWidget::drawFallback(QPainter &painter, int level, int tx, int ty, const QRect &target)
+{
+    // Stretch the matching part of the nearest cached coarser tile
+    for (int parent = level - 1; parent >= 0; --parent) {
+        const int shift = level - parent;
+        QPixmap *tile = m_tiles.object(tileKey(parent, tx >> shift, ty >> shift));
+        if (!tile) continue;
+        const int span = 1 << shift;
+        const double size = static_cast<double>(TILE_SIZE) / span;
+        QRectF source((tx & (span - 1)) * size, (span - 1 - (ty & (span - 1))) * size, size, size);
+        painter.drawPixmap(QRectF(target), *tile, source);
+        return true;
+    }
+    return false;
+}
+
+void CityMapWidget::drawOverlay(QPainter &painter)
+{
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // Zone names once there is room for them
+    QFont font = painter.font();
+    font.setPixelSize(12);
+    font.setBold(true);
+    painter.setFont(font);
+    for (const Zone &zone : m_zones) {
+        QRectF area(worldToScreen(zone.rect.x(), zone.rect.y() + zone.rect.height()),
+                    worldToScreen(zone.rect.x() + zone.rect.width(), zone.rect.y()));
+        if (area.width() < ZONE_LABEL_MIN_PX || !area.intersects(rect())) continue;
+        QRectF label(area.x(), area.y() + 8, area.width(), 18);
+        painter.setPen(zone.status == Normal ? QColor(COLOR_TEXT) : statusColor(zone.status));
+        painter.drawText(label, Qt::AlignCenter, zone.name);
+    }
+
+    // Patrol units move, so they are drawn live and culled to the view
+    QPointF topLeft = screenToWorld(QPointF(-PATROL_RADIUS, -PATROL_RADIUS));
+    QPointF bottomRight = screenToWorld(QPointF(width() + PATROL_RADIUS, height() + PATROL_RADIUS));
+    QVector<CityEntity> patrols = CityLayout::instance()->withinBox(
+        topLeft.x(), bottomRight.y(), bottomRight.x(), topLeft.y(), CityLayout::typeBit(CityLayout::Patrol));
+    font.setPixelSize(10);
+    painter.setFont(font);
+    const bool labelled = levelFor(m_scale) >= PATROL_LABEL_MIN_LEVEL;
+    for (const CityEntity &patrol : patrols) {
+        QPointF at = worldToScreen(patrol.x, patrol.y);
+        painter.setPen(QPen(Qt::white, 1.5));
+        painter.setBrush(typeColor(CityLayout::Patrol));
+        painter.drawEllipse(at, PATROL_RADIUS, PATROL_RADIUS);
+        if (labelled) {
+            painter.setPen(QColor(COLOR_TEXT));
+            painter.drawText(at + QPointF(PATROL_RADIUS + 3, 4), patrol.id);
+        }
+    }
+}
+
+void CityMapWidget::invalidate(double x, double y)
+{
+    for (int level = 0; level <= MAX_LEVEL; ++level) {
+        const double metres = tileMetres(level);
+        int tx = static_cast<int>(std::floor(x / metres));
+        int ty = static_cast<int>(std::floor(y / metres));
+        if (tx < 0 || ty < 0 || tx >= (1 << level) || ty >= (1 << level)) continue;
+        m_tiles.remove(tileKey(level, tx, ty));
+    }
+}
+
+void CityMapWidget::invalidate(const QRectF &world)
+{
+    const QList<quint64> keys = m_tiles.keys();
+    for (quint64 key : keys) {
+        const int level = static_cast<int>(key >> 40);
+        const int tx = static_cast<int>((key >> 20) & 0xFFFFF);
+        const int ty = static_cast<int>(key & 0xFFFFF);
+        const double metres = tileMetres(level);
+        if (QRectF(tx * metres, ty * metres, metres, metres).intersects(world)) m_tiles.remove(key);
+    }
+}
+
+void CityMapWidget::onRefresh()
+{
+    CityLayout *layout = CityLayout::instance();
+    QVector<CityChange> changes;
+    if (!layout->takeChanges(changes)) {
+        // Too much moved to list; start over
+        m_tiles.clear();
+        m_heatmap.markAllDirty();
+        m_heatmap.update(*layout);
+        update();
+        return;
+    }
+    if (changes.isEmpty()) return;
+
+    const quint32 cached = staticTypes();
+    for (const CityChange &change : changes) {
+        if (change.moved && (cached & SpatialIndex::typeBit(change.type))) invalidate(change.x, change.y);
+        if (change.type == m_heatmap.entityType()) m_heatmap.markDirty(change.x, change.y);
+    }
+    m_heatmap.update(*layout);
+    update();
+}
+
+void CityMapWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    if (!m_fitted && width() > 0 && height() > 0) {
+        fitCity();
+        m_fitted = true;
+    }
+}
+
+void CityMapWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    m_dragging = true;
+    m_dragStart = event->position();
+    m_dragCentre = m_centre;
+    setCursor(Qt::ClosedHandCursor);
+}
+
+void CityMapWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_dragging) return;
+    QPointF delta = event->position() - m_dragStart;
+    m_centre = QPointF(m_dragCentre.x() - delta.x() / m_scale, m_dragCentre.y() + delta.y() / m_scale);
+    update();
+}
+
+void CityMapWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event);
+    m_dragging = false;
+    unsetCursor();
+}
+
+void CityMapWidget::wheelEvent(QWheelEvent *event)
+{
+    // Zoom half a level per notch, keeping the point under the cursor still
+    QPointF anchor = event->position();
+    QPointF before = screenToWorld(anchor);
+    double notches = event->angleDelta().y() / 120.0;
+    m_scale = qBound(TILE_SIZE / WORLD_METRES / 2, m_scale * std::pow(2.0, notches / 2),
+                     TILE_SIZE / tileMetres(MAX_LEVEL));
+    m_centre += before - screenToWorld(anchor);
+    event->accept();
+    update();
+}
+
+QColor CityMapWidget::typeColor(int type) const
+{
+    switch (type) {
+    case CityLayout::Bin: return QColor(COLOR_SUCCESS);
+    case CityLayout::Pole: return QColor("#FFD600");
+    case CityLayout::Crosswalk: return QColor(COLOR_WARNING);
+    case CityLayout::Station: return QColor(COLOR_ACCENT);
+    case CityLayout::Home: return QColor("#AB47BC");
+    case CityLayout::Patrol: return QColor(COLOR_CRITICAL);
+    default: return QColor(COLOR_TEXT);
+    }
+}
+
+QColor CityMapWidget::statusColor(ZoneStatus status) const
+{
+    switch (status) {
+    case Warning: return QColor(COLOR_WARNING);
+    case Alert: return QColor(COLOR_CRITICAL);
+    default: return QColor(COLOR_SUCCESS);
+    }
+}
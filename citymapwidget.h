@@ -0,0 +1,108 @@
+#ifndef CITYMAPWIDGET_H
+#define CITYMAPWIDGET_H
+
+#include <QWidget>
+#include <QCache>
+#include <QPixmap>
+#include <QVector>
+#include <QRectF>
+#include <QPointF>
+#include "citylayout.h"
+#include "heatmaplayer.h"
+#include "pagelifecycle.h"
+
+// The dashboard's city map, drawn from CityLayout's spatial index. Zone
+// fills and static entities are rendered into TILE_SIZE pixmap tiles, one
+// set per power-of-two zoom level, and cached, so panning and zooming only
+// blit; markers sharing a CLUSTER_SIZE cell of a tile collapse into one
+// counted cluster, which is the level of detail when zoomed out. Changes
+// reported by CityLayout drop only the tiles under them. Moving units and
+// labels are painted live over the tiles, culled to the viewport. Tiles
+// missing from the cache are rendered within TILE_BUDGET_MS per frame; the
+// rest show a scaled coarser tile until they catch up. One heat overlay
+// built from entity values can be laid over the tiles.
+class CityMapWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum ZoneStatus {
+        Normal,
+        Warning,
+        Alert
+    };
+
+    explicit CityMapWidget(QWidget *parent = nullptr);
+
+    void setZoneStatus(const QString &zone, ZoneStatus status);
+    // Heat overlay from one entity type's values; -1 hides it
+    void setHeatmap(int entityType);
+    void fitCity();
+
+    static const int TILE_SIZE = 256;
+    static const int CLUSTER_SIZE = 16;
+    static const int MAX_LEVEL = 8;             // 16 m per tile
+    static const int TILE_BUDGET_MS = 8;
+    static const int TILE_CACHE_KB = 96 * 1024;
+    static const int REFRESH_MS = 250;
+    static constexpr double WORLD_METRES = 4096.0;  // level 0 tile, covers the city
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private slots:
+    void onRefresh();
+
+private:
+    struct Zone
+    {
+        QString name;
+        QRectF rect;             // world metres
+        ZoneStatus status;
+    };
+
+    static quint64 tileKey(int level, int tx, int ty);
+    static double tileMetres(int level);
+    int levelFor(double scale) const;
+    QPointF worldToScreen(double x, double y) const;
+    QPointF screenToWorld(const QPointF &point) const;
+    QRect tileScreenRect(int level, int tx, int ty) const;
+
+    QPixmap renderTile(int level, int tx, int ty) const;
+    bool drawFallback(QPainter &painter, int level, int tx, int ty, const QRect &target);
+    void drawOverlay(QPainter &painter);
+    void invalidate(double x, double y);
+    void invalidate(const QRectF &world);
+    QColor typeColor(int type) const;
+    QColor statusColor(ZoneStatus status) const;
+
+    QVector<Zone> m_zones;
+    QCache<quint64, QPixmap> m_tiles;
+    HeatmapLayer m_heatmap;
+    int m_refreshTick;
+    PageLifecycle *m_lifecycle;
+
+    // View: world point at the widget centre and pixels per metre
+    QPointF m_centre;
+    double m_scale;
+    bool m_fitted;
+    bool m_dragging;
+    QPointF m_dragStart;
+    QPointF m_dragCentre;
+
+    // Color definitions
+    const QString COLOR_BACKGROUND = "#1A1A1A";
+    const QString COLOR_BORDER = "#2A2A2A";
+    const QString COLOR_ACCENT = "#1E90FF";
+    const QString COLOR_SUCCESS = "#00C853";
+    const QString COLOR_WARNING = "#FF9800";
+    const QString COLOR_CRITICAL = "#D32F2F";
+    const QString COLOR_TEXT = "#E0E0E0";
+};
+
+#endif // CITYMAPWIDGET_H
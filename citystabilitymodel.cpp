@@ -0,0 +1,259 @@
+#include "citystabilitymodel.h"
+#include "metricsregistry.h"
+
+CityStabilityModel::CityStabilityModel()
+    : QObject(nullptr)
+    , m_lastScore(100)
+{
+    m_scoreMetric = MetricsRegistry::instance()->gauge("stability_score", "City");
+    m_scoreMetric->set(m_lastScore);
+
+    for (int f = 0; f < RISK_FACTOR_COUNT; ++f) m_cityRisk[f] = 0.0;
+
+    // Zone 0; baselines match the previous fixed risk levels
+    int core = zone("City Core");
+    setBaseline(core, WasteRisk, 10.0);
+    setBaseline(core, SafetyRisk, 15.0);
+    setBaseline(core, EnergyRisk, 8.0);
+    setBaseline(core, CyberRisk, 5.0);
+}
+
+CityStabilityModel *CityStabilityModel::instance()
+{
+    static CityStabilityModel model;
+    return &model;
+}
+
+double CityStabilityModel::factorWeight(RiskFactor factor)
+{
+    static const double weights[RISK_FACTOR_COUNT] = {0.3, 0.4, 0.3, 0.5};
+    return weights[factor];
+}
+
+int CityStabilityModel::zone(const QString &name)
+{
+    QHash<QString, int>::const_iterator it = m_zoneIndex.constFind(name);
+    if (it != m_zoneIndex.constEnd()) return it.value();
+
+    int index = m_zoneNames.size();
+    m_zoneNames.append(name);
+    m_zoneIndex.insert(name, index);
+    for (int f = 0; f < RISK_FACTOR_COUNT; ++f) {
+        m_risk.append(0.0);
+        m_baseline.append(0.0);
+        m_condition.append(0.0);
+    }
+    m_isElevated.append(0);
+
+    // A new Fenwick node covers (i - lowbit(i), i]; the new zone adds nothing
+    int node = index + 1;
+    int lowbit = node & -node;
+    m_tree.append(prefixPenalty(index - 1) - prefixPenalty(node - lowbit - 1));
+    return index;
+}
+
+void CityStabilityModel::assignSensor(quint32 sensor, int zone)
+{
+    if (zone < 0 || zone >= m_zoneNames.size()) return;
+    if (static_cast<int>(sensor) >= m_sensorZone.size()) {
+        int oldSize = m_sensorZone.size();
+        m_sensorZone.resize(static_cast<int>(sensor) + 1);
+        for (int i = oldSize; i < m_sensorZone.size(); ++i) m_sensorZone[i] = -1;
+    }
+    m_sensorZone[sensor] = zone;
+}
+
+int CityStabilityModel::sensorZone(quint32 sensor) const
+{
+    int zone = m_sensorZone.value(static_cast<int>(sensor), -1);
+    return zone < 0 ? coreZone() : zone;
+}
+
+void CityStabilityModel::setBaseline(int zone, RiskFactor factor, double risk)
+{
+    if (zone < 0 || zone >= m_zoneNames.size()) return;
+    int index = zone * RISK_FACTOR_COUNT + factor;
+    m_baseline[index] = risk + m_condition[index];
+    changeRisk(zone, factor, m_baseline[index]);
+    emit zoneRiskChanged(zone);
+    notifyScore();
+}
+
+void CityStabilityModel::addRisk(int zone, RiskFactor factor, double delta)
+{
+    if (zone < 0 || zone >= m_zoneNames.size()) return;
+    changeRisk(zone, factor, m_risk[zone * RISK_FACTOR_COUNT + factor] + delta);
+    notifyScore();
+}
+
+void CityStabilityModel::setConditionRisk(int zone, RiskFactor factor, double risk)
+{
+    if (zone < 0 || zone >= m_zoneNames.size()) return;
+    int index = zone * RISK_FACTOR_COUNT + factor;
+    double delta = risk - m_condition[index];
+    if (delta == 0.0) return;
+    m_condition[index] = risk;
+    m_baseline[index] += delta;
+    changeRisk(zone, factor, m_risk[index] + delta);
+    notifyScore();
+}
+
+void CityStabilityModel::relieve(int zone, RiskFactor factor, double amount)
+{
+    if (zone < 0 || zone >= m_zoneNames.size()) return;
+    int index = zone * RISK_FACTOR_COUNT + factor;
+    double excess = m_risk[index] - m_baseline[index];
+    if (excess <= 0.0 || amount <= 0.0) return;
+    changeRisk(zone, factor, m_risk[index] - qMin(amount, excess));
+    notifyScore();
+}
+
+double CityStabilityModel::risk(int zone, RiskFactor factor) const
+{
+    if (zone < 0 || zone >= m_zoneNames.size()) return 0.0;
+    return m_risk[zone * RISK_FACTOR_COUNT + factor];
+}
+
+double CityStabilityModel::baseline(int zone, RiskFactor factor) const
+{
+    if (zone < 0 || zone >= m_zoneNames.size()) return 0.0;
+    return m_baseline[zone * RISK_FACTOR_COUNT + factor];
+}
+
+void CityStabilityModel::changeRisk(int zone, RiskFactor factor, double value)
+{
+    int index = zone * RISK_FACTOR_COUNT + factor;
+    double old = m_risk[index];
+    if (value == old) return;
+
+    m_risk[index] = value;
+    m_cityRisk[factor] += value - old;
+    fenwickAdd(zone, (value - old) * factorWeight(factor));
+    if (value > m_baseline[index]) markElevated(zone);
+    emit zoneRiskChanged(zone);
+}
+
+void CityStabilityModel::markElevated(int zone)
+{
+    if (m_isElevated[zone]) return;
+    m_isElevated[zone] = 1;
+    m_elevated.append(zone);
+}
+
+bool CityStabilityModel::isElevated(int zone) const
+{
+    for (int f = 0; f < RISK_FACTOR_COUNT; ++f) {
+        int index = zone * RISK_FACTOR_COUNT + f;
+        if (m_risk[index] > m_baseline[index]) return true;
+    }
+    return false;
+}
+
+void CityStabilityModel::recover(double step)
+{
+    // Only zones above a baseline are visited
+    for (int i = m_elevated.size() - 1; i >= 0; --i) {
+        int zone = m_elevated[i];
+        for (int f = 0; f < RISK_FACTOR_COUNT; ++f) {
+            int index = zone * RISK_FACTOR_COUNT + f;
+            if (m_risk[index] > m_baseline[index]) {
+                changeRisk(zone, static_cast<RiskFactor>(f), qMax(m_baseline[index], m_risk[index] - step));
+            }
+        }
+        if (!isElevated(zone)) {
+            m_isElevated[zone] = 0;
+            m_elevated[i] = m_elevated.last();
+            m_elevated.removeLast();
+        }
+    }
+    notifyScore();
+}
+
+void CityStabilityModel::reset()
+{
+    for (int zone = 0; zone < m_zoneNames.size(); ++zone) {
+        for (int f = 0; f < RISK_FACTOR_COUNT; ++f) {
+            m_risk[zone * RISK_FACTOR_COUNT + f] = m_baseline[zone * RISK_FACTOR_COUNT + f];
+        }
+        m_isElevated[zone] = 0;
+        emit zoneRiskChanged(zone);
+    }
+    m_elevated.clear();
+
+    for (int f = 0; f < RISK_FACTOR_COUNT; ++f) m_cityRisk[f] = 0.0;
+    for (int i = 0; i < m_risk.size(); ++i) m_cityRisk[i % RISK_FACTOR_COUNT] += m_risk[i];
+
+    // Rebuilding also sheds any floating-point drift from incremental updates
+    rebuildTree();
+    notifyScore();
+}
+
+double CityStabilityModel::zonePenalty(int zone) const
+{
+    if (zone < 0 || zone >= m_zoneNames.size()) return 0.0;
+    double penalty = 0.0;
+    for (int f = 0; f < RISK_FACTOR_COUNT; ++f) {
+        penalty += m_risk[zone * RISK_FACTOR_COUNT + f] * factorWeight(static_cast<RiskFactor>(f));
+    }
+    return penalty;
+}
+
+double CityStabilityModel::rangePenalty(int firstZone, int lastZone) const
+{
+    firstZone = qMax(0, firstZone);
+    lastZone = qMin(lastZone, m_zoneNames.size() - 1);
+    if (firstZone > lastZone) return 0.0;
+    return prefixPenalty(lastZone) - prefixPenalty(firstZone - 1);
+}
+
+int CityStabilityModel::cityScore() const
+{
+    return qBound(0, static_cast<int>(100.0 - totalPenalty()), 100);
+}
+
+int CityStabilityModel::worstZone() const
+{
+    int worst = coreZone();
+    double worstPenalty = -1.0;
+    for (int zone : m_elevated) {
+        double penalty = zonePenalty(zone);
+        if (penalty > worstPenalty) {
+            worst = zone;
+            worstPenalty = penalty;
+        }
+    }
+    return worst;
+}
+
+double CityStabilityModel::prefixPenalty(int zone) const
+{
+    // Sum of penalties for zones [0, zone]
+    double sum = 0.0;
+    for (int node = zone + 1; node > 0; node -= node & -node) sum += m_tree[node - 1];
+    return sum;
+}
+
+void CityStabilityModel::fenwickAdd(int zone, double delta)
+{
+    for (int node = zone + 1; node <= m_tree.size(); node += node & -node) m_tree[node - 1] += delta;
+}
+
+void CityStabilityModel::rebuildTree()
+{
+    // O(n) bottom-up construction
+    const int n = m_zoneNames.size();
+    for (int zone = 0; zone < n; ++zone) m_tree[zone] = zonePenalty(zone);
+    for (int node = 1; node <= n; ++node) {
+        int parent = node + (node & -node);
+        if (parent <= n) m_tree[parent - 1] += m_tree[node - 1];
+    }
+}
+
+void CityStabilityModel::notifyScore()
+{
+    int score = cityScore();
+    if (score == m_lastScore) return;
+    m_lastScore = score;
+    m_scoreMetric->set(score);
+    emit scoreChanged(score);
+}
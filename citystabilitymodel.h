@@ -0,0 +1,110 @@
+#ifndef CITYSTABILITYMODEL_H
+#define CITYSTABILITYMODEL_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+class MetricGauge;
+
+// The one city stability score, shared by every page. Each zone carries
+// risk contributions per factor; a zone's penalty is the factor-weighted
+// sum of its risks and the score is 100 minus the penalty of the whole
+// city. Zone penalties sit in a Fenwick tree, so changing one zone costs
+// O(log zones) and any contiguous range of zones can be summed just as
+// cheaply. GUI thread only.
+class CityStabilityModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum RiskFactor {
+        WasteRisk,
+        SafetyRisk,
+        EnergyRisk,
+        CyberRisk,
+        RISK_FACTOR_COUNT
+    };
+
+    static CityStabilityModel *instance();
+
+    // Zones; zone 0 is the city core, which holds city-wide baselines and
+    // anything that cannot be placed
+    int zone(const QString &name);
+    int coreZone() const { return 0; }
+    int zoneCount() const { return m_zoneNames.size(); }
+    QString zoneName(int zone) const { return m_zoneNames.value(zone); }
+    const QStringList &zoneNames() const { return m_zoneNames; }
+
+    // Sensor placement (sensor ids are the event bus's interned ids)
+    void assignSensor(quint32 sensor, int zone);
+    int sensorZone(quint32 sensor) const;
+
+    // Risk contributions
+    void setBaseline(int zone, RiskFactor factor, double risk);
+    void addRisk(int zone, RiskFactor factor, double delta);
+    // Standing risk from a live condition in the zone (overfull bins,
+    // boosted poles); raises or lowers the baseline and the risk with it
+    void setConditionRisk(int zone, RiskFactor factor, double risk);
+    // Works up to amount of the risk above baseline off
+    void relieve(int zone, RiskFactor factor, double amount);
+    double risk(int zone, RiskFactor factor) const;
+    double baseline(int zone, RiskFactor factor) const;
+    double cityRisk(RiskFactor factor) const { return m_cityRisk[factor]; }
+    // Whole tables, [zone * RISK_FACTOR_COUNT + factor]; implicitly shared,
+    // so a what-if fork costs nothing until one side writes
+    const QVector<double> &riskState() const { return m_risk; }
+    const QVector<double> &baselineState() const { return m_baseline; }
+
+    // Moves every elevated zone up to step back toward its baselines
+    void recover(double step);
+    // Drops every zone back to its baselines
+    void reset();
+
+    // Penalties and score
+    double zonePenalty(int zone) const;
+    double rangePenalty(int firstZone, int lastZone) const;
+    double totalPenalty() const { return prefixPenalty(m_zoneNames.size() - 1); }
+    int cityScore() const;
+    int worstZone() const;
+
+    static double factorWeight(RiskFactor factor);
+
+signals:
+    void scoreChanged(int score);
+    // Any risk or baseline of the zone moved
+    void zoneRiskChanged(int zone);
+
+private:
+    CityStabilityModel();
+
+    void changeRisk(int zone, RiskFactor factor, double value);
+    void markElevated(int zone);
+    bool isElevated(int zone) const;
+    double prefixPenalty(int zone) const;
+    void fenwickAdd(int zone, double delta);
+    void rebuildTree();
+    void notifyScore();
+
+    QStringList m_zoneNames;
+    QHash<QString, int> m_zoneIndex;
+
+    // [zone * RISK_FACTOR_COUNT + factor]
+    QVector<double> m_risk;
+    QVector<double> m_baseline;
+    QVector<double> m_condition;   // part of the baseline from setConditionRisk()
+    double m_cityRisk[RISK_FACTOR_COUNT];
+
+    QVector<double> m_tree;        // Fenwick tree over zone penalties, 1-based
+    QVector<int> m_elevated;       // zones above a baseline, for recover()
+    QVector<quint8> m_isElevated;
+
+    QVector<qint32> m_sensorZone;  // -1 = unplaced
+
+    int m_lastScore;
+    MetricGauge *m_scoreMetric;
+};
+
+#endif // CITYSTABILITYMODEL_H
@@ -0,0 +1,171 @@
+#include "energyaccountingengine.h"
+
+EnergyAccountingEngine::EnergyAccountingEngine()
+    : m_currentHour(-1)
+{
+    for (int h = 0; h < 24; ++h) {
+        m_hourValid[h] = false;
+    }
+}
+
+int EnergyAccountingEngine::addZone(const QString &name)
+{
+    int existing = zoneIndex(name);
+    if (existing >= 0) return existing;
+
+    m_zoneNames.append(name);
+    m_zoneConsumed.append(KahanSum());
+    m_zoneBaseline.append(KahanSum());
+    m_tickConsumed.append(0.0);
+    m_tickBaseline.append(0.0);
+    return m_zoneNames.size() - 1;
+}
+
+int EnergyAccountingEngine::zoneIndex(const QString &name) const
+{
+    return m_zoneNames.indexOf(name);
+}
+
+int EnergyAccountingEngine::addPole(const QString &poleId, int zone, double ratedWatts)
+{
+    if (zone < 0 || zone >= m_zoneNames.size()) return -1;
+    if (m_poleLookup.contains(poleId)) return m_poleLookup.value(poleId);
+
+    int index = m_ratedWatts.size();
+    m_ratedWatts.append(static_cast<float>(ratedWatts));
+    m_intensity.append(0.0f);
+    m_operational.append(1);
+    m_poleZone.append(zone);
+    m_poleLookup.insert(poleId, index);
+    return index;
+}
+
+int EnergyAccountingEngine::poleIndex(const QString &poleId) const
+{
+    return m_poleLookup.value(poleId, -1);
+}
+
+void EnergyAccountingEngine::setIntensity(int pole, int percent)
+{
+    if (pole < 0 || pole >= m_intensity.size()) return;
+    m_intensity[pole] = qBound(0, percent, 100) / 100.0f;
+}
+
+void EnergyAccountingEngine::setOperational(int pole, bool operational)
+{
+    if (pole < 0 || pole >= m_operational.size()) return;
+    m_operational[pole] = operational ? 1 : 0;
+}
+
+double EnergyAccountingEngine::powerWatts(int pole) const
+{
+    if (pole < 0 || pole >= m_ratedWatts.size() || !m_operational[pole]) return 0.0;
+    return m_ratedWatts[pole] * m_intensity[pole];
+}
+
+void EnergyAccountingEngine::advance(double dtSeconds, int hourOfDay)
+{
+    if (hourOfDay < 0 || hourOfDay > 23) return;
+
+    // Entering a new hour recycles yesterday's bucket for that hour
+    if (hourOfDay != m_currentHour) {
+        m_hourConsumed[hourOfDay].reset();
+        m_hourBaseline[hourOfDay].reset();
+        m_hourValid[hourOfDay] = false;
+        m_currentHour = hourOfDay;
+    }
+
+    if (dtSeconds <= 0.0 || m_ratedWatts.isEmpty()) return;
+
+    const int zones = m_zoneNames.size();
+    double *tickConsumed = m_tickConsumed.data();
+    double *tickBaseline = m_tickBaseline.data();
+    for (int z = 0; z < zones; ++z) {
+        tickConsumed[z] = 0.0;
+        tickBaseline[z] = 0.0;
+    }
+
+    // Single pass over the fleet: watts drawn vs. watts at full brightness.
+    // Poles out of service draw nothing and are excluded from the baseline
+    // so failures are not reported as savings.
+    const int poles = m_ratedWatts.size();
+    const float *rated = m_ratedWatts.constData();
+    const float *intensity = m_intensity.constData();
+    const quint8 *operational = m_operational.constData();
+    const int *zoneOf = m_poleZone.constData();
+    for (int i = 0; i < poles; ++i) {
+        double available = operational[i] ? rated[i] : 0.0;
+        tickBaseline[zoneOf[i]] += available;
+        tickConsumed[zoneOf[i]] += available * intensity[i];
+    }
+
+    // Watts x seconds -> watt-hours
+    const double hours = dtSeconds / 3600.0;
+    double totalConsumed = 0.0;
+    double totalBaseline = 0.0;
+    for (int z = 0; z < zones; ++z) {
+        double consumedWh = tickConsumed[z] * hours;
+        double baselineWh = tickBaseline[z] * hours;
+        m_zoneConsumed[z].add(consumedWh);
+        m_zoneBaseline[z].add(baselineWh);
+        totalConsumed += consumedWh;
+        totalBaseline += baselineWh;
+    }
+
+    m_hourConsumed[hourOfDay].add(totalConsumed);
+    m_hourBaseline[hourOfDay].add(totalBaseline);
+    m_hourValid[hourOfDay] = true;
+}
+
+double EnergyAccountingEngine::consumedWh() const
+{
+    double total = 0.0;
+    for (int h = 0; h < 24; ++h) {
+        total += m_hourConsumed[h].sum;
+    }
+    return total;
+}
+
+double EnergyAccountingEngine::baselineWh() const
+{
+    double total = 0.0;
+    for (int h = 0; h < 24; ++h) {
+        total += m_hourBaseline[h].sum;
+    }
+    return total;
+}
+
+double EnergyAccountingEngine::savedPercentage() const
+{
+    return savedPercent(consumedWh(), baselineWh());
+}
+
+double EnergyAccountingEngine::zoneConsumedWh(int zone) const
+{
+    if (zone < 0 || zone >= m_zoneConsumed.size()) return 0.0;
+    return m_zoneConsumed[zone].sum;
+}
+
+double EnergyAccountingEngine::zoneBaselineWh(int zone) const
+{
+    if (zone < 0 || zone >= m_zoneBaseline.size()) return 0.0;
+    return m_zoneBaseline[zone].sum;
+}
+
+bool EnergyAccountingEngine::hasHourlyData(int hour) const
+{
+    if (hour < 0 || hour > 23) return false;
+    return m_hourValid[hour] && m_hourBaseline[hour].sum > 0.0;
+}
+
+double EnergyAccountingEngine::hourlySavedPercentage(int hour) const
+{
+    if (!hasHourlyData(hour)) return 0.0;
+    return savedPercent(m_hourConsumed[hour].sum, m_hourBaseline[hour].sum);
+}
+
+double EnergyAccountingEngine::savedPercent(double consumed, double baseline)
+{
+    if (baseline <= 0.0) return 0.0;
+    return qBound(0.0, (1.0 - consumed / baseline) * 100.0, 100.0);
+}
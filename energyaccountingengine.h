@@ -0,0 +1,91 @@
+#ifndef ENERGYACCOUNTINGENGINE_H
+#define ENERGYACCOUNTINGENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+// Integrates streetlight power draw (intensity x rated wattage x dt) into
+// watt-hours and compares it against a full-brightness baseline.
+// Pole state lives in flat arrays so one tick is a single pass over the fleet.
+class EnergyAccountingEngine
+{
+public:
+    EnergyAccountingEngine();
+
+    // Fleet registration
+    int addZone(const QString &name);
+    int zoneIndex(const QString &name) const;
+    int addPole(const QString &poleId, int zone, double ratedWatts);
+    int poleIndex(const QString &poleId) const;
+    int poleCount() const { return m_ratedWatts.size(); }
+    int zoneCount() const { return m_zoneNames.size(); }
+    QString zoneName(int zone) const { return m_zoneNames.value(zone); }
+
+    // Pole state (takes effect for the next integration interval)
+    void setIntensity(int pole, int percent);
+    void setOperational(int pole, bool operational);
+
+    // Instantaneous draw of one pole
+    double powerWatts(int pole) const;
+
+    // Integrates the interval that just elapsed using the current pole state
+    void advance(double dtSeconds, int hourOfDay);
+
+    // Rolling 24-hour totals
+    double consumedWh() const;
+    double baselineWh() const;
+    double savedPercentage() const;
+
+    // Cumulative per-zone totals since start-up
+    double zoneConsumedWh(int zone) const;
+    double zoneBaselineWh(int zone) const;
+
+    // Per hour-of-day buckets for the energy chart
+    bool hasHourlyData(int hour) const;
+    double hourlySavedPercentage(int hour) const;
+
+    static constexpr double DEFAULT_POLE_WATTAGE = 150.0;
+
+private:
+    // Compensated summation keeps small per-tick increments from being
+    // swallowed once the running totals grow large
+    struct KahanSum {
+        double sum = 0.0;
+        double compensation = 0.0;
+
+        void add(double value)
+        {
+            double y = value - compensation;
+            double t = sum + y;
+            compensation = (t - sum) - y;
+            sum = t;
+        }
+        void reset() { sum = 0.0; compensation = 0.0; }
+    };
+
+    static double savedPercent(double consumed, double baseline);
+
+    // Per-pole state (structure of arrays)
+    QVector<float> m_ratedWatts;
+    QVector<float> m_intensity;     // 0.0 - 1.0
+    QVector<quint8> m_operational;
+    QVector<int> m_poleZone;
+    QHash<QString, int> m_poleLookup;
+
+    // Per-zone accumulators
+    QStringList m_zoneNames;
+    QVector<KahanSum> m_zoneConsumed;
+    QVector<KahanSum> m_zoneBaseline;
+    QVector<double> m_tickConsumed;  // scratch, reused every tick
+    QVector<double> m_tickBaseline;
+
+    // Hour-of-day buckets (rolling 24 hours)
+    KahanSum m_hourConsumed[24];
+    KahanSum m_hourBaseline[24];
+    bool m_hourValid[24];
+    int m_currentHour;
+};
+
+#endif // ENERGYACCOUNTINGENGINE_H
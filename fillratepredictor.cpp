@@ -0,0 +1,130 @@
+#include "fillratepredictor.h"
+#include <QDateTime>
+#include <cmath>
+
+namespace {
+const qint64 HOUR_MS = 3600 * 1000;
+const qint64 DAY_MS = 24 * HOUR_MS;
+// A drop this large is a collection, not a measurement of the fill rate
+const double EMPTIED_DROP = 5.0;
+// Levels at the top are clipped, so they say nothing about the rate
+const double FULL_LEVEL = 99.9;
+// Weekdays with less decayed evidence than this use the pooled rate
+const double MIN_WEEKDAY_HOURS = 0.5;
+}
+
+FillRatePredictor::FillRatePredictor()
+    : m_indexVersion(0)
+    , m_nowMs(0)
+    , m_dayOfWeek(0)
+    , m_dayEndMs(0)
+{
+}
+
+int FillRatePredictor::addBin()
+{
+    m_bins.append(Bin());
+    return m_bins.size() - 1;
+}
+
+void FillRatePredictor::setClock(qint64 nowMs)
+{
+    m_nowMs = nowMs;
+    if (nowMs < m_dayEndMs) return;
+
+    // Only consult the calendar when a day rolls over
+    QDateTime local = QDateTime::fromMSecsSinceEpoch(nowMs);
+    m_dayOfWeek = local.date().dayOfWeek() - 1;
+    m_dayEndMs = nowMs + DAY_MS - local.time().msecsSinceStartOfDay();
+}
+
+void FillRatePredictor::observe(int bin, double fillLevel)
+{
+    Bin &b = m_bins[bin];
+    if (b.lastMs > 0 && m_nowMs > b.lastMs) {
+        double hours = static_cast<double>(m_nowMs - b.lastMs) / HOUR_MS;
+        double delta = fillLevel - b.lastLevel;
+        if (delta > -EMPTIED_DROP && b.lastLevel < FULL_LEVEL && fillLevel < FULL_LEVEL) {
+            // Regress the increment on the hours spent in this weekday
+            const int day = m_dayOfWeek;
+            double decay = std::exp2(-hours / HALF_LIFE_HOURS);
+            b.sumDeltaHours[day] = decay * b.sumDeltaHours[day] + delta * hours;
+            b.sumHoursSquared[day] = decay * b.sumHoursSquared[day] + hours * hours;
+            b.hours[day] = decay * b.hours[day] + hours;
+        }
+    }
+    b.lastLevel = fillLevel;
+    b.lastMs = m_nowMs;
+
+    reindex(bin, predictFullAt(bin, fillLevel));
+}
+
+double FillRatePredictor::pooledRate(const Bin &bin) const
+{
+    double sumDeltaHours = 0.0;
+    double sumHoursSquared = 0.0;
+    for (int day = 0; day < 7; ++day) {
+        sumDeltaHours += bin.sumDeltaHours[day];
+        sumHoursSquared += bin.sumHoursSquared[day];
+    }
+    return sumHoursSquared > 0.0 ? sumDeltaHours / sumHoursSquared : 0.0;
+}
+
+double FillRatePredictor::ratePerHour(int bin, int dayOfWeek) const
+{
+    const Bin &b = m_bins[bin];
+    if (b.hours[dayOfWeek] < MIN_WEEKDAY_HOURS || b.sumHoursSquared[dayOfWeek] <= 0.0) return pooledRate(b);
+    return b.sumDeltaHours[dayOfWeek] / b.sumHoursSquared[dayOfWeek];
+}
+
+qint64 FillRatePredictor::predictFullAt(int bin, double fillLevel) const
+{
+    double remaining = 100.0 - fillLevel;
+    if (remaining <= 100.0 - FULL_LEVEL) return m_nowMs;
+
+    // Spend the remaining capacity day by day at each weekday's rate
+    qint64 dayStartMs = m_nowMs;
+    qint64 dayLengthMs = m_dayEndMs - m_nowMs;
+    int day = m_dayOfWeek;
+    while (dayStartMs - m_nowMs < HORIZON_HOURS * HOUR_MS) {
+        double rate = ratePerHour(bin, day);
+        if (rate > 0.0) {
+            double hoursNeeded = remaining / rate;
+            if (hoursNeeded * HOUR_MS <= dayLengthMs) {
+                return dayStartMs + static_cast<qint64>(hoursNeeded * HOUR_MS);
+            }
+            remaining -= rate * dayLengthMs / HOUR_MS;
+        }
+        dayStartMs += dayLengthMs;
+        dayLengthMs = DAY_MS;
+        day = (day + 1) % 7;
+    }
+    return NEVER;
+}
+
+void FillRatePredictor::reindex(int bin, qint64 fullAtMs)
+{
+    Bin &b = m_bins[bin];
+    if (fullAtMs == b.fullAtMs) return;
+    if (fullAtMs != NEVER && b.fullAtMs != NEVER) {
+        // Far-off predictions may drift further before the index hears of it
+        qint64 tolerance = qMax<qint64>(REINDEX_TOLERANCE_MS, (b.fullAtMs - m_nowMs) / REINDEX_LEAD_FRACTION);
+        if (qAbs(fullAtMs - b.fullAtMs) < tolerance) return;
+    }
+
+    if (b.fullAtMs != NEVER) m_index.remove(b.fullAtMs, bin);
+    if (fullAtMs != NEVER) m_index.insert(fullAtMs, bin);
+    b.fullAtMs = fullAtMs;
+    ++m_indexVersion;
+}
+
+int FillRatePredictor::binsFullBefore(qint64 deadlineMs, QVector<int> &out) const
+{
+    int count = 0;
+    for (QMultiMap<qint64, int>::const_iterator it = m_index.constBegin();
+         it != m_index.constEnd() && it.key() <= deadlineMs; ++it) {
+        out.append(it.value());
+        ++count;
+    }
+    return count;
+}
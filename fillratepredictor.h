@@ -0,0 +1,69 @@
+#ifndef FILLRATEPREDICTOR_H
+#define FILLRATEPREDICTOR_H
+
+#include <QVector>
+#include <QMultiMap>
+#include <limits>
+
+// Predicts when each bin will be full from its observed fill levels. The
+// fill rate is fitted online by least squares with one rate per day of
+// the week (level increments regressed on hours spent in each weekday,
+// older evidence decaying with HALF_LIFE_HOURS), and time-to-full walks
+// the remaining capacity through those weekday rates. Predicted full
+// times sit in a sorted index that is only touched when a prediction
+// moves by more than a minute or 2% of its lead time, so "full before T"
+// is a walk over the answer rather than a scan and sort of every bin.
+class FillRatePredictor
+{
+public:
+    FillRatePredictor();
+
+    int addBin();
+    int binCount() const { return m_bins.size(); }
+
+    // Once per step, before that step's observations
+    void setClock(qint64 nowMs);
+    void observe(int bin, double fillLevel);
+
+    // Percent per hour; the pooled rate while the weekday has little evidence
+    double ratePerHour(int bin, int dayOfWeek) const;
+    qint64 fullAtMs(int bin) const { return m_bins[bin].fullAtMs; }
+
+    // Bins predicted full by the deadline, soonest first
+    int binsFullBefore(qint64 deadlineMs, QVector<int> &out) const;
+    // Bumped whenever the index changes
+    quint64 indexVersion() const { return m_indexVersion; }
+
+    static constexpr qint64 NEVER = std::numeric_limits<qint64>::max();
+    static const int HORIZON_HOURS = 14 * 24;
+    static const int HALF_LIFE_HOURS = 12;
+    static const int REINDEX_TOLERANCE_MS = 60 * 1000;
+    static const int REINDEX_LEAD_FRACTION = 50;      // or 2% of the lead time
+
+private:
+    struct Bin
+    {
+        double lastLevel = -1.0;
+        qint64 lastMs = 0;
+        // Per weekday: decayed sum of increment x hours, hours squared and hours
+        double sumDeltaHours[7] = {};
+        double sumHoursSquared[7] = {};
+        double hours[7] = {};
+        qint64 fullAtMs = NEVER;
+    };
+
+    double pooledRate(const Bin &bin) const;
+    qint64 predictFullAt(int bin, double fillLevel) const;
+    void reindex(int bin, qint64 fullAtMs);
+
+    QVector<Bin> m_bins;
+    QMultiMap<qint64, int> m_index;    // predicted full time -> bin
+    quint64 m_indexVersion;
+
+    // Local calendar of the current step
+    qint64 m_nowMs;
+    int m_dayOfWeek;                   // 0 = Monday
+    qint64 m_dayEndMs;
+};
+
+#endif // FILLRATEPREDICTOR_H
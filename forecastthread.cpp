@@ -0,0 +1,104 @@
+#include "forecastthread.h"
+#include "tracer.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+const int ForecastThread::HORIZON_HOURS[RiskForecaster::HORIZON_COUNT] = {24, 48, 72};
+
+ForecastThread::ForecastThread(QObject *parent)
+    : QThread(parent)
+    , m_refresh(false)
+{
+}
+
+ForecastThread::~ForecastThread()
+{
+    requestInterruption();
+    wait();
+}
+
+void ForecastThread::observe(const QVector<RiskObservation> &samples)
+{
+    QMutexLocker locker(&m_queueMutex);
+    m_queue.append(samples);
+}
+
+void ForecastThread::observeStability(const CityStabilityModel *model, qint64 nowMs)
+{
+    m_stabilitySamples.clear();
+    m_stabilitySamples.append({CITY_SERIES, model->totalPenalty(), nowMs});
+    for (int f = 0; f < CityStabilityModel::RISK_FACTOR_COUNT; ++f) {
+        CityStabilityModel::RiskFactor factor = static_cast<CityStabilityModel::RiskFactor>(f);
+        double weighted = model->cityRisk(factor) * CityStabilityModel::factorWeight(factor);
+        m_stabilitySamples.append({FACTOR_SERIES + f, weighted, nowMs});
+    }
+    for (int zone = 0; zone < model->zoneCount(); ++zone) {
+        m_stabilitySamples.append({ZONE_SERIES + zone, model->zonePenalty(zone), nowMs});
+    }
+    observe(m_stabilitySamples);
+}
+
+void ForecastThread::run()
+{
+    QElapsedTimer timer;
+    while (!isInterruptionRequested()) {
+        ingest();
+
+        bool all = m_refresh.exchange(false, std::memory_order_relaxed);
+        timer.start();
+        int refitSeries = refit(all);
+        if (refitSeries > 0) publish(refitSeries, timer.nsecsElapsed() / 1000);
+
+        msleep(CYCLE_MS);
+    }
+}
+
+void ForecastThread::ingest()
+{
+    {
+        QMutexLocker locker(&m_queueMutex);
+        if (m_queue.isEmpty()) return;
+        m_ingesting.swap(m_queue);
+    }
+
+    for (const RiskObservation &sample : m_ingesting) {
+        m_forecaster.observe(sample.series, sample.value, sample.timestampMs);
+    }
+    m_ingesting.clear();
+}
+
+int ForecastThread::refit(bool all)
+{
+    TRACE_SCOPE("ForecastThread::refit");
+    m_dirty.clear();
+    m_forecaster.takeDirty(m_dirty);
+    if (all) {
+        m_dirty.clear();
+        for (int series = 0; series < m_forecaster.seriesCount(); ++series) m_dirty.append(series);
+    }
+
+    const int count = m_forecaster.seriesCount();
+    if (m_horizons.size() < count * RiskForecaster::HORIZON_COUNT) {
+        m_horizons.resize(count * RiskForecaster::HORIZON_COUNT);
+    }
+
+    for (int series : m_dirty) {
+        m_forecaster.forecastPath(series, RiskForecaster::HORIZON_HOURS, m_path);
+        for (int h = 0; h < RiskForecaster::HORIZON_COUNT; ++h) {
+            m_horizons[series * RiskForecaster::HORIZON_COUNT + h] = m_path[HORIZON_HOURS[h]];
+        }
+        if (series == CITY_SERIES) m_cityPath = m_path;
+    }
+    return m_dirty.size();
+}
+
+void ForecastThread::publish(int refitSeries, qint64 refitMicros)
+{
+    RiskForecastSnapshot &frame = m_frames.writeSlot();
+    frame.cityPath = m_cityPath;
+    frame.horizons = m_horizons;
+    frame.seriesCount = m_forecaster.seriesCount();
+    frame.refitSeries = refitSeries;
+    frame.refitMicros = refitMicros;
+    m_frames.publish();
+}
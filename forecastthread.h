@@ -0,0 +1,75 @@
+#ifndef FORECASTTHREAD_H
+#define FORECASTTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+#include "snapshotbuffer.h"
+#include "riskforecaster.h"
+#include "citystabilitymodel.h"
+
+// One risk sample for a forecast series
+struct RiskObservation
+{
+    int series;
+    double value;
+    qint64 timestampMs;
+};
+
+// Runs the risk forecaster off the GUI thread. Samples are queued with
+// observe(); every CYCLE_MS the thread folds them into the models,
+// re-forecasts only the series whose state changed and publishes a frame
+// with the city path and the 24/48/72 h horizons of every series.
+// Series follow the stability model: the city penalty, then the weighted
+// city risk of each factor, then one series per zone.
+class ForecastThread : public QThread
+{
+public:
+    explicit ForecastThread(QObject *parent = nullptr);
+    ~ForecastThread();
+
+    // Any thread
+    void observe(const QVector<RiskObservation> &samples);
+    // GUI thread; queues one sample for every stability series
+    void observeStability(const CityStabilityModel *model, qint64 nowMs);
+    // Republishes every series on the next cycle
+    void requestRefresh() { m_refresh.store(true, std::memory_order_relaxed); }
+
+    // Consumer side, UI thread only
+    SnapshotBuffer<RiskForecastSnapshot> &frames() { return m_frames; }
+
+    static const int CITY_SERIES = 0;
+    static const int FACTOR_SERIES = 1;
+    static const int ZONE_SERIES = FACTOR_SERIES + CityStabilityModel::RISK_FACTOR_COUNT;
+    static const int CYCLE_MS = 1000;
+    static const int SAMPLE_INTERVAL_MS = 10000;
+    static const int HORIZON_HOURS[RiskForecaster::HORIZON_COUNT];
+
+protected:
+    void run() override;
+
+private:
+    void ingest();
+    int refit(bool all);
+    void publish(int refitSeries, qint64 refitMicros);
+
+    RiskForecaster m_forecaster;
+
+    // Queue of samples waiting for the next cycle
+    QMutex m_queueMutex;
+    QVector<RiskObservation> m_queue;
+    QVector<RiskObservation> m_ingesting;
+    std::atomic<bool> m_refresh;
+    QVector<RiskObservation> m_stabilitySamples;   // GUI thread scratch
+
+    // Latest forecasts, only touched by this thread
+    QVector<RiskForecastPoint> m_cityPath;
+    QVector<RiskForecastPoint> m_horizons;
+    QVector<RiskForecastPoint> m_path;     // scratch
+    QVector<int> m_dirty;
+
+    SnapshotBuffer<RiskForecastSnapshot> m_frames;
+};
+
+#endif // FORECASTTHREAD_H
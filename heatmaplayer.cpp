@@ -0,0 +1,152 @@
+#include "heatmaplayer.h"
+#include "citylayout.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+const int TILES = HeatmapLayer::GRID_SIZE / HeatmapLayer::TILE_CELLS;
+const int TILE = HeatmapLayer::TILE_CELLS;
+const int RADIUS = HeatmapLayer::BLUR_RADIUS_CELLS;
+// A tile plus the blur radius on every side
+const int WINDOW = HeatmapLayer::TILE_CELLS + 2 * HeatmapLayer::BLUR_RADIUS_CELLS;
+const int OVERLAY_ALPHA = 170;
+
+struct ColorStop
+{
+    double at;
+    int red;
+    int green;
+    int blue;
+};
+
+// Cool to hot, matching the dashboard's status colours
+const ColorStop STOPS[] = {
+    {0.0, 30, 144, 255}, {0.35, 0, 200, 83}, {0.65, 255, 214, 0}, {1.0, 211, 47, 47}
+};
+}
+
+HeatmapLayer::HeatmapLayer()
+    : m_type(-1)
+    , m_anyDirty(false)
+    , m_image(GRID_SIZE, GRID_SIZE, QImage::Format_ARGB32_Premultiplied)
+{
+    m_image.fill(Qt::transparent);
+    m_dirty.fill(false, TILES * TILES);
+    m_splat.resize(WINDOW * WINDOW);
+    m_rows.resize(WINDOW * TILE);
+
+    for (int offset = -RADIUS; offset <= RADIUS; ++offset) {
+        m_kernel.append(static_cast<float>(std::exp(-offset * offset / (2 * SIGMA_CELLS * SIGMA_CELLS))));
+    }
+
+    // Transparent at zero, fading in over the low end
+    for (int i = 0; i < 256; ++i) {
+        double t = i / 255.0;
+        int stop = 1;
+        while (stop < 3 && STOPS[stop].at < t) ++stop;
+        const ColorStop &low = STOPS[stop - 1];
+        const ColorStop &high = STOPS[stop];
+        double blend = (t - low.at) / (high.at - low.at);
+        int alpha = static_cast<int>(qMin(1.0, t * 2.5) * OVERLAY_ALPHA);
+        int red = static_cast<int>(low.red + (high.red - low.red) * blend);
+        int green = static_cast<int>(low.green + (high.green - low.green) * blend);
+        int blue = static_cast<int>(low.blue + (high.blue - low.blue) * blend);
+        m_lut.append(qRgba(red * alpha / 255, green * alpha / 255, blue * alpha / 255, alpha));
+    }
+}
+
+void HeatmapLayer::setEntityType(int type)
+{
+    if (type == m_type) return;
+    m_type = type;
+    m_image.fill(Qt::transparent);
+    markAllDirty();
+}
+
+void HeatmapLayer::markDirty(double x, double y)
+{
+    // Every tile the blurred splat can reach
+    int cx = static_cast<int>(std::floor(x / CELL_METRES));
+    int cy = static_cast<int>(std::floor(y / CELL_METRES));
+    int firstX = qMax(0, (cx - RADIUS) / TILE);
+    int lastX = qMin(TILES - 1, qMax(-1, cx + RADIUS) / TILE);
+    int firstY = qMax(0, (cy - RADIUS) / TILE);
+    int lastY = qMin(TILES - 1, qMax(-1, cy + RADIUS) / TILE);
+    for (int ty = firstY; ty <= lastY; ++ty) {
+        for (int tx = firstX; tx <= lastX; ++tx) {
+            m_dirty[ty * TILES + tx] = true;
+            m_anyDirty = true;
+        }
+    }
+}
+
+void HeatmapLayer::markAllDirty()
+{
+    m_dirty.fill(true);
+    m_anyDirty = true;
+}
+
+bool HeatmapLayer::update(const CityLayout &layout)
+{
+    if (!isEnabled() || !m_anyDirty) return false;
+    for (int tile = 0; tile < m_dirty.size(); ++tile) {
+        if (!m_dirty[tile]) continue;
+        renderTile(tile % TILES, tile / TILES, layout);
+        m_dirty[tile] = false;
+    }
+    m_anyDirty = false;
+    return true;
+}
+
+void HeatmapLayer::renderTile(int tx, int ty, const CityLayout &layout)
+{
+    // Window origin in grid cells
+    const int originX = tx * TILE - RADIUS;
+    const int originY = ty * TILE - RADIUS;
+
+    // Splat entity values into the window
+    float *splat = m_splat.data();
+    std::fill(splat, splat + WINDOW * WINDOW, 0.0f);
+    QVector<int> handles;
+    const SpatialIndex &index = layout.index();
+    index.withinBox(originX * CELL_METRES, originY * CELL_METRES,
+                    (originX + WINDOW) * CELL_METRES, (originY + WINDOW) * CELL_METRES,
+                    SpatialIndex::typeBit(m_type), handles);
+    for (int handle : handles) {
+        int cx = static_cast<int>(std::floor(index.x(handle) / CELL_METRES)) - originX;
+        int cy = static_cast<int>(std::floor(index.y(handle) / CELL_METRES)) - originY;
+        if (cx < 0 || cy < 0 || cx >= WINDOW || cy >= WINDOW) continue;
+        splat[cy * WINDOW + cx] += static_cast<float>(layout.value(handle));
+    }
+
+    // Horizontal pass over every window row, tile columns only
+    const float *kernel = m_kernel.constData();
+    float *rows = m_rows.data();
+    for (int wy = 0; wy < WINDOW; ++wy) {
+        float *out = rows + wy * TILE;
+        const float *in = splat + wy * WINDOW;
+        std::fill(out, out + TILE, 0.0f);
+        for (int k = 0; k <= 2 * RADIUS; ++k) {
+            const float weight = kernel[k];
+            const float *source = in + k;
+            for (int i = 0; i < TILE; ++i) out[i] += weight * source[i];
+        }
+    }
+
+    // Vertical pass row by row, then through the LUT into the image
+    float sum[TILE];
+    for (int j = 0; j < TILE; ++j) {
+        std::fill(sum, sum + TILE, 0.0f);
+        for (int k = 0; k <= 2 * RADIUS; ++k) {
+            const float weight = kernel[k];
+            const float *source = rows + (j + k) * TILE;
+            for (int i = 0; i < TILE; ++i) sum[i] += weight * source[i];
+        }
+
+        const int gridY = ty * TILE + j;
+        QRgb *line = reinterpret_cast<QRgb *>(m_image.scanLine(GRID_SIZE - 1 - gridY)) + tx * TILE;
+        for (int i = 0; i < TILE; ++i) {
+            line[i] = m_lut[qBound(0, static_cast<int>(sum[i] * 255.0f), 255)];
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef HEATMAPLAYER_H
+#define HEATMAPLAYER_H
+
+#include <QImage>
+#include <QVector>
+#include <QRgb>
+
+class CityLayout;
+
+// Heat overlay for one entity type (gas risk from homes, crossing risk
+// from crosswalks, occupancy from stations, energy from poles). Entity
+// values are splatted into a density grid of CELL_METRES cells over the
+// map's world square, blurred with a separable Gaussian and mapped
+// through a colour LUT into a GRID_SIZE image the map stretches over the
+// city. The grid is cut into TILE_CELLS tiles and only tiles near a
+// change are recomputed, each from its own window widened by the blur
+// radius. The blur loops run along contiguous rows so they vectorise.
+class HeatmapLayer
+{
+public:
+    HeatmapLayer();
+
+    // -1 disables the layer
+    void setEntityType(int type);
+    int entityType() const { return m_type; }
+    bool isEnabled() const { return m_type >= 0; }
+
+    // A value or position changed at this world point
+    void markDirty(double x, double y);
+    void markAllDirty();
+    // Recomputes dirty tiles; true when the image changed
+    bool update(const CityLayout &layout);
+
+    // Row 0 is the north edge of the world square
+    const QImage &image() const { return m_image; }
+
+    static const int GRID_SIZE = 256;
+    static const int TILE_CELLS = 32;
+    static const int BLUR_RADIUS_CELLS = 12;        // 3 sigma
+    static constexpr double CELL_METRES = 16.0;     // GRID_SIZE cells span 4096 m
+    static constexpr double SIGMA_CELLS = 4.0;
+
+private:
+    void renderTile(int tx, int ty, const CityLayout &layout);
+
+    int m_type;
+    QVector<float> m_kernel;         // peak 1, so a lone entity keeps its value
+    QVector<QRgb> m_lut;
+    QVector<bool> m_dirty;           // per tile
+    bool m_anyDirty;
+    QImage m_image;
+
+    // Scratch for one tile window
+    QVector<float> m_splat;
+    QVector<float> m_rows;
+};
+
+#endif // HEATMAPLAYER_H
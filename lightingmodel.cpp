@@ -0,0 +1,141 @@
+#include "lightingmodel.h"
+#include <QRandomGenerator>
+#include <QtGlobal>
+
+LightingModel::LightingModel()
+    : m_mode("Auto Mode")
+    , m_manualIntensity(75)
+    , m_totalPoles(85)
+    , m_activePoles(82)
+    , m_sincePresence(0.0)
+    , m_presenceCycle(0)
+{
+    addPole("POLE-001", "Main Street North", 85, true, "Active");
+    addPole("POLE-002", "Main Street South", 45, false, "Active");
+    addPole("POLE-003", "Central Plaza", 90, true, "Active");
+    addPole("POLE-004", "Park Avenue", 60, false, "Active");
+    addPole("POLE-005", "University Gate", 95, true, "Active");
+    addPole("POLE-006", "Shopping District", 75, true, "Active");
+    addPole("POLE-007", "Residential Zone", 40, false, "Active");
+    addPole("POLE-008", "Industrial Area", 0, false, "Maintenance");
+    addPole("POLE-009", "Sports Complex", 80, true, "Active");
+    addPole("POLE-010", "Hospital Road", 100, true, "Active");
+}
+
+void LightingModel::addPole(const QString &id, const QString &location, int intensity,
+                            bool presence, const QString &status)
+{
+    m_poles.append({id, location, intensity, presence, status});
+    m_boosted.append(false);
+
+    // Register the pole with the energy meter (each location is a lighting zone)
+    int zone = m_energyEngine.addZone(location);
+    int pole = m_energyEngine.addPole(id, zone, EnergyAccountingEngine::DEFAULT_POLE_WATTAGE);
+    m_energyEngine.setIntensity(pole, intensity);
+    m_energyEngine.setOperational(pole, status == "Active");
+}
+
+void LightingModel::step(double dtSeconds, int hourOfDay, QRandomGenerator &rng)
+{
+    // Meter the interval that just ended with the intensities that were in effect
+    m_energyEngine.advance(dtSeconds, hourOfDay);
+
+    m_sincePresence += dtSeconds;
+    if (m_sincePresence >= PRESENCE_INTERVAL_SECONDS) {
+        m_sincePresence = 0.0;
+        samplePresence(rng);
+    }
+}
+
+void LightingModel::samplePresence(QRandomGenerator &rng)
+{
+    for (int i = 0; i < m_poles.size(); ++i) {
+        StreetlightPole &pole = m_poles[i];
+        if (pole.status != "Active") continue;
+
+        // Randomly detect presence
+        pole.presence = rng.bounded(100) < 40; // 40% chance
+
+        // Adjust intensity based on presence
+        int newIntensity;
+        if (m_boosted[i]) {
+            newIntensity = 100;
+        } else if (m_mode == "Auto Mode") {
+            newIntensity = pole.presence ? qMin(100, pole.intensity + 10) : qMax(30, pole.intensity - 5);
+        } else if (m_mode == "Eco Mode") {
+            newIntensity = pole.presence ? 70 : 25;
+        } else {
+            newIntensity = m_manualIntensity;
+        }
+        applyIntensity(i, newIntensity);
+    }
+    ++m_presenceCycle;
+}
+
+void LightingModel::applyIntensity(int pole, int intensity)
+{
+    m_poles[pole].intensity = intensity;
+    m_energyEngine.setIntensity(m_energyEngine.poleIndex(m_poles[pole].id), intensity);
+}
+
+void LightingModel::setMode(const QString &mode)
+{
+    // An operator's mode choice overrides any boosts
+    m_mode = mode;
+    m_boosted.fill(false);
+}
+
+void LightingModel::setManualIntensity(int intensity)
+{
+    m_manualIntensity = qBound(0, intensity, 100);
+    if (m_mode != "Manual Override") return;
+
+    // Manual override takes effect immediately rather than at the next sample
+    for (int i = 0; i < m_poles.size(); ++i) {
+        if (m_poles[i].status == "Active") applyIntensity(i, m_manualIntensity);
+    }
+}
+
+void LightingModel::setPoleBoosted(int pole, bool boosted)
+{
+    if (pole < 0 || pole >= m_poles.size()) return;
+    m_boosted[pole] = boosted;
+    if (boosted && m_poles[pole].status == "Active") applyIntensity(pole, 100);
+}
+
+void LightingModel::setPoleFailed(int pole)
+{
+    if (pole < 0 || pole >= m_poles.size()) return;
+    if (m_poles[pole].status != "Active") return;
+
+    m_poles[pole].intensity = 0;
+    m_poles[pole].status = "Maintenance";
+    int meterPole = m_energyEngine.poleIndex(m_poles[pole].id);
+    m_energyEngine.setIntensity(meterPole, 0);
+    m_energyEngine.setOperational(meterPole, false);
+    m_activePoles--;
+}
+
+void LightingModel::fillSnapshot(LightingSnapshot &snapshot) const
+{
+    snapshot.poles = m_poles;
+    snapshot.energySavedPercentage = m_energyEngine.savedPercentage();
+    for (int hour = 0; hour < 24; ++hour) {
+        snapshot.hourlyValid[hour] = m_energyEngine.hasHourlyData(hour);
+        snapshot.hourlySaved[hour] = m_energyEngine.hourlySavedPercentage(hour);
+    }
+
+    // Reuse the slot's zone vector; it is only resized when zones change
+    snapshot.zones.resize(m_energyEngine.zoneCount());
+    for (int zone = 0; zone < m_energyEngine.zoneCount(); ++zone) {
+        LightingZoneEnergy &entry = snapshot.zones[zone];
+        entry.name = m_energyEngine.zoneName(zone);
+        entry.consumedWh = m_energyEngine.zoneConsumedWh(zone);
+        entry.baselineWh = m_energyEngine.zoneBaselineWh(zone);
+    }
+
+    snapshot.totalPoles = m_totalPoles;
+    snapshot.activePoles = m_activePoles;
+    snapshot.mode = m_mode;
+    snapshot.presenceCycle = m_presenceCycle;
+}
@@ -0,0 +1,84 @@
+#ifndef LIGHTINGMODEL_H
+#define LIGHTINGMODEL_H
+
+#include <QString>
+#include <QVector>
+#include "energyaccountingengine.h"
+
+class QRandomGenerator;
+
+struct StreetlightPole
+{
+    QString id;
+    QString location;
+    int intensity;       // percent
+    bool presence;
+    QString status;      // "Active", "Maintenance"
+};
+
+struct LightingZoneEnergy
+{
+    QString name;
+    double consumedWh;
+    double baselineWh;
+};
+
+// Immutable frame handed to the UI
+struct LightingSnapshot
+{
+    QVector<StreetlightPole> poles;
+    QVector<LightingZoneEnergy> zones;
+    double energySavedPercentage = 0.0;
+    double hourlySaved[24] = {};
+    bool hourlyValid[24] = {};
+    int totalPoles = 0;
+    int activePoles = 0;
+    QString mode;
+    quint64 presenceCycle = 0;   // bumps whenever presence is re-sampled
+};
+
+// Headless lighting state, advanced on the simulation thread. Owns the
+// energy meter so integration runs on the same clock as the intensities.
+class LightingModel
+{
+public:
+    LightingModel();
+
+    void step(double dtSeconds, int hourOfDay, QRandomGenerator &rng);
+    void setMode(const QString &mode);
+    void setManualIntensity(int intensity);
+    void setPoleFailed(int pole);
+    // Holds the pole at full intensity until the next mode change
+    void setPoleBoosted(int pole, bool boosted);
+    void fillSnapshot(LightingSnapshot &snapshot) const;
+
+    int poleCount() const { return m_poles.size(); }
+    const QString &poleId(int pole) const { return m_poles[pole].id; }
+    const QString &poleLocation(int pole) const { return m_poles[pole].location; }
+    bool isPoleActive(int pole) const { return m_poles[pole].status == "Active"; }
+    bool isPoleBoosted(int pole) const { return m_boosted[pole]; }
+    double polePowerWatts(int pole) const { return m_energyEngine.powerWatts(pole); }
+    double consumedWh() const { return m_energyEngine.consumedWh(); }
+
+    // Presence is re-sampled on the previous 7-second refresh cadence
+    static constexpr double PRESENCE_INTERVAL_SECONDS = 7.0;
+
+private:
+    void addPole(const QString &id, const QString &location, int intensity,
+                 bool presence, const QString &status);
+    void samplePresence(QRandomGenerator &rng);
+    void applyIntensity(int pole, int intensity);
+
+    QVector<StreetlightPole> m_poles;
+    QVector<bool> m_boosted;
+    QString m_mode;
+    int m_manualIntensity;
+    int m_totalPoles;
+    int m_activePoles;
+    double m_sincePresence;
+    quint64 m_presenceCycle;
+
+    EnergyAccountingEngine m_energyEngine;
+};
+
+#endif // LIGHTINGMODEL_H
@@ -0,0 +1,169 @@
+#include "livenesstracker.h"
+
+LivenessTracker::LivenessTracker()
+    : m_slotHead(LEVELS * SLOTS, NONE)
+    , m_currentTick(-1)
+{
+}
+
+int LivenessTracker::addModule(const QString &name)
+{
+    m_moduleNames.append(name);
+    m_moduleDevices.append(0);
+    m_moduleOnline.append(0);
+    m_moduleLastSignal.append(0);
+    return m_moduleNames.size() - 1;
+}
+
+void LivenessTracker::ensureDevice(quint32 device)
+{
+    if (static_cast<int>(device) < m_module.size()) return;
+
+    int size = qMax(64, m_module.size());
+    while (size <= static_cast<int>(device)) size *= 2;
+
+    m_lastSeen.resize(size);
+    m_timeoutMs.resize(size);
+    m_online.resize(size);
+    int oldSize = m_module.size();
+    m_module.resize(size);
+    m_next.resize(size);
+    m_slot.resize(size);
+    for (int i = oldSize; i < size; ++i) {
+        m_module[i] = NONE;
+        m_next[i] = NONE;
+        m_slot[i] = NONE;
+    }
+}
+
+qint64 LivenessTracker::deadlineTick(qint32 device) const
+{
+    // Rounded up so a device is never expired early
+    return (m_lastSeen[device] + m_timeoutMs[device] + TICK_MS - 1) / TICK_MS;
+}
+
+void LivenessTracker::schedule(qint32 device, qint64 earliestTick)
+{
+    qint64 deadline = qMax(deadlineTick(device), earliestTick);
+    qint64 delta = deadline - m_currentTick;
+
+    // Pick the lowest level whose span covers the delay
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (Q_INT64_C(1) << (SLOT_BITS * (level + 1)))) ++level;
+    if (level == LEVELS - 1) {
+        qint64 span = Q_INT64_C(1) << (SLOT_BITS * LEVELS);
+        if (delta >= span) deadline = m_currentTick + span - 1;
+    }
+
+    int slot = level * SLOTS + static_cast<int>((deadline >> (SLOT_BITS * level)) & (SLOTS - 1));
+    m_next[device] = m_slotHead[slot];
+    m_slotHead[slot] = device;
+    m_slot[device] = slot;
+}
+
+qint32 LivenessTracker::detachSlot(int slot)
+{
+    qint32 head = m_slotHead[slot];
+    m_slotHead[slot] = NONE;
+    return head;
+}
+
+bool LivenessTracker::touch(quint32 device, int module, qint64 timeoutMs, qint64 nowMs)
+{
+    if (module < 0 || module >= m_moduleNames.size()) return false;
+    ensureDevice(device);
+    if (m_currentTick < 0) m_currentTick = nowMs / TICK_MS;
+
+    const qint32 d = static_cast<qint32>(device);
+    bool restored = false;
+    if (m_module[d] == NONE) {
+        m_module[d] = module;
+        m_online[d] = 1;
+        ++m_moduleDevices[module];
+        ++m_moduleOnline[module];
+    } else if (!m_online[d]) {
+        m_online[d] = 1;
+        ++m_moduleOnline[m_module[d]];
+        restored = true;
+    }
+
+    m_lastSeen[d] = qMax(m_lastSeen[d], nowMs);
+    m_timeoutMs[d] = timeoutMs;
+    qint64 &moduleSignal = m_moduleLastSignal[m_module[d]];
+    moduleSignal = qMax(moduleSignal, nowMs);
+
+    // Fresh devices already in the wheel are re-filed lazily when their slot is due
+    if (timeoutMs > 0 && m_slot[d] == NONE) schedule(d, m_currentTick + 1);
+    return restored;
+}
+
+int LivenessTracker::advance(qint64 nowMs, QVector<quint32> &expired)
+{
+    int before = expired.size();
+    qint64 target = nowMs / TICK_MS;
+    if (m_currentTick < 0) {
+        m_currentTick = target;
+        return 0;
+    }
+
+    while (m_currentTick < target) {
+        ++m_currentTick;
+
+        // Cascade the higher levels whose lower digits just wrapped, top
+        // level first so its devices can still land in the level below
+        int wrapped = 0;
+        while (wrapped < LEVELS - 1
+               && (m_currentTick & ((Q_INT64_C(1) << (SLOT_BITS * (wrapped + 1))) - 1)) == 0) {
+            ++wrapped;
+        }
+        for (int level = wrapped; level >= 1; --level) {
+            int slot = level * SLOTS + static_cast<int>((m_currentTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+            qint32 device = detachSlot(slot);
+            while (device != NONE) {
+                qint32 next = m_next[device];
+                schedule(device, m_currentTick);
+                device = next;
+            }
+        }
+
+        // Expire or re-file everything due this tick
+        qint32 device = detachSlot(static_cast<int>(m_currentTick & (SLOTS - 1)));
+        while (device != NONE) {
+            qint32 next = m_next[device];
+            m_next[device] = NONE;
+            m_slot[device] = NONE;
+
+            if (m_timeoutMs[device] <= 0) {
+                // Expiry was switched off since the device was filed
+            } else if (deadlineTick(device) > m_currentTick) {
+                schedule(device, m_currentTick + 1);
+            } else {
+                m_online[device] = 0;
+                --m_moduleOnline[m_module[device]];
+                expired.append(static_cast<quint32>(device));
+            }
+            device = next;
+        }
+    }
+    return expired.size() - before;
+}
+
+bool LivenessTracker::isTracked(quint32 device) const
+{
+    return static_cast<int>(device) < m_module.size() && m_module[device] != NONE;
+}
+
+bool LivenessTracker::isOnline(quint32 device) const
+{
+    return isTracked(device) && m_online[device];
+}
+
+int LivenessTracker::deviceModule(quint32 device) const
+{
+    return isTracked(device) ? m_module[device] : NONE;
+}
+
+qint64 LivenessTracker::lastSeen(quint32 device) const
+{
+    return isTracked(device) ? m_lastSeen[device] : 0;
+}
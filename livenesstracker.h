@@ -0,0 +1,75 @@
+#ifndef LIVENESSTRACKER_H
+#define LIVENESSTRACKER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Tracks when each device last reported and expires the ones that go
+// quiet. Deadlines live in a hierarchical timer wheel (4 levels of 64
+// slots, one tick per TICK_MS) threaded through intrusive index lists, so a
+// touch and an expiry are both O(1) and a tick only visits the one slot
+// that is due. Touches are lazy: they only record the time, and a device
+// whose slot comes due while it is still fresh is simply re-filed under
+// its real deadline. Devices are keyed by interned sensor id and belong
+// to a module whose counts and last signal are kept up to date.
+class LivenessTracker
+{
+public:
+    LivenessTracker();
+
+    int addModule(const QString &name);
+    int moduleCount() const { return m_moduleNames.size(); }
+    QString moduleName(int module) const { return m_moduleNames.value(module); }
+
+    // Records a report. timeoutMs = 0 tracks the device without expiring it.
+    // Returns true when the device had expired and is now back online.
+    bool touch(quint32 device, int module, qint64 timeoutMs, qint64 nowMs);
+
+    // Advances the wheel to nowMs; appends newly expired devices to expired
+    int advance(qint64 nowMs, QVector<quint32> &expired);
+
+    // Device queries
+    bool isTracked(quint32 device) const;
+    bool isOnline(quint32 device) const;
+    int deviceModule(quint32 device) const;
+    qint64 lastSeen(quint32 device) const;
+
+    // Module aggregates
+    int moduleDevices(int module) const { return m_moduleDevices.value(module); }
+    int moduleOnline(int module) const { return m_moduleOnline.value(module); }
+    qint64 moduleLastSignal(int module) const { return m_moduleLastSignal.value(module); }
+
+    static const int TICK_MS = 250;
+
+private:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr int LEVELS = 4;
+    static constexpr qint32 NONE = -1;
+
+    void ensureDevice(quint32 device);
+    void schedule(qint32 device, qint64 earliestTick);
+    qint32 detachSlot(int slot);
+    qint64 deadlineTick(qint32 device) const;
+
+    // Per-device state (structure of arrays, indexed by sensor id)
+    QVector<qint64> m_lastSeen;      // 0 = never reported
+    QVector<qint64> m_timeoutMs;
+    QVector<qint32> m_module;        // NONE = untracked
+    QVector<quint8> m_online;
+    QVector<qint32> m_next;          // intrusive slot list
+    QVector<qint32> m_slot;          // NONE = not in the wheel
+
+    // LEVELS x SLOTS list heads
+    QVector<qint32> m_slotHead;
+    qint64 m_currentTick;            // -1 until the first call
+
+    // Per-module aggregates
+    QStringList m_moduleNames;
+    QVector<int> m_moduleDevices;
+    QVector<int> m_moduleOnline;
+    QVector<qint64> m_moduleLastSignal;
+};
+
+#endif // LIVENESSTRACKER_H
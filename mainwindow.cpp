@@ -2,6 +2,16 @@
 #include "ui_mainwindow.h"
 #include <QGridLayout>
 #include <QScrollArea>
+#include <QRandomGenerator>
+#include <QComboBox>
+#include "citylayout.h"
+#include "uiupdatescheduler.h"
+#include "tickdriver.h"
+#include "cityeventbus.h"
+#include "tracer.h"
+#include "metricsregistry.h"
+#include <QShortcut>
+#include <QDebug>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -9,6 +19,29 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
     
+    // NEOCITY_TRACE=<file> traces from startup and writes the file on exit
+    tracePath = qEnvironmentVariable("NEOCITY_TRACE");
+    if (!tracePath.isEmpty()) Tracer::setEnabled(true);
+    
+    // Start advancing the city before any page asks for a frame
+    simulation = new SimulationThread(this);
+    simulation->setObjectName("Simulation");
+    simulation->start();
+    // Live device state and field units feed the stability model
+    conditions = new CityConditions(simulation, this);
+    // Approved recommendations become commands for the simulated city
+    actions = new ActionExecutor(simulation, conditions, this);
+    
+    forecasting = new ForecastThread(this);
+    forecasting->setObjectName("Forecasting");
+    forecasting->start();
+    TickDriver::instance()->add("Risk sample", ForecastThread::SAMPLE_INTERVAL_MS, this, [this]() { sampleCityRisk(); });
+    // Keeps the bus's lanes moving whether or not a consumer page exists yet
+    TickDriver::instance()->add("Event bus", CityEventBus::PUMP_MS, this, []() { CityEventBus::instance()->pump(); });
+    
+    // Scrape endpoint for headless deployments; NEOCITY_METRICS_PORT turns it on
+    metricsServer = MetricsServer::fromEnvironment(this);
+    
     // Set window properties
     setWindowTitle("NeoCity - Smart City Control Center");
     setMinimumSize(1400, 900);
@@ -17,11 +50,15 @@ MainWindow::MainWindow(QWidget *parent)
     setupUI();
     applyStyles();
     
-    // Initialize timer for date/time updates
-    updateTimer = new QTimer(this);
-    connect(updateTimer, &QTimer::timeout, this, &MainWindow::updateDateTime);
-    updateTimer->start(1000); // Update every second
+    // Date/time, recommendations and load readouts every second
+    TickDriver::instance()->add("Top bar", 1000, this, [this]() {
+        MetricsRegistry::instance()->sample();
+        updateDateTime();
+        refreshRecommendations();
+        updateUiLoad();
+    });
     updateDateTime(); // Initial update
+    sampleCityRisk();
     
     // Initialize system status
     updateSystemStatus();
@@ -29,6 +66,13 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    simulation->requestInterruption();
+    simulation->wait();
+    forecasting->requestInterruption();
+    forecasting->wait();
+    if (!tracePath.isEmpty() && !Tracer::writeChromeTrace(tracePath)) {
+        qWarning() << "[TRACE] cannot write" << tracePath;
+    }
     delete ui;
 }
 
@@ -129,6 +173,13 @@ void MainWindow::setupUI()
     mainLayout->addWidget(contentArea, 1);
     mainVerticalLayout->addLayout(mainLayout, 1);
     
+    // Metrics overlay above whichever page is showing
+    performanceHud = new PerformanceHud(contentArea);
+    QShortcut *hudShortcut = new QShortcut(QKeySequence(Qt::Key_F12), this);
+    connect(hudShortcut, &QShortcut::activated, this, [this]() {
+        performanceHud->setVisible(!performanceHud->isVisible());
+    });
+    
     // Set dashboard as initial page
     stackedWidget->setCurrentIndex(0);
 }
@@ -169,10 +220,19 @@ void MainWindow::createTopBar()
     dateTimeLabel->setAlignment(Qt::AlignRight);
     rightLayout->addWidget(dateTimeLabel);
     
+    // UI scheduler load next to the status
+    QHBoxLayout *statusLayout = new QHBoxLayout();
+    statusLayout->setSpacing(15);
+    statusLayout->addStretch();
+    uiLoadLabel = new QLabel();
+    uiLoadLabel->setObjectName("uiLoad");
+    statusLayout->addWidget(uiLoadLabel);
+    
     statusIndicator = new QLabel("🟢 ONLINE");
     statusIndicator->setObjectName("statusIndicator");
     statusIndicator->setAlignment(Qt::AlignRight);
-    rightLayout->addWidget(statusIndicator);
+    statusLayout->addWidget(statusIndicator);
+    rightLayout->addLayout(statusLayout);
     
     topBarLayout->addLayout(rightLayout);
 }
@@ -379,59 +439,44 @@ void MainWindow::createCityMap()
     QVBoxLayout *frameLayout = new QVBoxLayout(mapFrame);
     frameLayout->setContentsMargins(30, 30, 30, 30);
     
-    // Map title
+    // Map title and overlay picker
+    QHBoxLayout *mapHeader = new QHBoxLayout();
     QLabel *mapTitle = new QLabel("City Zone Overview");
     mapTitle->setObjectName("mapTitle");
-    frameLayout->addWidget(mapTitle);
-    
-    // Zone grid (3x3)
-    QGridLayout *zoneGrid = new QGridLayout();
-    zoneGrid->setSpacing(15);
-    
-    QString zones[3][3] = {
-        {"North District", "Central Plaza", "East District"},
-        {"West Industrial", "City Center", "Market Area"},
-        {"South Residential", "Park Zone", "Tech Campus"}
-    };
-    
-    QString zoneStatus[3][3] = {
-        {"normal", "normal", "warning"},
-        {"normal", "normal", "normal"},
-        {"normal", "alert", "normal"}
-    };
-    
-    for (int row = 0; row < 3; ++row) {
-        for (int col = 0; col < 3; ++col) {
-            QFrame *zoneCard = new QFrame();
-            zoneCard->setObjectName("zoneCard_" + zoneStatus[row][col]);
-            zoneCard->setMinimumHeight(80);
-            
-            QVBoxLayout *zoneLayout = new QVBoxLayout(zoneCard);
-            zoneLayout->setContentsMargins(15, 15, 15, 15);
-            
-            QLabel *zoneLabel = new QLabel(zones[row][col]);
-            zoneLabel->setObjectName("zoneLabel");
-            zoneLabel->setAlignment(Qt::AlignCenter);
-            zoneLabel->setWordWrap(true);
-            zoneLayout->addWidget(zoneLabel);
-            
-            // Status indicator
-            QString indicator;
-            if (zoneStatus[row][col] == "normal") indicator = "🟢";
-            else if (zoneStatus[row][col] == "warning") indicator = "🟠";
-            else indicator = "🔴";
-            
-            QLabel *statusLabel = new QLabel(indicator);
-            statusLabel->setAlignment(Qt::AlignCenter);
-            statusLabel->setObjectName("zoneStatus");
-            zoneLayout->addWidget(statusLabel);
-            
-            zoneGrid->addWidget(zoneCard, row, col);
+    mapHeader->addWidget(mapTitle);
+    mapHeader->addStretch();
+    
+    QComboBox *overlayCombo = new QComboBox();
+    overlayCombo->setObjectName("mapOverlayCombo");
+    overlayCombo->addItem("No Heatmap", -1);
+    overlayCombo->addItem("Gas Risk (Homes)", CityLayout::Home);
+    overlayCombo->addItem("Pedestrian Risk (Crosswalks)", CityLayout::Crosswalk);
+    overlayCombo->addItem("Occupancy (Stations)", CityLayout::Station);
+    overlayCombo->addItem("Energy (Streetlights)", CityLayout::Pole);
+    mapHeader->addWidget(overlayCombo);
+    frameLayout->addLayout(mapHeader);
+    
+    // Live map of everything placed in the city layout
+    cityMap = new CityMapWidget();
+    cityMap->setZoneStatus("East District", CityMapWidget::Warning);
+    cityMap->setZoneStatus("Park Zone", CityMapWidget::Alert);
+    
+    // NEOCITY_MAP_MARKERS adds that many synthetic homes to load the map
+    bool markersSet = false;
+    int markers = qEnvironmentVariableIntValue("NEOCITY_MAP_MARKERS", &markersSet);
+    if (markersSet && markers > 0) {
+        QRandomGenerator generator(markers);
+        for (int i = 0; i < markers; ++i) {
+            CityLayout::instance()->place(CityLayout::Home, QString("LOAD-%1").arg(i),
+                                          generator.bounded(CityLayout::CITY_WIDTH_METRES),
+                                          generator.bounded(CityLayout::CITY_HEIGHT_METRES));
         }
     }
     
-    frameLayout->addLayout(zoneGrid);
-    frameLayout->addStretch();
+    frameLayout->addWidget(cityMap, 1);
+    connect(overlayCombo, &QComboBox::currentIndexChanged, this, [this, overlayCombo](int) {
+        cityMap->setHeatmap(overlayCombo->currentData().toInt());
+    });
     
     mapLayout->addWidget(mapFrame);
 }
@@ -481,6 +526,12 @@ void MainWindow::applyStyles()
             letter-spacing: 0.5px;
         }
         
+        #uiLoad {
+            font-size: 12px;
+            color: #888888;
+            font-family: 'Segoe UI', 'Roboto', sans-serif;
+        }
+        
         /* Navigation Menu */
         #navigationMenu {
             background-color: #1A1A1A;
@@ -601,6 +652,15 @@ void MainWindow::applyStyles()
             border: 1px solid #2A2A2A;
         }
         
+        #mapOverlayCombo {
+            background-color: #252525;
+            color: #E0E0E0;
+            border: 1px solid #2A2A2A;
+            border-radius: 6px;
+            padding: 6px 12px;
+            min-width: 220px;
+        }
+        
         #mapTitle {
             font-size: 20px;
             font-weight: bold;
@@ -609,35 +669,6 @@ void MainWindow::applyStyles()
             font-family: 'Segoe UI', 'Roboto', sans-serif;
         }
         
-        QFrame[objectName^="zoneCard_"] {
-            background-color: #252525;
-            border-radius: 8px;
-            border: 2px solid #2A2A2A;
-        }
-        
-        #zoneCard_normal {
-            border-left: 4px solid #00C853;
-        }
-        
-        #zoneCard_warning {
-            border-left: 4px solid #FF9800;
-        }
-        
-        #zoneCard_alert {
-            border-left: 4px solid #D32F2F;
-        }
-        
-        #zoneLabel {
-            font-size: 13px;
-            color: #E0E0E0;
-            font-weight: 600;
-            font-family: 'Segoe UI', 'Roboto', sans-serif;
-        }
-        
-        #zoneStatus {
-            font-size: 24px;
-        }
-        
         /* Placeholder pages */
         #placeholderText {
             font-size: 16px;
@@ -657,6 +688,54 @@ void MainWindow::updateDateTime()
     dateTimeLabel->setText(dateTimeStr);
 }
 
+void MainWindow::updateUiLoad()
+{
+    // Page widget work queued on the UI scheduler: cost of the last frame,
+    // updates pushed to a later frame by the budget, and updates waiting
+    // for their page to be shown
+    const UiUpdateScheduler::Stats &stats = UiUpdateScheduler::instance()->stats();
+    // and how often the tick driver woke the app, how late, and whether
+    // the ticks it ran spilled into the next base tick
+    const TickDriver *ticks = TickDriver::instance();
+    const TickDriverStats &driver = ticks->stats();
+    uiLoadLabel->setText(QString("UI %1 ms/frame  •  %2 deferred  •  %3 on hidden pages  •  %4 wakeups/s, %5 ms jitter, %6 overruns")
+                         .arg(stats.lastFrameMs, 0, 'f', 1)
+                         .arg(stats.deferred)
+                         .arg(stats.hidden)
+                         .arg(driver.wakeupsPerSecond, 0, 'f', 1)
+                         .arg(driver.meanJitterMs, 0, 'f', 1)
+                         .arg(driver.overruns));
+    
+    // Per-tick breakdown on hover
+    QStringList lines;
+    for (int tick = 0; tick < ticks->tickCount(); ++tick) {
+        if (!ticks->isActive(tick)) continue;
+        const TickStats &tickStats = ticks->tickStats(tick);
+        lines << QString("%1: %2  •  %3 runs  •  last %4 ms, max %5 ms  •  %6 missed")
+                 .arg(tickStats.name)
+                 .arg(tickStats.intervalMs > 0 ? QString("every %1 ms").arg(tickStats.intervalMs) : QString("paused"))
+                 .arg(tickStats.runs)
+                 .arg(tickStats.lastMs, 0, 'f', 2)
+                 .arg(tickStats.maxMs, 0, 'f', 2)
+                 .arg(tickStats.missed);
+    }
+    lines << QString("Max jitter %1 ms over %2 wakeups").arg(driver.maxJitterMs, 0, 'f', 1).arg(driver.wakeups);
+    uiLoadLabel->setToolTip(lines.join("\n"));
+}
+
+void MainWindow::sampleCityRisk()
+{
+    forecasting->observeStability(CityStabilityModel::instance(), QDateTime::currentMSecsSinceEpoch());
+}
+
+void MainWindow::refreshRecommendations()
+{
+    // The only consumer of forecast frames; pages read the current one
+    SnapshotBuffer<RiskForecastSnapshot> &frames = forecasting->frames();
+    if (frames.update()) RecommendationEngine::instance()->setForecasts(frames.current());
+    RecommendationEngine::instance()->update(QDateTime::currentMSecsSinceEpoch());
+}
+
 void MainWindow::navigateToPage(int index)
 {
     // Lazy-create the page if it hasn't been created yet
@@ -681,11 +760,13 @@ void MainWindow::lazyCreatePage(int index)
     
     if (!isPlaceholder) return;  // Already created
     
+    // Only page construction is traced, not every navigation
+    TRACE_SCOPE("MainWindow::lazyCreatePage");
     QWidget *newPage = nullptr;
     
     switch(index) {
         case 1:  // Smart Recycling
-            newPage = new SmartRecyclingModule(this);
+            newPage = new SmartRecyclingModule(simulation, this);
             recyclingPage = newPage;
             break;
         case 2:  // Pedestrian Safety
@@ -693,15 +774,15 @@ void MainWindow::lazyCreatePage(int index)
             safetyPage = newPage;
             break;
         case 3:  // Smart Lighting
-            newPage = new SmartLightingModule(this);
+            newPage = new SmartLightingModule(simulation, this);
             lightingPage = newPage;
             break;
         case 4:  // Security Intelligence
-            newPage = new SecurityIntelligenceCenter(this);
+            newPage = new SecurityIntelligenceCenter(simulation, actions, this);
             securityPage = newPage;
             break;
         case 5:  // City Intelligence
-            newPage = new CityIntelligenceModule(this);
+            newPage = new CityIntelligenceModule(simulation, forecasting, actions, this);
             break;
         case 6:  // Analytics
             newPage = new AnalyticsModule(this);
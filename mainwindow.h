@@ -9,7 +9,6 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QFrame>
-#include <QTimer>
 #include <QDateTime>
 #include <QStyle>
 #include "securityintelligencecenter.h"
@@ -20,6 +19,13 @@
 #include "cityintelligencemodule.h"
 #include "smartstationpage.h"
 #include "smarthomesecuritypage.h"
+#include "simulationthread.h"
+#include "cityconditions.h"
+#include "forecastthread.h"
+#include "actionexecutor.h"
+#include "citymapwidget.h"
+#include "performancehud.h"
+#include "metricsserver.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -37,6 +43,9 @@ public:
 
 private slots:
     void updateDateTime();
+    void updateUiLoad();
+    void sampleCityRisk();
+    void refreshRecommendations();
     void navigateToPage(int index);
     void updateSystemStatus();
     void lazyCreatePage(int index);  // Lazy loading helper
@@ -54,6 +63,7 @@ private:
     QLabel *subtitleLabel;
     QLabel *dateTimeLabel;
     QLabel *statusIndicator;
+    QLabel *uiLoadLabel;
     
     // Navigation menu components
     QWidget *navigationMenu;
@@ -81,9 +91,20 @@ private:
     QWidget *kpiCardsContainer;
     QWidget *statusCardsContainer;
     QWidget *cityMapContainer;
+    CityMapWidget *cityMap;
     
-    // Timer for updates
-    QTimer *updateTimer;
+    // Metrics overlay, toggled with F12, and the optional scrape endpoint
+    PerformanceHud *performanceHud;
+    MetricsServer *metricsServer;       // nullptr unless enabled
+    QString tracePath;                  // NEOCITY_TRACE; empty = no trace on exit
+    
+    // Headless city models shared by the recycling and lighting pages
+    SimulationThread *simulation;
+    CityConditions *conditions;
+    ActionExecutor *actions;
+    
+    // Risk forecasts, fed from the stability model every SAMPLE_INTERVAL_MS
+    ForecastThread *forecasting;
     
     // Helper methods
     void setupUI();
@@ -0,0 +1,317 @@
+#include "metricsregistry.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Bumped by the global operator new below; per thread, so counting never
+// contends. Qt containers allocate with malloc inside QtCore, which this
+// cannot see, so it counts the executable's own new expressions only.
+thread_local quint64 t_newCalls = 0;
+
+void *alignedMalloc(std::size_t size, std::size_t alignment)
+{
+#ifdef Q_OS_WIN
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+}
+
+void alignedFree(void *p)
+{
+#ifdef Q_OS_WIN
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+// Like the standard allocation functions, retries through the installed
+// new_handler until the allocation succeeds or there is no handler left
+void *countedNew(std::size_t size, std::size_t alignment = 0)
+{
+    ++t_newCalls;
+    if (size == 0) size = 1;
+    for (;;) {
+        void *p = alignment ? alignedMalloc(size, alignment) : std::malloc(size);
+        if (p) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void *countedNewNothrow(std::size_t size, std::size_t alignment = 0) noexcept
+{
+    try {
+        return countedNew(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+std::size_t alignmentOf(std::align_val_t alignment)
+{
+    return qMax(static_cast<std::size_t>(alignment), sizeof(void *));
+}
+}
+
+void *operator new(std::size_t size) { return countedNew(size); }
+void *operator new[](std::size_t size) { return countedNew(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return countedNewNothrow(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return countedNewNothrow(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+
+// Over-aligned types, such as the cache-line aligned SpscQueue
+void *operator new(std::size_t size, std::align_val_t alignment) { return countedNew(size, alignmentOf(alignment)); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return countedNew(size, alignmentOf(alignment)); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedNewNothrow(size, alignmentOf(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedNewNothrow(size, alignmentOf(alignment));
+}
+void operator delete(void *p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { alignedFree(p); }
+
+int LatencyHistogram::bucketFor(quint64 us)
+{
+    if (us < quint64(SUB_BUCKETS)) return static_cast<int>(us);
+    us = qMin(us, MAX_US);
+    int topBit = 63;
+    while (!(us >> topBit)) --topBit;
+    const int shift = topBit - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>(us >> shift) - SUB_BUCKETS;
+}
+
+quint64 LatencyHistogram::bucketUpperUs(int bucket)
+{
+    if (bucket < SUB_BUCKETS) return bucket;
+    const int shift = bucket / SUB_BUCKETS - 1;
+    const quint64 lower = quint64(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return lower + (quint64(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(quint64 us)
+{
+    m_buckets[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    m_sumUs.fetch_add(us, std::memory_order_relaxed);
+    quint64 max = m_maxUs.load(std::memory_order_relaxed);
+    while (us > max && !m_maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const
+{
+    quint64 counts[BUCKET_COUNT];
+    HistogramSnapshot snapshot;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += counts[i];
+    }
+    snapshot.sumUs = m_sumUs.load(std::memory_order_relaxed);
+    snapshot.maxUs = m_maxUs.load(std::memory_order_relaxed);
+    if (snapshot.count == 0) return snapshot;
+
+    // Ranks come from the copied buckets, so they stay consistent with
+    // them even while other threads record
+    const quint64 ranks[3] = {(snapshot.count * 50 + 99) / 100,
+                              (snapshot.count * 90 + 99) / 100,
+                              (snapshot.count * 99 + 99) / 100};
+    quint64 *targets[3] = {&snapshot.p50Us, &snapshot.p90Us, &snapshot.p99Us};
+    quint64 seen = 0;
+    int next = 0;
+    for (int i = 0; i < BUCKET_COUNT && next < 3; ++i) {
+        seen += counts[i];
+        while (next < 3 && seen >= ranks[next]) {
+            *targets[next] = qMin(bucketUpperUs(i), snapshot.maxUs);
+            ++next;
+        }
+    }
+    return snapshot;
+}
+
+MetricsRegistry::MetricsRegistry()
+{
+    m_sampleClock.start();
+    m_guiNewCalls = counter("operator_new_total", "GUI thread");
+    m_lastGuiNewCalls = threadNewCalls();
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    for (const Entry &entry : m_entries) {
+        delete entry.metric.counter;
+        delete entry.metric.gauge;
+        delete entry.metric.histogram;
+    }
+}
+
+MetricsRegistry *MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return &registry;
+}
+
+quint64 MetricsRegistry::threadNewCalls()
+{
+    return t_newCalls;
+}
+
+MetricsRegistry::Entry &MetricsRegistry::entry(const QString &name, const QString &module, Type type)
+{
+    const QPair<QString, QString> key(name, module);
+    int index = m_index.value(key, -1);
+    if (index < 0) {
+        Entry created;
+        created.metric = {name, module, type, nullptr, nullptr, nullptr, 0.0};
+        created.lastValue = 0;
+        switch (type) {
+            case Counter: created.metric.counter = new MetricCounter(); break;
+            case Gauge: created.metric.gauge = new MetricGauge(); break;
+            case Histogram: created.metric.histogram = new LatencyHistogram(); break;
+        }
+        index = m_entries.size();
+        m_entries.append(created);
+        m_index.insert(key, index);
+    }
+    return m_entries[index];
+}
+
+MetricCounter *MetricsRegistry::counter(const QString &name, const QString &module)
+{
+    QMutexLocker locker(&m_mutex);
+    return entry(name, module, Counter).metric.counter;
+}
+
+MetricGauge *MetricsRegistry::gauge(const QString &name, const QString &module)
+{
+    QMutexLocker locker(&m_mutex);
+    return entry(name, module, Gauge).metric.gauge;
+}
+
+LatencyHistogram *MetricsRegistry::histogram(const QString &name, const QString &module)
+{
+    QMutexLocker locker(&m_mutex);
+    return entry(name, module, Histogram).metric.histogram;
+}
+
+void MetricsRegistry::sample()
+{
+    // The GUI thread's count is only visible from the GUI thread
+    const quint64 newCalls = threadNewCalls();
+    m_guiNewCalls->add(newCalls - m_lastGuiNewCalls);
+    m_lastGuiNewCalls = newCalls;
+
+    QMutexLocker locker(&m_mutex);
+    const qint64 elapsedMs = m_sampleClock.restart();
+    if (elapsedMs <= 0) return;
+    for (Entry &entry : m_entries) {
+        if (entry.metric.type != Counter) continue;
+        const quint64 value = entry.metric.counter->value();
+        entry.metric.ratePerSecond = (value - entry.lastValue) * 1000.0 / elapsedMs;
+        entry.lastValue = value;
+    }
+}
+
+int MetricsRegistry::metricCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+QVector<MetricsRegistry::Metric> MetricsRegistry::metrics() const
+{
+    QVector<Metric> metrics;
+    {
+        QMutexLocker locker(&m_mutex);
+        metrics.reserve(m_entries.size());
+        for (const Entry &entry : m_entries) metrics.append(entry.metric);
+    }
+    std::sort(metrics.begin(), metrics.end(), [](const Metric &a, const Metric &b) {
+        if (a.module != b.module) return a.module < b.module;
+        return a.name < b.name;
+    });
+    return metrics;
+}
+
+QString MetricsRegistry::toText() const
+{
+    QStringList lines;
+    QString module;
+    for (const Metric &metric : metrics()) {
+        if (lines.isEmpty() || metric.module != module) {
+            module = metric.module;
+            lines << QString("[%1]").arg(module);
+        }
+        QString value;
+        switch (metric.type) {
+            case Counter:
+                value = QString("%1  (%2/s)").arg(metric.counter->value()).arg(metric.ratePerSecond, 0, 'f', 1);
+                break;
+            case Gauge:
+                value = QString::number(metric.gauge->value());
+                break;
+            case Histogram: {
+                HistogramSnapshot snapshot = metric.histogram->snapshot();
+                value = QString("n=%1  p50 %2  p90 %3  p99 %4  max %5 us")
+                        .arg(snapshot.count).arg(snapshot.p50Us).arg(snapshot.p90Us)
+                        .arg(snapshot.p99Us).arg(snapshot.maxUs);
+                break;
+            }
+        }
+        lines << QString("  %1 %2").arg(metric.name, -22).arg(value);
+    }
+    return lines.join("\n");
+}
+
+QByteArray MetricsRegistry::toJson() const
+{
+    QJsonArray array;
+    for (const Metric &metric : metrics()) {
+        QJsonObject object;
+        object["name"] = metric.name;
+        object["module"] = metric.module;
+        switch (metric.type) {
+            case Counter:
+                object["type"] = "counter";
+                object["value"] = static_cast<double>(metric.counter->value());
+                object["rate"] = metric.ratePerSecond;
+                break;
+            case Gauge:
+                object["type"] = "gauge";
+                object["value"] = static_cast<double>(metric.gauge->value());
+                break;
+            case Histogram: {
+                HistogramSnapshot snapshot = metric.histogram->snapshot();
+                object["type"] = "histogram";
+                object["count"] = static_cast<double>(snapshot.count);
+                object["sum_us"] = static_cast<double>(snapshot.sumUs);
+                object["p50_us"] = static_cast<double>(snapshot.p50Us);
+                object["p90_us"] = static_cast<double>(snapshot.p90Us);
+                object["p99_us"] = static_cast<double>(snapshot.p99Us);
+                object["max_us"] = static_cast<double>(snapshot.maxUs);
+                break;
+            }
+        }
+        array.append(object);
+    }
+    return QJsonDocument(array).toJson(QJsonDocument::Indented);
+}
@@ -0,0 +1,158 @@
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QMutex>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <atomic>
+
+// Monotonic count; any thread, no locks
+class MetricCounter
+{
+public:
+    void add(quint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<quint64> m_value{0};
+};
+
+// Last reported level, such as a queue depth; any thread, no locks
+class MetricGauge
+{
+public:
+    void set(qint64 value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(qint64 delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<qint64> m_value{0};
+};
+
+struct HistogramSnapshot
+{
+    quint64 count = 0;
+    quint64 sumUs = 0;
+    quint64 maxUs = 0;
+    quint64 p50Us = 0;
+    quint64 p90Us = 0;
+    quint64 p99Us = 0;
+};
+
+// Latency in microseconds over HDR-style log-linear buckets: each power
+// of two is split into SUB_BUCKETS linear steps, so a percentile is known
+// to within 1/SUB_BUCKETS of its value from 1 us up to MAX_US. Recording
+// is a few relaxed atomic adds; any thread, no locks.
+class LatencyHistogram
+{
+public:
+    void record(quint64 us);
+    HistogramSnapshot snapshot() const;
+
+    // Inclusive upper bound of the values counted in a bucket
+    static quint64 bucketUpperUs(int bucket);
+
+    static const int SUB_BUCKET_BITS = 3;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_BIT = 31;                        // ~71 min
+    static const int BUCKET_COUNT = (MAX_BIT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+    static constexpr quint64 MAX_US = (quint64(1) << (MAX_BIT + 1)) - 1;
+
+private:
+    static int bucketFor(quint64 us);
+
+    std::atomic<quint64> m_buckets[BUCKET_COUNT] = {};
+    std::atomic<quint64> m_sumUs{0};
+    std::atomic<quint64> m_maxUs{0};
+};
+
+// Times its scope into a histogram
+class ScopedLatency
+{
+public:
+    explicit ScopedLatency(LatencyHistogram *histogram) : m_histogram(histogram) { m_clock.start(); }
+    ~ScopedLatency() { m_histogram->record(m_clock.nsecsElapsed() / 1000); }
+
+private:
+    LatencyHistogram *m_histogram;
+    QElapsedTimer m_clock;
+};
+
+// Process-wide set of named metrics, each tagged with the module it
+// measures. Callers look a metric up once and keep the pointer; updating
+// it never touches the registry. Only registration and dumps take the
+// lock. Counter rates are worked out by sample(), which the main window
+// calls once a second on the GUI thread.
+class MetricsRegistry
+{
+public:
+    enum Type {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    struct Metric
+    {
+        QString name;
+        QString module;
+        Type type;
+        MetricCounter *counter;
+        MetricGauge *gauge;
+        LatencyHistogram *histogram;
+        double ratePerSecond;            // counters only, as of the last sample()
+    };
+
+    static MetricsRegistry *instance();
+
+    // The same name and module always give back the same metric
+    MetricCounter *counter(const QString &name, const QString &module);
+    MetricGauge *gauge(const QString &name, const QString &module);
+    LatencyHistogram *histogram(const QString &name, const QString &module);
+
+    void sample();
+    int metricCount() const;
+    QVector<Metric> metrics() const;     // sorted by module, then name
+
+    QString toText() const;
+    QByteArray toJson() const;
+
+    // operator new calls made so far by the calling thread. Only the
+    // executable's own new expressions are seen; allocations Qt makes
+    // inside its libraries (QString, QList, QByteArray growth) are not.
+    static quint64 threadNewCalls();
+
+private:
+    struct Entry
+    {
+        Metric metric;
+        quint64 lastValue;
+    };
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+    Entry &entry(const QString &name, const QString &module, Type type);
+
+    mutable QMutex m_mutex;
+    QVector<Entry> m_entries;
+    QHash<QPair<QString, QString>, int> m_index;
+    QElapsedTimer m_sampleClock;
+    MetricCounter *m_guiNewCalls;
+    quint64 m_lastGuiNewCalls;
+};
+
+// Times the enclosing scope into the named histogram; the lookup happens
+// once per call site
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+#define SCOPED_LATENCY(name, module) \
+    ScopedLatency METRICS_CONCAT(scopedLatency, __LINE__)([]() { \
+        static LatencyHistogram *histogram = MetricsRegistry::instance()->histogram(name, module); \
+        return histogram; \
+    }())
+
+#endif // METRICSREGISTRY_H
@@ -0,0 +1,198 @@
+#include "metricsserver.h"
+#include "tickdriver.h"
+#include <QHostAddress>
+#include <QDebug>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+const int MAX_REQUEST_LINE = 1024;
+const double QUANTILES[MetricsServer::QUANTILE_COUNT] = {0.5, 0.9, 0.99};
+
+QByteArray escapeLabel(const QString &value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return escaped;
+}
+}
+
+MetricsServer::MetricsServer(quint16 port, QObject *parent)
+    : QObject(parent)
+    , m_layoutSize(-1)
+{
+    m_notFound = "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\n"
+                 "Connection: close\r\n\r\nnot found\n";
+
+    m_server = new QTcpServer(this);
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsServer::onNewConnection);
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "[METRICS] cannot listen on port" << port << ":" << m_server->errorString();
+        return;
+    }
+
+    render();
+    TickDriver::instance()->add("Metrics endpoint", RENDER_MS, this, [this]() { render(); });
+}
+
+MetricsServer *MetricsServer::fromEnvironment(QObject *parent)
+{
+    bool portSet = false;
+    int port = qEnvironmentVariableIntValue("NEOCITY_METRICS_PORT", &portSet);
+    if (!portSet || port <= 0 || port > 65535) return nullptr;
+    return new MetricsServer(static_cast<quint16>(port), parent);
+}
+
+void MetricsServer::rebuildLayout()
+{
+    QVector<MetricsRegistry::Metric> metrics = MetricsRegistry::instance()->metrics();
+    m_layoutSize = metrics.size();
+
+    m_series.clear();
+    for (const MetricsRegistry::Metric &metric : metrics) {
+        Series series;
+        series.metric = metric;
+        QString family = "neocity_" + metric.name;
+        if (metric.type == MetricsRegistry::Counter && family.endsWith("_total")) family.chop(6);
+        if (metric.type == MetricsRegistry::Histogram && family.endsWith("_us")) {
+            family.chop(3);
+            family += "_seconds";
+        }
+        series.family = family.toUtf8();
+        m_series.append(series);
+    }
+    // Samples of one family have to be contiguous
+    std::sort(m_series.begin(), m_series.end(), [](const Series &a, const Series &b) {
+        if (a.family != b.family) return a.family < b.family;
+        return a.metric.module < b.metric.module;
+    });
+
+    for (int i = 0; i < m_series.size(); ++i) {
+        Series &series = m_series[i];
+        const QByteArray &family = series.family;
+        const QByteArray module = "module=\"" + escapeLabel(series.metric.module) + "\"";
+        const bool first = i == 0 || m_series[i - 1].family != family;
+
+        switch (series.metric.type) {
+            case MetricsRegistry::Counter:
+                if (first) series.header = "# TYPE " + family + " counter\n";
+                series.value = family + "_total{" + module + "} ";
+                break;
+            case MetricsRegistry::Gauge:
+                if (first) series.header = "# TYPE " + family + " gauge\n";
+                series.value = family + "{" + module + "} ";
+                break;
+            case MetricsRegistry::Histogram:
+                if (first) {
+                    series.header = "# TYPE " + family + " summary\n";
+                    if (family.endsWith("_seconds")) series.header += "# UNIT " + family + " seconds\n";
+                }
+                for (int q = 0; q < QUANTILE_COUNT; ++q) {
+                    series.quantiles[q] = family + "{" + module + ",quantile=\""
+                                          + QByteArray::number(QUANTILES[q]) + "\"} ";
+                }
+                series.sum = family + "_sum{" + module + "} ";
+                series.count = family + "_count{" + module + "} ";
+                break;
+        }
+    }
+}
+
+void MetricsServer::render()
+{
+    if (MetricsRegistry::instance()->metricCount() != m_layoutSize) rebuildLayout();
+
+    // Both buffers keep their capacity across renders
+    m_body.truncate(0);
+    for (const Series &series : m_series) {
+        m_body += series.header;
+        switch (series.metric.type) {
+            case MetricsRegistry::Counter:
+                m_body += series.value;
+                appendUnsigned(m_body, series.metric.counter->value());
+                m_body += '\n';
+                break;
+            case MetricsRegistry::Gauge:
+                m_body += series.value;
+                appendSigned(m_body, series.metric.gauge->value());
+                m_body += '\n';
+                break;
+            case MetricsRegistry::Histogram: {
+                HistogramSnapshot snapshot = series.metric.histogram->snapshot();
+                const quint64 quantiles[QUANTILE_COUNT] = {snapshot.p50Us, snapshot.p90Us, snapshot.p99Us};
+                for (int q = 0; q < QUANTILE_COUNT; ++q) {
+                    m_body += series.quantiles[q];
+                    appendSeconds(m_body, quantiles[q]);
+                    m_body += '\n';
+                }
+                m_body += series.sum;
+                appendSeconds(m_body, snapshot.sumUs);
+                m_body += '\n';
+                m_body += series.count;
+                appendUnsigned(m_body, snapshot.count);
+                m_body += '\n';
+                break;
+            }
+        }
+    }
+    m_body += "# EOF\n";
+
+    m_response.truncate(0);
+    m_response += "HTTP/1.1 200 OK\r\n"
+                  "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                  "Content-Length: ";
+    appendUnsigned(m_response, m_body.size());
+    m_response += "\r\nConnection: close\r\n\r\n";
+    m_response += m_body;
+}
+
+void MetricsServer::appendUnsigned(QByteArray &out, quint64 value)
+{
+    char digits[24];
+    int length = std::snprintf(digits, sizeof(digits), "%llu", static_cast<unsigned long long>(value));
+    out.append(digits, length);
+}
+
+void MetricsServer::appendSigned(QByteArray &out, qint64 value)
+{
+    char digits[24];
+    int length = std::snprintf(digits, sizeof(digits), "%lld", static_cast<long long>(value));
+    out.append(digits, length);
+}
+
+void MetricsServer::appendSeconds(QByteArray &out, quint64 us)
+{
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%llu.%06llu",
+                                static_cast<unsigned long long>(us / 1000000),
+                                static_cast<unsigned long long>(us % 1000000));
+    out.append(digits, length);
+}
+
+void MetricsServer::onNewConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QTcpSocket *socket = m_server->nextPendingConnection();
+        connect(socket, &QTcpSocket::readyRead, this, &MetricsServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void MetricsServer::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (!socket) return;
+    if (!socket->canReadLine()) {
+        if (socket->bytesAvailable() > MAX_REQUEST_LINE) socket->abort();
+        return;
+    }
+
+    // Only the request line matters; the rest of the request is dropped
+    char line[MAX_REQUEST_LINE];
+    socket->readLine(line, sizeof(line));
+    socket->skip(socket->bytesAvailable());
+
+    const QByteArray &reply = qstrncmp(line, "GET /metrics ", 13) == 0 ? m_response : m_notFound;
+    socket->write(reply.constData(), reply.size());
+    socket->disconnectFromHost();
+}
@@ -0,0 +1,66 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QByteArray>
+#include <QVector>
+#include "metricsregistry.h"
+
+// Serves the MetricsRegistry to Prometheus-style scrapers as OpenMetrics
+// text on http://127.0.0.1:<port>/metrics. Off unless NEOCITY_METRICS_PORT
+// is set. The exposition is rendered every RENDER_MS from a cached series
+// layout into buffers that are reused, so once they have grown to size a
+// render allocates nothing, and a scrape only copies the latest response
+// into the socket. Latency histograms are exposed as summaries in seconds.
+// Try it with NEOCITY_METRICS_PORT=9464 and
+// curl http://127.0.0.1:9464/metrics. GUI thread only.
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(quint16 port, QObject *parent = nullptr);
+
+    // nullptr unless NEOCITY_METRICS_PORT names a port
+    static MetricsServer *fromEnvironment(QObject *parent);
+
+    bool isListening() const { return m_server->isListening(); }
+    quint16 port() const { return m_server->serverPort(); }
+
+    static const int RENDER_MS = 1000;
+    static const int QUANTILE_COUNT = 3;
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    // One registry metric and its pre-built exposition line prefixes
+    struct Series
+    {
+        MetricsRegistry::Metric metric;
+        QByteArray family;           // sort key
+        QByteArray header;           // TYPE (and UNIT) lines, first series of a family only
+        QByteArray value;            // counters and gauges
+        QByteArray quantiles[QUANTILE_COUNT];
+        QByteArray sum;
+        QByteArray count;
+    };
+
+    void rebuildLayout();
+    void render();
+    void appendUnsigned(QByteArray &out, quint64 value);
+    void appendSigned(QByteArray &out, qint64 value);
+    void appendSeconds(QByteArray &out, quint64 us);
+
+    QTcpServer *m_server;
+    QVector<Series> m_series;
+    int m_layoutSize;                // registry size the layout was built from
+    QByteArray m_body;
+    QByteArray m_response;           // headers and body, ready to write
+    QByteArray m_notFound;
+};
+
+#endif // METRICSSERVER_H
@@ -0,0 +1,59 @@
+#include "pagelifecycle.h"
+#include "tickdriver.h"
+#include <QEvent>
+
+PageLifecycle::PageLifecycle(QWidget *page)
+    : QObject(page)
+    , m_page(page)
+    , m_state(Active)
+{
+    // Pages are built on first navigation and shown straight away
+    m_suspendTimer = new QTimer(this);
+    m_suspendTimer->setSingleShot(true);
+    m_suspendTimer->setInterval(SUSPEND_AFTER_MS);
+    connect(m_suspendTimer, &QTimer::timeout, this, [this]() { enter(Suspended); });
+    m_page->installEventFilter(this);
+}
+
+void PageLifecycle::manage(int tick, int backgroundMs, int suspendedMs)
+{
+    ManagedTick managed = {tick, {TickDriver::instance()->interval(tick), backgroundMs, suspendedMs}};
+    m_ticks.append(managed);
+    if (m_state != Active) enter(m_state);
+}
+
+QString PageLifecycle::stateName(State state)
+{
+    switch (state) {
+        case Active: return "Active";
+        case Background: return "Background";
+        case Suspended: return "Suspended";
+        default: return QString();
+    }
+}
+
+bool PageLifecycle::eventFilter(QObject *watched, QEvent *event)
+{
+    // Only the page's own visibility counts, not that of the window
+    if (watched == m_page && !event->spontaneous()) {
+        if (event->type() == QEvent::Show && m_state != Active) {
+            m_suspendTimer->stop();
+            enter(Active);
+            emit resumed();
+        } else if (event->type() == QEvent::Hide && m_state == Active) {
+            enter(Background);
+            m_suspendTimer->start();
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void PageLifecycle::enter(State state)
+{
+    for (const ManagedTick &managed : m_ticks) {
+        TickDriver::instance()->setInterval(managed.tick, managed.intervalMs[state]);
+    }
+    if (state == m_state) return;
+    m_state = state;
+    emit stateChanged(state);
+}
@@ -0,0 +1,61 @@
+#ifndef PAGELIFECYCLE_H
+#define PAGELIFECYCLE_H
+
+#include <QObject>
+#include <QWidget>
+#include <QTimer>
+#include <QVector>
+
+// Run state of a page in the main window's stack, driven by its show and
+// hide events. A page is Active while shown. Once hidden it is in
+// Background: its widget updates stay parked in the UI scheduler but its
+// models keep ingesting. After SUSPEND_AFTER_MS hidden it is Suspended.
+// Each managed tick of the TickDriver has an interval per state, and a
+// zero interval pauses it, so ticks that only feed the page's own view go
+// quiet. Showing the page restores every tick and emits resumed(), so the
+// page can catch up from its latest model state in one batch.
+class PageLifecycle : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Active,
+        Background,
+        Suspended,
+        STATE_COUNT
+    };
+
+    explicit PageLifecycle(QWidget *page);
+
+    // The tick's current interval is its Active one
+    void manage(int tick, int backgroundMs, int suspendedMs);
+    State state() const { return m_state; }
+    static QString stateName(State state);
+
+    static const int SUSPEND_AFTER_MS = 30000;
+
+signals:
+    void stateChanged(PageLifecycle::State state);
+    // Shown again after being hidden
+    void resumed();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct ManagedTick
+    {
+        int tick;
+        int intervalMs[STATE_COUNT];
+    };
+
+    void enter(State state);
+
+    QWidget *m_page;
+    State m_state;
+    QVector<ManagedTick> m_ticks;
+    QTimer *m_suspendTimer;
+};
+
+#endif // PAGELIFECYCLE_H
@@ -1,4 +1,11 @@
 #include "pedestriansafetymodule.h"
+#include "cityeventbus.h"
+#include "citystabilitymodel.h"
+#include "citylayout.h"
+#include "uiupdatescheduler.h"
+#include "metricsregistry.h"
+#include "tickdriver.h"
+#include "tracer.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -8,6 +15,7 @@
 #include <QRandomGenerator>
 #include <QScrollArea>
 #include <QDateTime>
+#include <QTimer>
 #include <QtCharts/QBarCategoryAxis>
 #include <QtCharts/QValueAxis>
 
@@ -24,10 +32,8 @@ PedestrianSafetyModule::PedestrianSafetyModule(QWidget *parent)
     // Initialize alert history (last 7 days)
     m_alertHistory = {8, 5, 10, 12, 9, 15, 12};
     
-    // Setup auto-update timer
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer, &QTimer::timeout, this, &PedestrianSafetyModule::updateSafetyData);
-    m_updateTimer->start(6000); // Update every 6 seconds
+    // Auto-update tick
+    m_updateTick = TickDriver::instance()->add("Pedestrian", 6000, this, [this]() { updateSafetyData(); });
     
     // Initial data population
     updateSafetyData();
@@ -410,32 +416,46 @@ void PedestrianSafetyModule::createViolationsTable()
 
 void PedestrianSafetyModule::updateSafetyData()
 {
+    TRACE_SCOPE("PedestrianSafetyModule::updateSafetyData");
     // Randomly generate new alerts
     if (QRandomGenerator::global()->bounded(100) < 15) { // 15% chance
         m_totalAlerts++;
-        m_totalAlertsLabel->setText(QString::number(m_totalAlerts));
         
         // Update alert history
         m_alertHistory.removeLast();
         m_alertHistory.prepend(m_totalAlerts);
         
-        // Update chart
-        m_alertsSeries->clear();
-        QBarSet *alertSet = new QBarSet("Alerts");
-        for (int count : m_alertHistory) {
-            *alertSet << count;
-        }
-        alertSet->setColor(QColor(COLOR_WARNING));
-        m_alertsSeries->append(alertSet);
+        UiUpdateScheduler *ui = UiUpdateScheduler::instance();
+        ui->post(this, AlertCountRegion, UiUpdateScheduler::High, [this]() {
+            m_totalAlertsLabel->setText(QString::number(m_totalAlerts));
+        });
+        ui->post(this, ChartRegion, UiUpdateScheduler::Low, [this]() { refreshAlertsChart(); });
     }
     
     // Update risk level
     updateRiskLevel();
 }
 
+void PedestrianSafetyModule::refreshAlertsChart()
+{
+    SCOPED_LATENCY("chart_update_us", "Pedestrian");
+    TRACE_SCOPE("PedestrianSafetyModule::refreshAlertsChart");
+    m_alertsSeries->clear();
+    QBarSet *alertSet = new QBarSet("Alerts");
+    for (int count : m_alertHistory) {
+        *alertSet << count;
+    }
+    alertSet->setColor(QColor(COLOR_WARNING));
+    m_alertsSeries->append(alertSet);
+}
+
 void PedestrianSafetyModule::updateCrosswalkStatus(const QString &crosswalkId, const QString &location,
                                                    const QString &riskLevel, const QString &status)
 {
+    CityLayout::instance()->place(CityLayout::Crosswalk, crosswalkId, location);
+    double risk = riskLevel == "High" ? 1.0 : (riskLevel == "Medium" ? 0.6 : 0.25);
+    CityLayout::instance()->setValue(CityLayout::Crosswalk, crosswalkId, risk);
+    
     int row = m_crosswalkStatusTable->rowCount();
     m_crosswalkStatusTable->insertRow(row);
     
@@ -444,6 +464,9 @@ void PedestrianSafetyModule::updateCrosswalkStatus(const QString &crosswalkId, c
     m_crosswalkStatusTable->setItem(row, 2, new QTableWidgetItem(riskLevel));
     m_crosswalkStatusTable->setItem(row, 3, new QTableWidgetItem(status));
     
+    CityStabilityModel *stability = CityStabilityModel::instance();
+    stability->assignSensor(CityEventBus::instance()->sensorId(crosswalkId), stability->zone(location));
+    
     // Color-code risk level
     QString riskColor = getRiskColor(riskLevel);
     m_crosswalkStatusTable->item(row, 2)->setForeground(QBrush(QColor(riskColor)));
@@ -479,24 +502,24 @@ void PedestrianSafetyModule::updateRiskLevel()
 {
     // Calculate risk based on alerts and violations
     int riskScore = (m_totalAlerts * 4) + (m_totalViolations * 6);
-    
-    QString level;
-    QString color;
     if (riskScore < 40) {
-        level = "LOW";
-        color = COLOR_SUCCESS;
         m_currentRiskLevel = "Low";
     } else if (riskScore < 80) {
-        level = "MEDIUM";
-        color = COLOR_WARNING;
         m_currentRiskLevel = "Medium";
     } else {
-        level = "HIGH";
-        color = COLOR_CRITICAL;
         m_currentRiskLevel = "High";
     }
     
-    m_riskLevelLabel->setText(level);
+    UiUpdateScheduler::instance()->post(this, RiskRegion, UiUpdateScheduler::Urgent, [this, riskScore]() {
+        showRiskLevel(riskScore);
+    });
+    emit riskLevelChanged(m_currentRiskLevel);
+}
+
+void PedestrianSafetyModule::showRiskLevel(int riskScore)
+{
+    QString color = getRiskColor(m_currentRiskLevel);
+    m_riskLevelLabel->setText(m_currentRiskLevel.toUpper());
     m_riskLevelLabel->setStyleSheet("font-size: 28px; font-weight: bold; color: " + color + ";");
     m_riskBar->setValue(qMin(100, riskScore));
     m_riskBar->setStyleSheet(
@@ -511,8 +534,6 @@ void PedestrianSafetyModule::updateRiskLevel()
         "    border-radius: 3px;"
         "}"
     );
-    
-    emit riskLevelChanged(m_currentRiskLevel);
 }
 
 QString PedestrianSafetyModule::getRiskColor(const QString &riskLevel)
@@ -541,7 +562,27 @@ void PedestrianSafetyModule::onDispatchPatrol()
         QString riskLevel = m_crosswalkStatusTable->item(i, 2)->text();
         if (riskLevel == "High") {
             QString crosswalkId = m_crosswalkStatusTable->item(i, 0)->text();
-            addLogMessage("Patrol assigned to " + crosswalkId);
+            
+            // Send the closest unit not already on a call, and move it there
+            CityLayout *layout = CityLayout::instance();
+            double x = 0.0;
+            double y = 0.0;
+            layout->position(CityLayout::Crosswalk, crosswalkId, x, y);
+            CityEntity patrol = layout->dispatchPatrol(x, y);
+            if (patrol.id.isEmpty()) {
+                addLogMessage("No patrol available for " + crosswalkId);
+                continue;
+            }
+            addLogMessage(QString("%1 assigned to %2 (%3 m away)")
+                          .arg(patrol.id, crosswalkId).arg(qRound(patrol.distance)));
+            
+            // Back to station once the call is over, so later dispatches
+            // measure from where the unit really is
+            const QString patrolId = patrol.id;
+            QTimer::singleShot(CityLayout::PATROL_ON_CALL_MS, this, [this, patrolId]() {
+                CityLayout::instance()->returnPatrol(patrolId);
+                addLogMessage(patrolId + " back at station and available");
+            });
         }
     }
 }
@@ -560,6 +601,8 @@ void PedestrianSafetyModule::onSimulateViolation()
     m_violationsLabel->setText(QString::number(m_totalViolations));
     
     addLogMessage("⚠️ VIOLATION: " + vehicleId + " exceeded speed at " + randomCrosswalk + " (" + QString::number(speed) + " km/h)");
+    CityEventBus *bus = CityEventBus::instance();
+    bus->publish(EVENT_SPEED_READING, bus->sensorId(randomCrosswalk), speed);
     emit violationDetected(vehicleId, speed);
     
     updateRiskLevel();
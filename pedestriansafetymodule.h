@@ -5,7 +5,6 @@
 #include <QTableWidget>
 #include <QLabel>
 #include <QPushButton>
-#include <QTimer>
 #include <QVector>
 #include <QProgressBar>
 #include <QtCharts/QChart>
@@ -51,6 +50,8 @@ private:
     void addViolation(const QString &crosswalkId, const QString &vehicleId, 
                      int speed, const QString &timestamp);
     void updateRiskLevel();
+    void showRiskLevel(int riskScore);
+    void refreshAlertsChart();
     QString getRiskColor(const QString &riskLevel);
     void addLogMessage(const QString &message);
     
@@ -76,8 +77,15 @@ private:
     QPushButton *m_dispatchBtn;
     QPushButton *m_simulateBtn;
     
+    // Widget regions posted to the UI scheduler
+    enum UiRegion {
+        AlertCountRegion,
+        RiskRegion,
+        ChartRegion
+    };
+    
     // Data tracking
-    QTimer *m_updateTimer;
+    int m_updateTick;
     int m_totalAlerts;
     int m_totalViolations;
     QString m_currentRiskLevel;
@@ -0,0 +1,128 @@
+#include "performancehud.h"
+#include "metricsregistry.h"
+#include "tickdriver.h"
+#include "tracer.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QEvent>
+#include <QFile>
+#include <QFileDialog>
+#include <QClipboard>
+#include <QGuiApplication>
+#include <QMessageBox>
+
+PerformanceHud::PerformanceHud(QWidget *parent)
+    : QFrame(parent)
+{
+    setObjectName("performanceHud");
+    setStyleSheet(QString(
+        "#performanceHud { background-color: %1; border: 1px solid %2; border-radius: 6px; }"
+        "QLabel { color: %3; font-family: 'Consolas', 'DejaVu Sans Mono', monospace; font-size: 11px; }"
+        "QLabel#hudTitle { color: %4; font-weight: bold; }"
+        "QPushButton { color: %3; background-color: transparent; border: 1px solid %4;"
+        " border-radius: 3px; padding: 2px 8px; font-size: 11px; }"
+        "QPushButton:hover { border-color: %2; }")
+        .arg(COLOR_BACKGROUND, COLOR_BORDER, COLOR_TEXT, COLOR_MUTED));
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(10, 8, 10, 8);
+    layout->setSpacing(6);
+
+    QHBoxLayout *header = new QHBoxLayout();
+    QLabel *title = new QLabel("PERFORMANCE  (F12)");
+    title->setObjectName("hudTitle");
+    header->addWidget(title);
+    header->addStretch();
+    m_copyButton = new QPushButton("Copy text");
+    m_saveButton = new QPushButton("Save JSON");
+    m_traceButton = new QPushButton(Tracer::isEnabled() ? "Save trace" : "Start trace");
+    connect(m_copyButton, &QPushButton::clicked, this, &PerformanceHud::copyText);
+    connect(m_saveButton, &QPushButton::clicked, this, &PerformanceHud::saveJson);
+    connect(m_traceButton, &QPushButton::clicked, this, &PerformanceHud::toggleTrace);
+    header->addWidget(m_copyButton);
+    header->addWidget(m_saveButton);
+    header->addWidget(m_traceButton);
+    layout->addLayout(header);
+
+    m_body = new QLabel();
+    m_body->setTextFormat(Qt::PlainText);
+    m_body->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(m_body);
+
+    // Paused until shown
+    m_refreshTick = TickDriver::instance()->add("Performance HUD", REFRESH_MS, this, [this]() { refresh(); });
+    TickDriver::instance()->setInterval(m_refreshTick, 0);
+
+    parent->installEventFilter(this);
+    hide();
+}
+
+bool PerformanceHud::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == parentWidget() && event->type() == QEvent::Resize && isVisible()) place();
+    return QFrame::eventFilter(watched, event);
+}
+
+void PerformanceHud::showEvent(QShowEvent *event)
+{
+    QFrame::showEvent(event);
+    refresh();
+    raise();
+    TickDriver::instance()->setInterval(m_refreshTick, REFRESH_MS);
+}
+
+void PerformanceHud::hideEvent(QHideEvent *event)
+{
+    QFrame::hideEvent(event);
+    TickDriver::instance()->setInterval(m_refreshTick, 0);
+}
+
+void PerformanceHud::refresh()
+{
+    m_body->setText(MetricsRegistry::instance()->toText());
+    place();
+}
+
+void PerformanceHud::place()
+{
+    adjustSize();
+    const QWidget *area = parentWidget();
+    const int height = qMin(sizeHint().height(), area->height() - 2 * MARGIN);
+    resize(sizeHint().width(), height);
+    move(area->width() - width() - MARGIN, MARGIN);
+}
+
+void PerformanceHud::copyText()
+{
+    QGuiApplication::clipboard()->setText(MetricsRegistry::instance()->toText());
+}
+
+void PerformanceHud::saveJson()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Save Metrics", "neocity-metrics.json", "JSON (*.json)");
+    if (path.isEmpty()) return;
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QMessageBox::warning(this, "Warning", "Could not write " + path + ".");
+        return;
+    }
+    file.write(MetricsRegistry::instance()->toJson());
+}
+
+void PerformanceHud::toggleTrace()
+{
+    if (!Tracer::isEnabled()) {
+        Tracer::setEnabled(true);
+        m_traceButton->setText("Save trace");
+        return;
+    }
+    
+    // Stop before asking, so the trace ends where the user clicked
+    Tracer::setEnabled(false);
+    m_traceButton->setText("Start trace");
+    QString path = QFileDialog::getSaveFileName(this, "Save Trace", "neocity-trace.json", "Chrome trace (*.json)");
+    if (path.isEmpty()) return;
+    if (!Tracer::writeChromeTrace(path)) {
+        QMessageBox::warning(this, "Warning", "Could not write " + path + ".");
+    }
+}
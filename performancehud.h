@@ -0,0 +1,50 @@
+#ifndef PERFORMANCEHUD_H
+#define PERFORMANCEHUD_H
+
+#include <QFrame>
+#include <QLabel>
+#include <QPushButton>
+
+// Overlay in the top-right corner of its parent listing every metric in
+// the MetricsRegistry, refreshed once a second while shown. Its tick is
+// paused while hidden, so the HUD costs nothing until it is toggled on.
+// The same listing can be copied as text or saved as JSON, and a span
+// trace can be started and saved as Chrome trace JSON.
+class PerformanceHud : public QFrame
+{
+    Q_OBJECT
+
+public:
+    explicit PerformanceHud(QWidget *parent);
+
+    static const int REFRESH_MS = 1000;
+    static const int MARGIN = 12;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+    void copyText();
+    void saveJson();
+    void toggleTrace();
+
+private:
+    void place();
+
+    QLabel *m_body;
+    QPushButton *m_copyButton;
+    QPushButton *m_saveButton;
+    QPushButton *m_traceButton;
+    int m_refreshTick;
+
+    // Colors
+    const QString COLOR_BACKGROUND = "rgba(16, 16, 16, 225)";
+    const QString COLOR_BORDER = "#1E90FF";
+    const QString COLOR_TEXT = "#E0E0E0";
+    const QString COLOR_MUTED = "#888888";
+};
+
+#endif // PERFORMANCEHUD_H
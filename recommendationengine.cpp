@@ -0,0 +1,245 @@
+#include "recommendationengine.h"
+#include "forecastthread.h"
+#include <QElapsedTimer>
+
+namespace {
+const RecommendationEngine::ActionEffect EFFECTS[RecommendationEngine::ACTION_COUNT] = {
+    {CityStabilityModel::WasteRisk,  0.8, CityStabilityModel::WasteRisk,  0.0, "Dispatch waste collection crew to %1"},
+    {CityStabilityModel::SafetyRisk, 0.5, CityStabilityModel::SafetyRisk, 0.0, "Dispatch patrol unit to %1"},
+    {CityStabilityModel::SafetyRisk, 0.3, CityStabilityModel::EnergyRisk, 2.0, "Boost street lighting in %1"},
+    {CityStabilityModel::CyberRisk,  0.6, CityStabilityModel::CyberRisk,  0.0, "Harden access control for %1"}
+};
+
+const double HIGH_IMPACT = 3.0;
+const double MEDIUM_IMPACT = 1.0;
+// Best-candidate changes smaller than this do not notify the pages
+const double NOTIFY_DELTA = 0.05;
+}
+
+RecommendationEngine::RecommendationEngine()
+    : QObject(nullptr)
+    , m_stability(CityStabilityModel::instance())
+    , m_zoneCount(0)
+    , m_capacity(0)
+    , m_lastBest(-1)
+    , m_lastBestReduction(0.0)
+    , m_lastUpdateMicros(0)
+{
+    connect(m_stability, &CityStabilityModel::zoneRiskChanged,
+            this, &RecommendationEngine::onZoneRiskChanged);
+    growZones(m_stability->zoneCount());
+}
+
+RecommendationEngine *RecommendationEngine::instance()
+{
+    static RecommendationEngine engine;
+    return &engine;
+}
+
+const RecommendationEngine::ActionEffect &RecommendationEngine::effect(int action)
+{
+    return EFFECTS[action];
+}
+
+QString RecommendationEngine::actionType(int action)
+{
+    switch (action) {
+    case BoostLighting: return "Preventive";
+    case HardenAccess:  return "Strategic";
+    default:            return "Operational";
+    }
+}
+
+void RecommendationEngine::growZones(int zoneCount)
+{
+    if (zoneCount <= m_zoneCount) return;
+
+    m_forecastMean.resize(zoneCount);
+    m_forecastSpread.resize(zoneCount);
+    m_zoneDirty.resize(zoneCount);
+    for (int zone = m_zoneCount; zone < zoneCount; ++zone) {
+        m_forecastMean[zone] = -1.0f;
+        m_forecastSpread[zone] = 1.0f;
+        m_zoneDirty[zone] = 0;
+    }
+
+    const int candidates = zoneCount * ACTION_COUNT;
+    const int oldCandidates = m_reduction.size();
+    m_reduction.resize(candidates);
+    m_effective.resize(candidates);
+    m_suppressedUntil.resize(candidates);
+    for (int c = oldCandidates; c < candidates; ++c) {
+        m_reduction[c] = 0.0;
+        m_effective[c] = -1.0;
+        m_suppressedUntil[c] = 0;
+    }
+
+    if (candidates > m_capacity) {
+        // Rebuild the tree at the next power of two
+        int capacity = qMax(16, m_capacity);
+        while (capacity < candidates) capacity *= 2;
+        m_capacity = capacity;
+        m_tree.fill(-1, 2 * capacity);
+        for (int c = 0; c < candidates; ++c) m_tree[capacity + c] = c;
+        for (int node = capacity - 1; node >= 1; --node) {
+            int left = m_tree[2 * node];
+            int right = m_tree[2 * node + 1];
+            if (left < 0) m_tree[node] = right;
+            else if (right < 0) m_tree[node] = left;
+            else m_tree[node] = m_effective[left] >= m_effective[right] ? left : right;
+        }
+    } else {
+        for (int c = oldCandidates; c < candidates; ++c) {
+            m_tree[m_capacity + c] = c;
+            setEffective(c, -1.0);
+        }
+    }
+
+    for (int zone = m_zoneCount; zone < zoneCount; ++zone) onZoneRiskChanged(zone);
+    m_zoneCount = zoneCount;
+}
+
+void RecommendationEngine::onZoneRiskChanged(int zone)
+{
+    if (zone >= m_zoneCount && zone >= m_zoneDirty.size()) growZones(m_stability->zoneCount());
+    if (m_zoneDirty[zone]) return;
+    m_zoneDirty[zone] = 1;
+    m_dirtyZones.append(zone);
+}
+
+void RecommendationEngine::setForecasts(const RiskForecastSnapshot &frame)
+{
+    growZones(m_stability->zoneCount());
+
+    const int zones = qMin(m_zoneCount, frame.seriesCount - ForecastThread::ZONE_SERIES);
+    for (int zone = 0; zone < zones; ++zone) {
+        const RiskForecastPoint &point =
+                frame.horizons[(ForecastThread::ZONE_SERIES + zone) * RiskForecaster::HORIZON_COUNT];
+        float mean = static_cast<float>(point.mean);
+        float spread = point.mean > 0.0 ? static_cast<float>((point.upper - point.lower) / point.mean) : 1.0f;
+        if (qAbs(mean - m_forecastMean[zone]) < 0.01f && qAbs(spread - m_forecastSpread[zone]) < 0.01f) continue;
+
+        m_forecastMean[zone] = mean;
+        m_forecastSpread[zone] = spread;
+        onZoneRiskChanged(zone);
+    }
+}
+
+void RecommendationEngine::rescoreZone(int zone)
+{
+    // A zone heading up in the forecast gets more out of acting now
+    const double penalty = m_stability->zonePenalty(zone);
+    const double forecast = m_forecastMean[zone];
+    const double growth = forecast > 0.0 && penalty > 0.0 ? qMax(1.0, forecast / penalty) : 1.0;
+
+    for (int action = 0; action < ACTION_COUNT; ++action) {
+        const ActionEffect &effect = EFFECTS[action];
+        double excess = m_stability->risk(zone, effect.factor) - m_stability->baseline(zone, effect.factor);
+        double reduction = effect.clearedShare * qMax(0.0, excess) * growth
+                * CityStabilityModel::factorWeight(effect.factor)
+                - effect.costRisk * CityStabilityModel::factorWeight(effect.costFactor);
+
+        int candidate = zone * ACTION_COUNT + action;
+        m_reduction[candidate] = reduction;
+        setEffective(candidate, m_suppressedUntil[candidate] > 0 ? -1.0 : reduction);
+    }
+}
+
+void RecommendationEngine::setEffective(int candidate, double value)
+{
+    m_effective[candidate] = value;
+    for (int node = (m_capacity + candidate) / 2; node >= 1; node /= 2) {
+        int left = m_tree[2 * node];
+        int right = m_tree[2 * node + 1];
+        int winner;
+        if (left < 0) winner = right;
+        else if (right < 0) winner = left;
+        else winner = m_effective[left] >= m_effective[right] ? left : right;
+        m_tree[node] = winner;
+    }
+}
+
+void RecommendationEngine::update(qint64 nowMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    growZones(m_stability->zoneCount());
+
+    // Dismissed candidates come back once their hold expires
+    for (int i = m_suppressed.size() - 1; i >= 0; --i) {
+        int candidate = m_suppressed[i];
+        if (m_suppressedUntil[candidate] > nowMs) continue;
+        m_suppressedUntil[candidate] = 0;
+        setEffective(candidate, m_reduction[candidate]);
+        m_suppressed[i] = m_suppressed.last();
+        m_suppressed.removeLast();
+    }
+
+    for (int zone : m_dirtyZones) {
+        m_zoneDirty[zone] = 0;
+        rescoreZone(zone);
+    }
+    m_dirtyZones.clear();
+
+    m_lastUpdateMicros = timer.nsecsElapsed() / 1000;
+
+    int bestCandidate = m_capacity > 0 ? m_tree[1] : -1;
+    double bestReduction = bestCandidate >= 0 ? m_effective[bestCandidate] : 0.0;
+    if (bestCandidate != m_lastBest || qAbs(bestReduction - m_lastBestReduction) >= NOTIFY_DELTA) {
+        m_lastBest = bestCandidate;
+        m_lastBestReduction = bestReduction;
+        emit recommendationsChanged();
+    }
+}
+
+int RecommendationEngine::topK(int k, QVector<Recommendation> &out)
+{
+    // Take winners one at a time, then put them back
+    int taken = 0;
+    QVector<int> winners;
+    while (taken < k && m_capacity > 0) {
+        int winner = m_tree[1];
+        if (winner < 0 || m_effective[winner] <= 0.0) break;
+        out.append(describe(winner));
+        winners.append(winner);
+        setEffective(winner, -1.0);
+        ++taken;
+    }
+    for (int winner : winners) setEffective(winner, m_reduction[winner]);
+    return taken;
+}
+
+bool RecommendationEngine::best(Recommendation &out)
+{
+    if (m_capacity == 0) return false;
+    int winner = m_tree[1];
+    if (winner < 0 || m_effective[winner] <= 0.0) return false;
+    out = describe(winner);
+    return true;
+}
+
+void RecommendationEngine::dismiss(int candidate, qint64 nowMs)
+{
+    if (candidate < 0 || candidate >= m_reduction.size()) return;
+    if (m_suppressedUntil[candidate] == 0) m_suppressed.append(candidate);
+    m_suppressedUntil[candidate] = nowMs + static_cast<qint64>(SUPPRESS_SECONDS) * 1000;
+    setEffective(candidate, -1.0);
+}
+
+Recommendation RecommendationEngine::describe(int candidate) const
+{
+    Recommendation r;
+    r.candidate = candidate;
+    r.zone = candidate / ACTION_COUNT;
+    r.action = candidate % ACTION_COUNT;
+    r.text = QString(EFFECTS[r.action].text).arg(m_stability->zoneName(r.zone));
+    r.reduction = m_reduction[candidate];
+
+    // Narrow forecast bands mean a confident outlook
+    float spread = m_forecastMean[r.zone] < 0.0f ? 1.0f : qMin(1.0f, m_forecastSpread[r.zone]);
+    r.confidence = m_forecastMean[r.zone] < 0.0f ? 60 : qRound(95.0f - 35.0f * spread);
+
+    r.impact = r.reduction >= HIGH_IMPACT ? "High" : r.reduction >= MEDIUM_IMPACT ? "Medium" : "Low";
+    return r;
+}
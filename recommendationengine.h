@@ -0,0 +1,108 @@
+#ifndef RECOMMENDATIONENGINE_H
+#define RECOMMENDATIONENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "citystabilitymodel.h"
+#include "riskforecaster.h"
+
+// One scored candidate action
+struct Recommendation
+{
+    int candidate;
+    int zone;
+    int action;
+    QString text;
+    double reduction;    // predicted stability penalty removed
+    int confidence;      // percent
+    QString impact;      // Low / Medium / High
+};
+
+// Scores candidate actions (one per zone and action type) by the stability
+// penalty they are predicted to remove: the share of a zone's excess risk
+// the action clears, scaled up when the zone's 24-hour forecast rises,
+// less the risk the action itself adds. Zones are re-scored only when the
+// stability model or their forecast changes, and the best candidates sit
+// in a tournament tree, so an update is O(changed x log candidates) and
+// top-k is O(k log candidates). GUI thread only.
+class RecommendationEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Action {
+        DispatchCollection,
+        DispatchPatrol,
+        BoostLighting,
+        HardenAccess,
+        ACTION_COUNT
+    };
+
+    // What an action does to its zone: the factor it works on, the share of
+    // that factor's excess risk it clears, and any risk it adds elsewhere
+    struct ActionEffect
+    {
+        CityStabilityModel::RiskFactor factor;
+        double clearedShare;
+        CityStabilityModel::RiskFactor costFactor;
+        double costRisk;
+        const char *text;
+    };
+
+    static RecommendationEngine *instance();
+
+    // Inputs
+    void setForecasts(const RiskForecastSnapshot &frame);
+    void update(qint64 nowMs);
+
+    // Best candidates first; only candidates with a positive reduction
+    int topK(int k, QVector<Recommendation> &out);
+    bool best(Recommendation &out);
+
+    // Operator feedback; the candidate is held back for SUPPRESS_SECONDS
+    void dismiss(int candidate, qint64 nowMs);
+
+    static QString actionType(int action);
+    static const ActionEffect &effect(int action);
+    qint64 lastUpdateMicros() const { return m_lastUpdateMicros; }
+
+    static const int SUPPRESS_SECONDS = 600;
+
+signals:
+    void recommendationsChanged();
+
+private:
+    RecommendationEngine();
+
+    void onZoneRiskChanged(int zone);
+    void growZones(int zoneCount);
+    void rescoreZone(int zone);
+    void setEffective(int candidate, double value);
+    Recommendation describe(int candidate) const;
+
+    CityStabilityModel *m_stability;
+    int m_zoneCount;
+
+    // Per zone
+    QVector<float> m_forecastMean;     // 24 h zone penalty, -1 = no forecast yet
+    QVector<float> m_forecastSpread;   // band width / forecast
+    QVector<quint8> m_zoneDirty;
+    QVector<int> m_dirtyZones;
+
+    // Per candidate (zone * ACTION_COUNT + action)
+    QVector<double> m_reduction;
+    QVector<double> m_effective;       // reduction, or -1 while ineligible
+    QVector<qint64> m_suppressedUntil;
+    QVector<int> m_suppressed;
+
+    // Tournament tree of candidate indices, leaves at [capacity + i]
+    QVector<int> m_tree;
+    int m_capacity;
+
+    int m_lastBest;
+    double m_lastBestReduction;
+    qint64 m_lastUpdateMicros;
+};
+
+#endif // RECOMMENDATIONENGINE_H
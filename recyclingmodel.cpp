@@ -0,0 +1,95 @@
+#include "recyclingmodel.h"
+#include <QRandomGenerator>
+#include <QtGlobal>
+
+namespace {
+// Rates match the previous 8-second refresh: 1-5 kg collected and
+// 0-2 % bin fill per tick
+const double COLLECTED_MIN_KG_PER_SEC = 1.0 / 8.0;
+const double COLLECTED_SPAN_KG_PER_SEC = 4.0 / 8.0;
+const double FILL_MAX_PERCENT_PER_SEC = 2.0 / 8.0;
+// The full-soon list follows the clock even when no prediction moves
+const qint64 FULL_SOON_REFRESH_MS = 60 * 1000;
+}
+
+RecyclingModel::RecyclingModel()
+    : m_fullSoonVersion(0)
+    , m_fullSoonBuiltMs(0)
+    , m_totalRecycled(847.0)
+    , m_plasticTotal(320.0)
+    , m_metalTotal(285.0)
+    , m_glassTotal(242.0)
+    , m_activeBins(12)
+{
+    addBin("BIN-001", "Main Street Plaza", 35, 1200, 800);
+    addBin("BIN-002", "Central Park East", 68, 2100, 1500);
+    addBin("BIN-003", "City Hall", 92, 1500, 1100);
+    addBin("BIN-004", "Shopping District", 45, 900, 1900);
+    addBin("BIN-005", "University Campus", 78, 3200, 2400);
+    addBin("BIN-006", "Residential Zone A", 22, 400, 2800);
+    addBin("BIN-007", "Industrial Park", 88, 3600, 300);
+    addBin("BIN-008", "Sports Complex", 41, 2700, 3100);
+}
+
+void RecyclingModel::addBin(const QString &id, const QString &location, double fillLevel,
+                            double x, double y)
+{
+    m_bins.append({id, location, fillLevel, x, y});
+    m_lastDepositKg.append(0.0);
+    m_predictor.addBin();
+}
+
+void RecyclingModel::step(double dtSeconds, QRandomGenerator &rng)
+{
+    if (dtSeconds <= 0.0) return;
+
+    double increment = (COLLECTED_MIN_KG_PER_SEC + rng.generateDouble() * COLLECTED_SPAN_KG_PER_SEC) * dtSeconds;
+    m_totalRecycled += increment;
+
+    // Distribute increment among waste types
+    m_plasticTotal += increment * 0.38;
+    m_metalTotal += increment * 0.34;
+    m_glassTotal += increment * 0.28;
+
+    for (int i = 0; i < m_bins.size(); ++i) {
+        RecyclingBin &bin = m_bins[i];
+        double increase = rng.generateDouble() * FILL_MAX_PERCENT_PER_SEC * dtSeconds;
+        double filled = qMin(100.0, bin.fillLevel + increase);
+        m_lastDepositKg[i] = (filled - bin.fillLevel) * BIN_CAPACITY_KG / 100.0;
+        bin.fillLevel = filled;
+    }
+}
+
+void RecyclingModel::setFillLevel(int bin, double fillLevel)
+{
+    if (bin < 0 || bin >= m_bins.size()) return;
+    m_bins[bin].fillLevel = qBound(0.0, fillLevel, 100.0);
+}
+
+void RecyclingModel::updatePredictions(qint64 nowMs)
+{
+    m_predictor.setClock(nowMs);
+    for (int i = 0; i < m_bins.size(); ++i) m_predictor.observe(i, m_bins[i].fillLevel);
+
+    // Rebuilt from the sorted index, and only when it has moved
+    if (m_predictor.indexVersion() == m_fullSoonVersion && nowMs - m_fullSoonBuiltMs < FULL_SOON_REFRESH_MS) return;
+    m_fullSoonVersion = m_predictor.indexVersion();
+    m_fullSoonBuiltMs = nowMs;
+
+    m_fullSoonScratch.clear();
+    m_predictor.binsFullBefore(nowMs + static_cast<qint64>(FULL_SOON_HOURS) * 3600 * 1000, m_fullSoonScratch);
+    m_fullSoon.clear();
+    for (int bin : m_fullSoonScratch) m_fullSoon.append({bin, m_predictor.fullAtMs(bin)});
+}
+
+void RecyclingModel::fillSnapshot(RecyclingSnapshot &snapshot) const
+{
+    // Shares the bin vector; the next step() detaches the model's copy
+    snapshot.bins = m_bins;
+    snapshot.fullSoon = m_fullSoon;
+    snapshot.totalRecycled = m_totalRecycled;
+    snapshot.plasticTotal = m_plasticTotal;
+    snapshot.metalTotal = m_metalTotal;
+    snapshot.glassTotal = m_glassTotal;
+    snapshot.activeBins = m_activeBins;
+}
@@ -0,0 +1,79 @@
+#ifndef RECYCLINGMODEL_H
+#define RECYCLINGMODEL_H
+
+#include <QString>
+#include <QVector>
+#include "fillratepredictor.h"
+
+class QRandomGenerator;
+
+struct RecyclingBin
+{
+    QString id;
+    QString location;
+    double fillLevel;    // percent
+    double x;            // metres east of the collection depot
+    double y;            // metres north of the collection depot
+};
+
+struct BinForecast
+{
+    int bin;
+    qint64 fullAtMs;
+};
+
+// Immutable frame handed to the UI
+struct RecyclingSnapshot
+{
+    QVector<RecyclingBin> bins;
+    // Bins predicted full within FULL_SOON_HOURS, soonest first
+    QVector<BinForecast> fullSoon;
+    double totalRecycled = 0.0;
+    double plasticTotal = 0.0;
+    double metalTotal = 0.0;
+    double glassTotal = 0.0;
+    int activeBins = 0;
+};
+
+// Headless recycling state, advanced on the simulation thread
+class RecyclingModel
+{
+public:
+    RecyclingModel();
+
+    void step(double dtSeconds, QRandomGenerator &rng);
+    void setFillLevel(int bin, double fillLevel);
+    // Feeds the current levels to the fill-rate predictor
+    void updatePredictions(qint64 nowMs);
+    void fillSnapshot(RecyclingSnapshot &snapshot) const;
+
+    int binCount() const { return m_bins.size(); }
+    const QString &binId(int bin) const { return m_bins[bin].id; }
+    const QString &binLocation(int bin) const { return m_bins[bin].location; }
+    double fillLevel(int bin) const { return m_bins[bin].fillLevel; }
+    // Weight dropped into the bin during the last step
+    double lastDepositKg(int bin) const { return m_lastDepositKg[bin]; }
+
+    const FillRatePredictor &predictor() const { return m_predictor; }
+
+    static constexpr double BIN_CAPACITY_KG = 120.0;
+    static const int FULL_SOON_HOURS = 24;
+
+private:
+    void addBin(const QString &id, const QString &location, double fillLevel, double x, double y);
+
+    QVector<RecyclingBin> m_bins;
+    QVector<double> m_lastDepositKg;
+    FillRatePredictor m_predictor;
+    QVector<BinForecast> m_fullSoon;
+    quint64 m_fullSoonVersion;
+    qint64 m_fullSoonBuiltMs;
+    QVector<int> m_fullSoonScratch;
+    double m_totalRecycled;
+    double m_plasticTotal;
+    double m_metalTotal;
+    double m_glassTotal;
+    int m_activeBins;
+};
+
+#endif // RECYCLINGMODEL_H
@@ -0,0 +1,156 @@
+#include "rewardsledger.h"
+
+RewardsLedger::RewardsLedger()
+    : m_root(-1)
+    , m_seed(0x9E3779B9u)
+    , m_version(0)
+{
+}
+
+quint32 RewardsLedger::citizenId(const QString &name)
+{
+    QHash<QString, quint32>::const_iterator it = m_ids.constFind(name);
+    if (it != m_ids.constEnd()) return it.value();
+
+    quint32 id = static_cast<quint32>(m_names.size());
+    m_ids.insert(name, id);
+    m_names.append(name);
+    m_totalKg.append(0.0);
+    m_earned.append(0.0);
+
+    // xorshift priorities keep the treap balanced in expectation
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    Node node;
+    node.priority = m_seed;
+    m_nodes.append(node);
+    m_root = insert(m_root, static_cast<int>(id));
+    ++m_version;
+    return id;
+}
+
+double RewardsLedger::record(quint32 citizen, double kg, qint64 timestampMs)
+{
+    if (kg <= 0.0) return 0.0;
+
+    double amount = kg * REWARD_PER_KG;
+    RewardTransaction transaction;
+    transaction.timestampMs = timestampMs;
+    transaction.citizen = citizen;
+    transaction.kg = static_cast<float>(kg);
+    transaction.amount = static_cast<float>(amount);
+    m_log.append(transaction);
+
+    // Re-seat the citizen under the new total
+    const int key = static_cast<int>(citizen);
+    m_root = erase(m_root, key);
+    m_totalKg[citizen] += kg;
+    m_earned[citizen] += amount;
+    m_nodes[key].left = -1;
+    m_nodes[key].right = -1;
+    m_nodes[key].size = 1;
+    m_root = insert(m_root, key);
+    ++m_version;
+    return amount;
+}
+
+int RewardsLedger::rank(quint32 citizen) const
+{
+    const int key = static_cast<int>(citizen);
+    int ahead = 0;
+    int node = m_root;
+    while (node >= 0) {
+        if (node == key) return ahead + size(m_nodes[node].left) + 1;
+        if (before(node, key)) {
+            ahead += size(m_nodes[node].left) + 1;
+            node = m_nodes[node].right;
+        } else {
+            node = m_nodes[node].left;
+        }
+    }
+    return 0;
+}
+
+int RewardsLedger::top(int n, QVector<quint32> &out) const
+{
+    // In-order walk that stops after n citizens
+    QVector<int> stack;
+    int node = m_root;
+    int count = 0;
+    while (count < n && (node >= 0 || !stack.isEmpty())) {
+        while (node >= 0) {
+            stack.append(node);
+            node = m_nodes[node].left;
+        }
+        node = stack.takeLast();
+        out.append(static_cast<quint32>(node));
+        ++count;
+        node = m_nodes[node].right;
+    }
+    return count;
+}
+
+bool RewardsLedger::before(int a, int b) const
+{
+    // Most recycled first, earlier registration breaking ties
+    if (m_totalKg[a] != m_totalKg[b]) return m_totalKg[a] > m_totalKg[b];
+    return a < b;
+}
+
+void RewardsLedger::update(int node)
+{
+    m_nodes[node].size = size(m_nodes[node].left) + size(m_nodes[node].right) + 1;
+}
+
+void RewardsLedger::split(int node, int key, int &left, int &right)
+{
+    // left: everything ranked ahead of key
+    if (node < 0) {
+        left = right = -1;
+        return;
+    }
+    if (before(node, key)) {
+        split(m_nodes[node].right, key, m_nodes[node].right, right);
+        left = node;
+    } else {
+        split(m_nodes[node].left, key, left, m_nodes[node].left);
+        right = node;
+    }
+    update(node);
+}
+
+int RewardsLedger::merge(int left, int right)
+{
+    if (left < 0) return right;
+    if (right < 0) return left;
+    if (m_nodes[left].priority > m_nodes[right].priority) {
+        m_nodes[left].right = merge(m_nodes[left].right, right);
+        update(left);
+        return left;
+    }
+    m_nodes[right].left = merge(left, m_nodes[right].left);
+    update(right);
+    return right;
+}
+
+int RewardsLedger::insert(int node, int key)
+{
+    int left = -1;
+    int right = -1;
+    split(node, key, left, right);
+    return merge(merge(left, key), right);
+}
+
+int RewardsLedger::erase(int node, int key)
+{
+    if (node < 0) return -1;
+    if (node == key) return merge(m_nodes[node].left, m_nodes[node].right);
+    if (before(node, key)) {
+        m_nodes[node].right = erase(m_nodes[node].right, key);
+    } else {
+        m_nodes[node].left = erase(m_nodes[node].left, key);
+    }
+    update(node);
+    return node;
+}
@@ -0,0 +1,79 @@
+#ifndef REWARDSLEDGER_H
+#define REWARDSLEDGER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+// One credited deposit
+struct RewardTransaction
+{
+    qint64 timestampMs;
+    quint32 citizen;
+    float kg;
+    float amount;
+};
+
+// Citizen recycling rewards. Every deposit is appended to a transaction
+// log that is never rewritten; balances live in flat per-citizen arrays
+// (citizens are interned to dense ids), and the leaderboard is a treap
+// over (total kg, id) with subtree sizes, one node per citizen, so a
+// credit, a rank query and the first n places are all O(log citizens)
+// (plus n for the listing) however many citizens take part.
+class RewardsLedger
+{
+public:
+    RewardsLedger();
+
+    quint32 citizenId(const QString &name);
+    QString citizenName(quint32 citizen) const { return m_names.value(citizen); }
+    int citizenCount() const { return m_names.size(); }
+
+    // Returns the reward paid for the deposit
+    double record(quint32 citizen, double kg, qint64 timestampMs);
+
+    double totalKg(quint32 citizen) const { return m_totalKg[citizen]; }
+    double earned(quint32 citizen) const { return m_earned[citizen]; }
+    // 1 = most recycled
+    int rank(quint32 citizen) const;
+    // The first n places, best first
+    int top(int n, QVector<quint32> &out) const;
+
+    const QVector<RewardTransaction> &transactions() const { return m_log; }
+    // Bumped whenever the order of the leaderboard or a listed total changes
+    quint64 version() const { return m_version; }
+
+    static constexpr double REWARD_PER_KG = 0.5;
+
+private:
+    struct Node
+    {
+        int left = -1;
+        int right = -1;
+        quint32 priority = 0;
+        int size = 1;
+    };
+
+    bool before(int a, int b) const;
+    int size(int node) const { return node < 0 ? 0 : m_nodes[node].size; }
+    void update(int node);
+    void split(int node, int key, int &left, int &right);
+    int merge(int left, int right);
+    int insert(int node, int key);
+    int erase(int node, int key);
+
+    // Per citizen
+    QStringList m_names;
+    QHash<QString, quint32> m_ids;
+    QVector<double> m_totalKg;
+    QVector<double> m_earned;
+    QVector<Node> m_nodes;
+
+    QVector<RewardTransaction> m_log;
+    int m_root;
+    quint32 m_seed;
+    quint64 m_version;
+};
+
+#endif // REWARDSLEDGER_H
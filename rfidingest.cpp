@@ -0,0 +1,141 @@
+#include "rfidingest.h"
+#include "rfidlogmodel.h"
+#include "stationoccupancyengine.h"
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <cmath>
+
+RfidReaderThread::RfidReaderThread(RfidTapQueue *queue, QObject *parent)
+    : QThread(parent)
+    , m_queue(queue)
+    , m_tapsPerSecond(DEFAULT_TAPS_PER_SECOND)
+    , m_rateScale(1.0)
+    , m_stationSlots(0)
+    , m_dropped(0)
+{
+}
+
+void RfidReaderThread::run()
+{
+    QRandomGenerator rng(QRandomGenerator::global()->generate());
+    const quint64 uidBase = Q_UINT64_C(0x04A0000000000000);
+
+    QElapsedTimer clock;
+    clock.start();
+    qint64 lastNs = clock.nsecsElapsed();
+    double owed = 0.0;
+
+    while (!isInterruptionRequested()) {
+        qint64 nowNs = clock.nsecsElapsed();
+        const double rate = m_tapsPerSecond.load(std::memory_order_relaxed)
+                * m_rateScale.load(std::memory_order_relaxed);
+        owed += (nowNs - lastNs) * 1e-9 * rate;
+        lastNs = nowNs;
+
+        const int stations = m_stationSlots.load(std::memory_order_relaxed);
+        int due = static_cast<int>(owed);
+        owed -= due;
+
+        if (stations > 0 && due > 0) {
+            RfidTap tap;
+            tap.timestampMs = QDateTime::currentMSecsSinceEpoch();
+            for (int i = 0; i < due; ++i) {
+                tap.cardUid = uidBase + rng.bounded(COMMUTER_POOL);
+                tap.station = static_cast<quint16>(rng.bounded(stations));
+                // Slight entry bias so stations fill over time
+                tap.direction = rng.bounded(100) < 60 ? StationOccupancyEngine::Entry
+                                                      : StationOccupancyEngine::Exit;
+                if (!m_queue->tryPush(tap)) {
+                    m_dropped.fetch_add(due - i, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+
+        // Until the next whole tap is owed; higher rates push batches
+        int sleepMs = MAX_SLEEP_MS;
+        if (rate > 0.0) {
+            sleepMs = qBound(1, static_cast<int>(std::ceil((1.0 - owed) * 1000.0 / rate)), MAX_SLEEP_MS);
+        }
+        msleep(sleepMs);
+    }
+}
+
+RfidIngest::RfidIngest(StationOccupancyEngine *engine)
+    : m_engine(engine)
+    , m_batch(DRAIN_BATCH)
+    , m_totalTaps(0)
+    , m_rateWindowTaps(0)
+    , m_tapRate(0.0)
+{
+    m_rateClock.start();
+}
+
+int RfidIngest::drain(RfidLogModel *log)
+{
+    int consumed = 0;
+    int count;
+    while ((count = m_queue.popBatch(m_batch.data(), DRAIN_BATCH)) > 0) {
+        const RfidTap *taps = m_batch.constData();
+        for (int i = 0; i < count; ++i) {
+            const RfidTap &tap = taps[i];
+            ensureStation(tap.station);
+            quint32 passenger = internPassenger(tap.cardUid);
+            if (tap.direction == StationOccupancyEngine::Entry) {
+                ++m_deltaEntries[tap.station];
+            } else {
+                ++m_deltaExits[tap.station];
+            }
+            if (log) log->append(tap.timestampMs, passenger, tap.station, tap.direction);
+        }
+        consumed += count;
+    }
+
+    // Hand the engine one aggregated delta per station instead of per tap
+    const int stations = m_deltaEntries.size();
+    for (int s = 0; s < stations; ++s) {
+        if (m_deltaEntries[s] == 0 && m_deltaExits[s] == 0) continue;
+        m_engine->recordTaps(s, m_deltaEntries[s], m_deltaExits[s]);
+        m_stationEntries[s] += m_deltaEntries[s];
+        m_stationExits[s] += m_deltaExits[s];
+        m_deltaEntries[s] = 0;
+        m_deltaExits[s] = 0;
+    }
+
+    m_totalTaps += consumed;
+    m_rateWindowTaps += consumed;
+    qint64 elapsed = m_rateClock.elapsed();
+    if (elapsed >= 1000) {
+        m_tapRate = m_rateWindowTaps * 1000.0 / elapsed;
+        m_rateWindowTaps = 0;
+        m_rateClock.restart();
+    }
+
+    return consumed;
+}
+
+quint32 RfidIngest::internPassenger(quint64 cardUid)
+{
+    QHash<quint64, quint32>::const_iterator it = m_passengerIds.constFind(cardUid);
+    if (it != m_passengerIds.constEnd()) return it.value();
+
+    quint32 id = static_cast<quint32>(m_cardUids.size());
+    m_cardUids.append(cardUid);
+    m_passengerIds.insert(cardUid, id);
+    return id;
+}
+
+QString RfidIngest::stationId(int station) const
+{
+    return m_engine->stationId(station);
+}
+
+void RfidIngest::ensureStation(int station)
+{
+    if (station < m_deltaEntries.size()) return;
+    const int size = station + 1;
+    m_stationEntries.resize(size);
+    m_stationExits.resize(size);
+    m_deltaEntries.resize(size);
+    m_deltaExits.resize(size);
+}
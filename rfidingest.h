@@ -0,0 +1,110 @@
+#ifndef RFIDINGEST_H
+#define RFIDINGEST_H
+
+#include <QThread>
+#include <QVector>
+#include <QHash>
+#include <QString>
+#include <QElapsedTimer>
+#include <atomic>
+#include "spscqueue.h"
+
+class StationOccupancyEngine;
+class RfidLogModel;
+
+// One gate event as produced by a reader. Kept small and trivially
+// copyable so the queue moves plain bytes.
+struct RfidTap
+{
+    qint64 timestampMs;
+    quint64 cardUid;
+    quint16 station;
+    quint8 direction;   // StationOccupancyEngine::TapDirection
+};
+
+typedef SpscQueue<RfidTap, 65536> RfidTapQueue;
+
+// Simulated fare-gate reader. Generates taps at a configurable rate on its
+// own thread and pushes them into the queue; taps that do not fit are
+// counted as dropped rather than blocking the reader. Between taps the
+// thread sleeps until the next one is due, waking at least every
+// MAX_SLEEP_MS to pick up rate changes and interruption.
+class RfidReaderThread : public QThread
+{
+public:
+    explicit RfidReaderThread(RfidTapQueue *queue, QObject *parent = nullptr);
+
+    void setTapsPerSecond(int rate) { m_tapsPerSecond.store(qMax(0, rate)); }
+    int tapsPerSecond() const { return m_tapsPerSecond.load(); }
+    // Multiplies the configured rate, e.g. down while the page is hidden;
+    // 0 pauses the reader
+    void setRateScale(double scale) { m_rateScale.store(qMax(0.0, scale)); }
+    void setStationSlots(int count) { m_stationSlots.store(qMax(0, count)); }
+    quint64 droppedTaps() const { return m_dropped.load(); }
+
+    static const int DEFAULT_TAPS_PER_SECOND = 20;
+    static const int COMMUTER_POOL = 200000;
+    static const int MAX_SLEEP_MS = 250;
+
+protected:
+    void run() override;
+
+private:
+    RfidTapQueue *m_queue;
+    std::atomic<int> m_tapsPerSecond;
+    std::atomic<double> m_rateScale;
+    std::atomic<int> m_stationSlots;
+    std::atomic<quint64> m_dropped;
+};
+
+// Consumer side of the tap pipeline, run on the UI thread at display rate.
+// Interns card UIDs to dense passenger ids, keeps per-station tap counters
+// and hands aggregated deltas to the occupancy engine once per drain.
+class RfidIngest
+{
+public:
+    explicit RfidIngest(StationOccupancyEngine *engine);
+
+    RfidTapQueue *queue() { return &m_queue; }
+
+    // Drains everything queued so far; returns the number of taps consumed
+    int drain(RfidLogModel *log);
+
+    // Passenger interning
+    quint32 internPassenger(quint64 cardUid);
+    quint64 cardUid(quint32 passenger) const { return m_cardUids.value(passenger); }
+    int passengerCount() const { return m_cardUids.size(); }
+
+    // Counters
+    QString stationId(int station) const;
+    quint64 stationEntries(int station) const { return m_stationEntries.value(station); }
+    quint64 stationExits(int station) const { return m_stationExits.value(station); }
+    quint64 totalTaps() const { return m_totalTaps; }
+    double tapsPerSecond() const { return m_tapRate; }
+
+    static const int DRAIN_BATCH = 4096;
+
+private:
+    void ensureStation(int station);
+
+    StationOccupancyEngine *m_engine;
+    RfidTapQueue m_queue;
+    QVector<RfidTap> m_batch;
+
+    // Passenger interning: card UID -> dense id and back
+    QHash<quint64, quint32> m_passengerIds;
+    QVector<quint64> m_cardUids;
+
+    // Per-station counters; deltas are reset after every drain
+    QVector<quint64> m_stationEntries;
+    QVector<quint64> m_stationExits;
+    QVector<int> m_deltaEntries;
+    QVector<int> m_deltaExits;
+
+    quint64 m_totalTaps;
+    quint64 m_rateWindowTaps;
+    QElapsedTimer m_rateClock;
+    double m_tapRate;
+};
+
+#endif // RFIDINGEST_H
@@ -0,0 +1,93 @@
+#include "rfidlogmodel.h"
+#include "rfidingest.h"
+#include "stationoccupancyengine.h"
+#include <QDateTime>
+#include <QColor>
+
+RfidLogModel::RfidLogModel(const RfidIngest *ingest, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_ingest(ingest)
+    , m_ring(CAPACITY)
+    , m_head(0)
+    , m_count(0)
+    , m_publishedRows(0)
+    , m_dirty(false)
+{
+}
+
+int RfidLogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_publishedRows;
+}
+
+int RfidLogModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 4;
+}
+
+QVariant RfidLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_publishedRows) return QVariant();
+
+    // Row 0 is the newest tap
+    int slot = (m_head - 1 - index.row() + CAPACITY) % CAPACITY;
+    const Entry &entry = m_ring[slot];
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case 0:
+            return QDateTime::fromMSecsSinceEpoch(entry.timestampMs).toString("hh:mm:ss.zzz");
+        case 1:
+            return QString("PASS-%1").arg(m_ingest->cardUid(entry.passenger) & 0xFFFFFF, 6, 16, QChar('0')).toUpper();
+        case 2:
+            return m_ingest->stationId(entry.station);
+        case 3:
+            return entry.direction == StationOccupancyEngine::Entry ? "In" : "Out";
+        }
+    } else if (role == Qt::ForegroundRole && index.column() == 3) {
+        return QColor(entry.direction == StationOccupancyEngine::Entry ? "#00C853" : "#FF9800");
+    }
+    return QVariant();
+}
+
+QVariant RfidLogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+
+    switch (section) {
+    case 0: return "Timestamp";
+    case 1: return "Passenger ID";
+    case 2: return "Station ID";
+    case 3: return "Gate";
+    }
+    return QVariant();
+}
+
+void RfidLogModel::append(qint64 timestampMs, quint32 passenger, quint16 station, quint8 direction)
+{
+    Entry &entry = m_ring[m_head];
+    entry.timestampMs = timestampMs;
+    entry.passenger = passenger;
+    entry.station = station;
+    entry.direction = direction;
+
+    m_head = (m_head + 1) % CAPACITY;
+    if (m_count < CAPACITY) ++m_count;
+    m_dirty = true;
+}
+
+void RfidLogModel::publish()
+{
+    if (!m_dirty) return;
+    m_dirty = false;
+
+    if (m_count != m_publishedRows) {
+        // Only while the ring is still filling up
+        beginResetModel();
+        m_publishedRows = m_count;
+        endResetModel();
+        return;
+    }
+
+    emit dataChanged(index(0, 0), index(m_publishedRows - 1, columnCount() - 1));
+}
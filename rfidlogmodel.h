@@ -0,0 +1,48 @@
+#ifndef RFIDLOGMODEL_H
+#define RFIDLOGMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+class RfidIngest;
+
+// Fixed-size ring of the most recent taps, newest first. append() only
+// writes into the ring; views are notified once per publish() so the cost
+// of a frame depends on the visible rows, not on how many taps arrived.
+class RfidLogModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit RfidLogModel(const RfidIngest *ingest, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    void append(qint64 timestampMs, quint32 passenger, quint16 station, quint8 direction);
+
+    // Notifies attached views if anything was appended since the last call
+    void publish();
+
+    static const int CAPACITY = 64;
+
+private:
+    struct Entry {
+        qint64 timestampMs;
+        quint32 passenger;
+        quint16 station;
+        quint8 direction;
+    };
+
+    const RfidIngest *m_ingest;
+    QVector<Entry> m_ring;
+    int m_head;         // next write slot
+    int m_count;        // filled slots
+    int m_publishedRows;
+    bool m_dirty;
+};
+
+#endif // RFIDLOGMODEL_H
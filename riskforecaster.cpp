@@ -0,0 +1,223 @@
+#include "riskforecaster.h"
+#include <QtMath>
+
+namespace {
+// Holt-Winters smoothing (level, trend, season) and trend damping
+const double ALPHA = 0.2;
+const double BETA = 0.02;
+const double GAMMA = 0.1;
+const double PHI = 0.98;
+
+// RLS forgetting factor, initial covariance and covariance ceiling
+const double LAMBDA = 0.99;
+const double P_INITIAL = 1000.0;
+const double P_MAX = 1e6;
+
+// Keeps sum |theta| below 1 so the residual forecast always decays
+const double AR_MAX_GAIN = 0.95;
+
+const double ERROR_ALPHA = 0.1;
+const double Z_95 = 1.96;
+}
+
+RiskForecaster::RiskForecaster()
+    : m_nowBucket(-1)
+{
+}
+
+void RiskForecaster::observe(int series, double value, qint64 timestampMs)
+{
+    if (series < 0) return;
+    if (series >= m_series.size()) m_series.resize(series + 1);
+
+    qint64 bucket = timestampMs / BUCKET_MS;
+    if (bucket > m_nowBucket) {
+        // Every forecast is relative to the open hour, so all of them shift
+        m_nowBucket = bucket;
+        for (int i = 0; i < m_series.size(); ++i) {
+            if (m_series[i].closedHours > 0) markDirty(m_series[i], i);
+        }
+    }
+
+    Series &s = m_series[series];
+    if (s.bucket < 0) s.bucket = bucket;
+    if (bucket < s.bucket) return;  // late sample for an hour already closed
+    if (bucket > s.bucket) {
+        closeBucket(s, series);
+        s.bucket = bucket;
+        s.bucketSum = 0.0;
+        s.bucketCount = 0;
+    }
+
+    s.bucketSum += value;
+    ++s.bucketCount;
+    if (s.closedHours == 0) markDirty(s, series);
+}
+
+void RiskForecaster::closeBucket(Series &s, int index)
+{
+    if (s.bucketCount == 0) return;
+    const double y = s.bucketSum / s.bucketCount;
+
+    // The first day seeds the level and the season profile
+    if (s.closedHours < SEASON_HOURS) {
+        if (s.closedHours == 0) {
+            for (int i = 0; i < AR_ORDER; ++i) s.p[i * AR_ORDER + i] = P_INITIAL;
+        } else {
+            double deviation = y - s.level;
+            s.errorVariance = (1.0 - ERROR_ALPHA) * s.errorVariance + ERROR_ALPHA * deviation * deviation;
+        }
+        ++s.closedHours;
+        s.level += (y - s.level) / s.closedHours;
+        s.season[s.bucket % SEASON_HOURS] = y;
+        s.seasonMask |= 1u << (s.bucket % SEASON_HOURS);
+        s.lastBucket = s.bucket;
+        if (s.closedHours == SEASON_HOURS) {
+            for (int i = 0; i < SEASON_HOURS; ++i) {
+                s.season[i] = (s.seasonMask & (1u << i)) ? s.season[i] - s.level : 0.0;
+            }
+        }
+        markDirty(s, index);
+        return;
+    }
+
+    // Hours without samples only carry the trend forward
+    for (qint64 gap = s.bucket - s.lastBucket; gap > 1; --gap) {
+        s.level += PHI * s.trend;
+        s.trend *= PHI;
+    }
+
+    const double seasonal = seasonAt(s, s.bucket);
+    const double predicted = s.level + PHI * s.trend + seasonal;
+    const double residual = y - predicted;
+
+    // One-step error of the combined model drives the bands
+    const double error = residual - arPredict(s.theta, s.residuals);
+    s.errorVariance = (1.0 - ERROR_ALPHA) * s.errorVariance + ERROR_ALPHA * error * error;
+
+    // RLS update of the AR model on the Holt-Winters residuals
+    double px[AR_ORDER];
+    double denominator = LAMBDA;
+    for (int i = 0; i < AR_ORDER; ++i) {
+        px[i] = 0.0;
+        for (int j = 0; j < AR_ORDER; ++j) px[i] += s.p[i * AR_ORDER + j] * s.residuals[j];
+        denominator += s.residuals[i] * px[i];
+    }
+    const double arError = residual - arPredict(s.theta, s.residuals);
+    double trace = 0.0;
+    for (int i = 0; i < AR_ORDER; ++i) trace += s.p[i * AR_ORDER + i];
+    // Forgetting is suspended while the inputs carry no information
+    const double scale = trace > P_MAX ? 1.0 : 1.0 / LAMBDA;
+    double gain = 0.0;
+    for (int i = 0; i < AR_ORDER; ++i) {
+        s.theta[i] += px[i] / denominator * arError;
+        gain += qAbs(s.theta[i]);
+        for (int j = 0; j < AR_ORDER; ++j) {
+            double &p = s.p[i * AR_ORDER + j];
+            p = (p - px[i] * px[j] / denominator) * scale;
+        }
+    }
+    if (gain > AR_MAX_GAIN) {
+        for (int i = 0; i < AR_ORDER; ++i) s.theta[i] *= AR_MAX_GAIN / gain;
+    }
+    for (int i = AR_ORDER - 1; i > 0; --i) s.residuals[i] = s.residuals[i - 1];
+    s.residuals[0] = residual;
+
+    // Holt-Winters update
+    const double level = ALPHA * (y - seasonal) + (1.0 - ALPHA) * (s.level + PHI * s.trend);
+    s.trend = BETA * (level - s.level) + (1.0 - BETA) * PHI * s.trend;
+    s.level = level;
+    s.season[s.bucket % SEASON_HOURS] = GAMMA * (y - level) + (1.0 - GAMMA) * seasonal;
+
+    s.lastBucket = s.bucket;
+    ++s.closedHours;
+    markDirty(s, index);
+}
+
+void RiskForecaster::markDirty(Series &s, int index)
+{
+    if (s.dirty) return;
+    s.dirty = true;
+    m_dirty.append(index);
+}
+
+double RiskForecaster::seasonAt(const Series &s, qint64 bucket) const
+{
+    return s.season[bucket % SEASON_HOURS];
+}
+
+double RiskForecaster::arPredict(const double *theta, const double *residuals) const
+{
+    double prediction = 0.0;
+    for (int i = 0; i < AR_ORDER; ++i) prediction += theta[i] * residuals[i];
+    return prediction;
+}
+
+double RiskForecaster::bandFactor(int steps) const
+{
+    // h-step variance multiplier of additive Holt's method
+    const double h = steps;
+    return 1.0 + (h - 1.0) * (ALPHA * ALPHA + ALPHA * BETA * h + BETA * BETA * h * (2.0 * h - 1.0) / 6.0);
+}
+
+RiskForecastPoint RiskForecaster::forecast(int series, int hoursAhead) const
+{
+    QVector<RiskForecastPoint> path;
+    forecastPath(series, hoursAhead, path);
+    return path.isEmpty() ? RiskForecastPoint{0.0, 0.0, 0.0} : path.last();
+}
+
+void RiskForecaster::forecastPath(int series, int hours, QVector<RiskForecastPoint> &out) const
+{
+    out.resize(qMax(0, hours + 1));
+    if (series < 0 || series >= m_series.size()) {
+        for (RiskForecastPoint &point : out) point = {0.0, 0.0, 0.0};
+        return;
+    }
+
+    const Series &s = m_series[series];
+    if (s.closedHours == 0) {
+        double mean = s.bucketCount > 0 ? s.bucketSum / s.bucketCount : 0.0;
+        for (RiskForecastPoint &point : out) point = {mean, mean, mean};
+        return;
+    }
+    if (s.closedHours < SEASON_HOURS) {
+        // No season yet: the mean so far, with the spread seen so far
+        double spread = Z_95 * qSqrt(s.errorVariance);
+        for (RiskForecastPoint &point : out) point = {s.level, qMax(0.0, s.level - spread), s.level + spread};
+        return;
+    }
+
+    // Hour 0 is the open hour, `offset` steps past the last closed one
+    const int offset = static_cast<int>(qMax<qint64>(1, m_nowBucket - s.lastBucket));
+    double history[AR_ORDER];
+    for (int i = 0; i < AR_ORDER; ++i) history[i] = s.residuals[i];
+
+    double phiPower = 1.0;
+    double trendSum = 0.0;
+    for (int step = 1; step <= offset + hours; ++step) {
+        phiPower *= PHI;
+        trendSum += phiPower;
+
+        double residual = arPredict(s.theta, history);
+        for (int i = AR_ORDER - 1; i > 0; --i) history[i] = history[i - 1];
+        history[0] = residual;
+
+        if (step < offset) continue;
+        double mean = s.level + trendSum * s.trend + seasonAt(s, s.lastBucket + step) + residual;
+        mean = qMax(0.0, mean);
+        double spread = Z_95 * qSqrt(s.errorVariance * bandFactor(step));
+        out[step - offset] = {mean, qMax(0.0, mean - spread), mean + spread};
+    }
+}
+
+int RiskForecaster::takeDirty(QVector<int> &out)
+{
+    int count = m_dirty.size();
+    for (int index : m_dirty) {
+        m_series[index].dirty = false;
+        out.append(index);
+    }
+    m_dirty.clear();
+    return count;
+}
@@ -0,0 +1,92 @@
+#ifndef RISKFORECASTER_H
+#define RISKFORECASTER_H
+
+#include <QVector>
+
+// One forecast value with its 95% band
+struct RiskForecastPoint
+{
+    double mean;
+    double lower;
+    double upper;
+};
+
+// Frame handed from the forecast thread to the UI
+struct RiskForecastSnapshot
+{
+    // Hours 0..HORIZON_HOURS ahead for the city series
+    QVector<RiskForecastPoint> cityPath;
+    // [series * HORIZON_COUNT + h] for the 24/48/72 h horizons
+    QVector<RiskForecastPoint> horizons;
+    int seriesCount = 0;
+    int refitSeries = 0;      // series re-forecast for this frame
+    qint64 refitMicros = 0;
+};
+
+// Incremental risk forecaster for many hourly series. Samples are averaged
+// into hourly buckets; each closed hour updates an additive Holt-Winters
+// model (damped trend, 24-hour season) and an AR(AR_ORDER) model of its
+// one-step residuals fitted by recursive least squares. Both are O(1) per
+// hour, so nothing is ever refitted from history, and only series whose
+// state changed need a new forecast. Bands come from the EWMA of one-step
+// errors, widened with the horizon. The first day only seeds the level and
+// season profile; until then a series forecasts its running mean.
+class RiskForecaster
+{
+public:
+    RiskForecaster();
+
+    // Series are created on first use
+    void observe(int series, double value, qint64 timestampMs);
+    int seriesCount() const { return m_series.size(); }
+
+    // Hours ahead of the current (open) hour
+    RiskForecastPoint forecast(int series, int hoursAhead) const;
+    void forecastPath(int series, int hours, QVector<RiskForecastPoint> &out) const;
+
+    // Series whose forecast moved since the last call
+    int takeDirty(QVector<int> &out);
+
+    static const int SEASON_HOURS = 24;
+    static const int AR_ORDER = 3;
+    static const int HORIZON_HOURS = 72;
+    static const int HORIZON_COUNT = 3;     // 24, 48 and 72 h
+    static constexpr qint64 BUCKET_MS = 3600 * 1000;
+
+private:
+    struct Series
+    {
+        // Open hour
+        qint64 bucket = -1;
+        double bucketSum = 0.0;
+        int bucketCount = 0;
+
+        // Holt-Winters state as of the last closed hour
+        qint64 lastBucket = -1;
+        double level = 0.0;
+        double trend = 0.0;
+        double season[SEASON_HOURS] = {};
+        quint32 seasonMask = 0;            // hours seen during the first day
+        quint32 closedHours = 0;
+
+        // AR residual model (RLS)
+        double theta[AR_ORDER] = {};
+        double p[AR_ORDER * AR_ORDER] = {};
+        double residuals[AR_ORDER] = {};   // most recent first
+
+        double errorVariance = 0.0;
+        bool dirty = false;
+    };
+
+    void closeBucket(Series &s, int index);
+    void markDirty(Series &s, int index);
+    double seasonAt(const Series &s, qint64 bucket) const;
+    double arPredict(const double *theta, const double *residuals) const;
+    double bandFactor(int steps) const;
+
+    QVector<Series> m_series;
+    QVector<int> m_dirty;
+    qint64 m_nowBucket;
+};
+
+#endif // RISKFORECASTER_H
@@ -0,0 +1,363 @@
+#include "routeoptimizer.h"
+#include <QElapsedTimer>
+#include <QPair>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// A pair of stops and what serving them on one trip saves over two
+struct Saving
+{
+    double value;
+    int i;
+    int j;
+};
+
+// Improvement passes stop after this many sweeps even if moves remain
+const int MAX_IMPROVEMENT_PASSES = 50;
+const double EPSILON = 1e-6;
+
+// Node 0 is the depot, stop s is node s + 1
+class Solver
+{
+public:
+    explicit Solver(const RoutePlanRequest &request)
+    {
+        const int stops = request.stops.size();
+        m_x.resize(stops + 1);
+        m_y.resize(stops + 1);
+        m_demand.resize(stops + 1);
+        m_x[0] = 0.0;
+        m_y[0] = 0.0;
+        m_demand[0] = 0.0;
+        for (int s = 0; s < stops; ++s) {
+            m_x[s + 1] = request.stops[s].x;
+            m_y[s + 1] = request.stops[s].y;
+            m_demand[s + 1] = request.stops[s].demandKg;
+        }
+    }
+
+    int nodeCount() const { return m_x.size(); }
+    double demand(int node) const { return m_demand[node]; }
+
+    double distance(int a, int b) const
+    {
+        double dx = m_x[a] - m_x[b];
+        double dy = m_y[a] - m_y[b];
+        return std::sqrt(dx * dx + dy * dy) * RouteOptimizer::ROAD_DETOUR;
+    }
+
+    double tourLength(const QVector<int> &tour) const
+    {
+        double length = 0.0;
+        for (int i = 0; i + 1 < tour.size(); ++i) length += distance(tour[i], tour[i + 1]);
+        return length;
+    }
+
+    // Nearest stops of each routable stop, through a uniform grid
+    void nearestNeighbours(const QVector<int> &nodes, int k, QVector<QVector<int>> &out) const;
+    void savings(const QVector<int> &nodes, QVector<Saving> &out) const;
+
+    bool twoOpt(QVector<int> &tour) const;
+    bool orOpt(QVector<int> &tour) const;
+
+private:
+    QVector<double> m_x;
+    QVector<double> m_y;
+    QVector<double> m_demand;
+};
+
+void Solver::nearestNeighbours(const QVector<int> &nodes, int k, QVector<QVector<int>> &out) const
+{
+    out.resize(nodeCount());
+    if (nodes.size() <= 1) return;
+    k = qMin(k, nodes.size() - 1);
+
+    double minX = m_x[nodes[0]], maxX = minX, minY = m_y[nodes[0]], maxY = minY;
+    for (int node : nodes) {
+        minX = qMin(minX, m_x[node]);
+        maxX = qMax(maxX, m_x[node]);
+        minY = qMin(minY, m_y[node]);
+        maxY = qMax(maxY, m_y[node]);
+    }
+
+    // About two stops per cell
+    const double area = qMax(1.0, (maxX - minX) * (maxY - minY));
+    const double cell = qMax(1.0, std::sqrt(2.0 * area / nodes.size()));
+    const int columns = qMax(1, static_cast<int>((maxX - minX) / cell) + 1);
+    const int rows = qMax(1, static_cast<int>((maxY - minY) / cell) + 1);
+
+    // Counting sort of nodes into cells
+    QVector<int> cellOf(nodes.size());
+    QVector<int> cellStart(columns * rows + 1, 0);
+    for (int n = 0; n < nodes.size(); ++n) {
+        int cx = qMin(columns - 1, static_cast<int>((m_x[nodes[n]] - minX) / cell));
+        int cy = qMin(rows - 1, static_cast<int>((m_y[nodes[n]] - minY) / cell));
+        cellOf[n] = cy * columns + cx;
+        ++cellStart[cellOf[n] + 1];
+    }
+    for (int c = 0; c < columns * rows; ++c) cellStart[c + 1] += cellStart[c];
+    QVector<int> cellNodes(nodes.size());
+    QVector<int> fill = cellStart;
+    for (int n = 0; n < nodes.size(); ++n) cellNodes[fill[cellOf[n]]++] = nodes[n];
+
+    QVector<QPair<double, int>> candidates;
+    for (int n = 0; n < nodes.size(); ++n) {
+        const int node = nodes[n];
+        const int cx = cellOf[n] % columns;
+        const int cy = cellOf[n] / columns;
+        candidates.clear();
+
+        // Grow rings of cells until the k-th nearest is provably inside
+        for (int ring = 0; ; ++ring) {
+            for (int y = cy - ring; y <= cy + ring; ++y) {
+                if (y < 0 || y >= rows) continue;
+                for (int x = cx - ring; x <= cx + ring; ++x) {
+                    if (x < 0 || x >= columns) continue;
+                    if (qAbs(x - cx) != ring && qAbs(y - cy) != ring) continue;
+                    const int c = y * columns + x;
+                    for (int i = cellStart[c]; i < cellStart[c + 1]; ++i) {
+                        int other = cellNodes[i];
+                        if (other != node) candidates.append(qMakePair(distance(node, other), other));
+                    }
+                }
+            }
+            const bool coveredAll = ring >= columns && ring >= rows;
+            if (candidates.size() >= k) {
+                std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end());
+                if (coveredAll || candidates[k - 1].first <= ring * cell * RouteOptimizer::ROAD_DETOUR) break;
+            } else if (coveredAll) {
+                break;
+            }
+        }
+
+        QVector<int> &neighbours = out[node];
+        neighbours.clear();
+        for (int i = 0; i < qMin(k, candidates.size()); ++i) neighbours.append(candidates[i].second);
+    }
+}
+
+void Solver::savings(const QVector<int> &nodes, QVector<Saving> &out) const
+{
+    QVector<QVector<int>> neighbours;
+    nearestNeighbours(nodes, RouteOptimizer::NEIGHBOURS, neighbours);
+
+    out.clear();
+    for (int i : nodes) {
+        for (int j : neighbours[i]) {
+            // Each unordered pair once; a pair listed from both sides is harmless
+            if (j < i && neighbours[j].contains(i)) continue;
+            double value = distance(0, i) + distance(0, j) - distance(i, j);
+            if (value > EPSILON) out.append({value, i, j});
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Saving &a, const Saving &b) {
+        return a.value > b.value;
+    });
+}
+
+bool Solver::twoOpt(QVector<int> &tour) const
+{
+    // Tours start and end at the depot; reverse tour[i..k] when that shortens it
+    bool improved = false;
+    const int last = tour.size() - 2;
+    for (int i = 1; i < last; ++i) {
+        for (int k = i + 1; k <= last; ++k) {
+            double delta = distance(tour[i - 1], tour[k]) + distance(tour[i], tour[k + 1])
+                    - distance(tour[i - 1], tour[i]) - distance(tour[k], tour[k + 1]);
+            if (delta < -EPSILON) {
+                std::reverse(tour.begin() + i, tour.begin() + k + 1);
+                improved = true;
+            }
+        }
+    }
+    return improved;
+}
+
+bool Solver::orOpt(QVector<int> &tour) const
+{
+    // Move runs of 3, 2 or 1 stops to a better place, either way round
+    bool improved = false;
+    for (int length = 3; length >= 1; --length) {
+        for (int i = 1; i + length < tour.size(); ++i) {
+            const int first = tour[i];
+            const int lastNode = tour[i + length - 1];
+            const int before = tour[i - 1];
+            const int after = tour[i + length];
+            const double removeGain = distance(before, first) + distance(lastNode, after) - distance(before, after);
+
+            int bestEdge = -1;
+            bool bestReversed = false;
+            double bestCost = removeGain - EPSILON;
+            for (int j = 0; j + 1 < tour.size(); ++j) {
+                if (j >= i - 1 && j <= i + length - 1) continue;
+                const int a = tour[j];
+                const int b = tour[j + 1];
+                const double base = distance(a, b);
+                double forward = distance(a, first) + distance(lastNode, b) - base;
+                double reversed = distance(a, lastNode) + distance(first, b) - base;
+                if (forward < bestCost) {
+                    bestCost = forward;
+                    bestEdge = j;
+                    bestReversed = false;
+                }
+                if (reversed < bestCost) {
+                    bestCost = reversed;
+                    bestEdge = j;
+                    bestReversed = true;
+                }
+            }
+            if (bestEdge < 0) continue;
+
+            QVector<int> segment = tour.mid(i, length);
+            if (bestReversed) std::reverse(segment.begin(), segment.end());
+            tour.remove(i, length);
+            int insertAt = bestEdge < i ? bestEdge + 1 : bestEdge + 1 - length;
+            for (int s = 0; s < segment.size(); ++s) tour.insert(insertAt + s, segment[s]);
+            improved = true;
+        }
+    }
+    return improved;
+}
+}
+
+RouteOptimizer::RouteOptimizer(QObject *parent)
+    : QThread(parent)
+{
+}
+
+RouteOptimizer::~RouteOptimizer()
+{
+    wait();
+}
+
+bool RouteOptimizer::planRoutes(const RoutePlanRequest &request)
+{
+    if (isRunning()) return false;
+    m_request = request;
+    m_plan = RoutePlan();
+    start();
+    return true;
+}
+
+void RouteOptimizer::run()
+{
+    m_plan = solve(m_request);
+}
+
+RoutePlan RouteOptimizer::solve(const RoutePlanRequest &request)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    RoutePlan plan;
+    double maxCapacity = 0.0;
+    for (double capacity : request.truckCapacitiesKg) maxCapacity = qMax(maxCapacity, capacity);
+    if (maxCapacity <= 0.0) return plan;
+
+    Solver solver(request);
+    const int nodes = solver.nodeCount();
+
+    // Every stop starts on its own trip
+    QVector<int> routable;
+    QVector<QVector<int>> routes(nodes);
+    QVector<double> load(nodes, 0.0);
+    QVector<int> routeOf(nodes, -1);
+    for (int node = 1; node < nodes; ++node) {
+        if (solver.demand(node) > maxCapacity) {
+            plan.unrouted.append(node - 1);
+            continue;
+        }
+        routable.append(node);
+        routes[node].append(node);
+        load[node] = solver.demand(node);
+        routeOf[node] = node;
+    }
+
+    // Clarke-Wright: join trips end to end, best saving first
+    QVector<Saving> savings;
+    solver.savings(routable, savings);
+    for (const Saving &saving : savings) {
+        int ri = routeOf[saving.i];
+        int rj = routeOf[saving.j];
+        if (ri == rj || load[ri] + load[rj] > maxCapacity) continue;
+
+        QVector<int> &a = routes[ri];
+        QVector<int> &b = routes[rj];
+        const bool iEnd = a.last() == saving.i;
+        const bool jStart = b.first() == saving.j;
+        if (!iEnd && a.first() != saving.i) continue;
+        if (!jStart && b.last() != saving.j) continue;
+
+        // Orient as a ... i, j ... b and fold the shorter trip into the longer
+        if (!iEnd) std::reverse(a.begin(), a.end());
+        if (!jStart) std::reverse(b.begin(), b.end());
+        if (a.size() >= b.size()) {
+            for (int node : b) routeOf[node] = ri;
+            a.append(b);
+            load[ri] += load[rj];
+            b.clear();
+        } else {
+            for (int node : a) routeOf[node] = rj;
+            QVector<int> merged = a;
+            merged.append(b);
+            b.swap(merged);
+            load[rj] += load[ri];
+            a.clear();
+        }
+    }
+
+    // Polish each trip and hand it to a truck
+    QVector<VehicleRoute> finished;
+    for (int r = 1; r < nodes; ++r) {
+        if (routes[r].isEmpty()) continue;
+
+        QVector<int> tour;
+        tour.reserve(routes[r].size() + 2);
+        tour.append(0);
+        tour.append(routes[r]);
+        tour.append(0);
+        plan.savingsDistanceMetres += solver.tourLength(tour);
+
+        for (int pass = 0; pass < MAX_IMPROVEMENT_PASSES; ++pass) {
+            bool improved = solver.twoOpt(tour);
+            improved = solver.orOpt(tour) || improved;
+            if (!improved) break;
+        }
+
+        VehicleRoute route;
+        route.truck = -1;
+        route.trip = 0;
+        for (int i = 1; i + 1 < tour.size(); ++i) route.stops.append(tour[i] - 1);
+        route.loadKg = load[r];
+        route.distanceMetres = solver.tourLength(tour);
+        plan.totalDistanceMetres += route.distanceMetres;
+        finished.append(route);
+    }
+
+    // Heaviest trips first, each to the least-driven truck that can carry it
+    std::sort(finished.begin(), finished.end(), [](const VehicleRoute &a, const VehicleRoute &b) {
+        return a.loadKg > b.loadKg;
+    });
+    const int trucks = request.truckCapacitiesKg.size();
+    QVector<double> driven(trucks, 0.0);
+    QVector<int> trips(trucks, 0);
+    for (VehicleRoute &route : finished) {
+        int best = -1;
+        for (int t = 0; t < trucks; ++t) {
+            if (request.truckCapacitiesKg[t] < route.loadKg) continue;
+            if (best < 0 || driven[t] < driven[best]) best = t;
+        }
+        route.truck = best;
+        route.trip = ++trips[best];
+        driven[best] += route.distanceMetres;
+    }
+    std::sort(finished.begin(), finished.end(), [](const VehicleRoute &a, const VehicleRoute &b) {
+        return a.truck != b.truck ? a.truck < b.truck : a.trip < b.trip;
+    });
+
+    plan.routes = finished;
+    plan.planMs = timer.elapsed();
+    plan.valid = true;
+    return plan;
+}
@@ -0,0 +1,79 @@
+#ifndef ROUTEOPTIMIZER_H
+#define ROUTEOPTIMIZER_H
+
+#include <QThread>
+#include <QString>
+#include <QVector>
+
+// A bin to collect
+struct RouteStop
+{
+    QString id;
+    double x;                // metres from the depot
+    double y;
+    double demandKg;
+};
+
+struct RoutePlanRequest
+{
+    QVector<RouteStop> stops;
+    QVector<double> truckCapacitiesKg;
+};
+
+// One depot-to-depot trip
+struct VehicleRoute
+{
+    int truck;
+    int trip;                // 1 = first trip of that truck
+    QVector<int> stops;      // indices into the request's stops, in order
+    double loadKg;
+    double distanceMetres;
+};
+
+struct RoutePlan
+{
+    QVector<VehicleRoute> routes;
+    QVector<int> unrouted;   // stops heavier than every truck
+    double totalDistanceMetres = 0.0;
+    double savingsDistanceMetres = 0.0;   // before 2-opt / Or-opt
+    qint64 planMs = 0;
+    bool valid = false;
+};
+
+// Plans collection rounds from the depot on a worker thread. Routes are
+// built with Clarke-Wright savings (merging up to the largest truck's
+// capacity) and each is then polished with 2-opt and Or-opt moves; the
+// finished routes go to the trucks largest load first, each to the truck
+// with the least driving so far that can carry it, so a small fleet makes
+// several trips. There is no road graph, so distances are straight lines
+// stretched by ROAD_DETOUR and computed on the fly rather than held in an
+// n x n matrix; savings are only considered between each stop and its
+// NEIGHBOURS nearest stops, found through a uniform grid, which keeps
+// thousands of stops to a fraction of a second.
+class RouteOptimizer : public QThread
+{
+public:
+    explicit RouteOptimizer(QObject *parent = nullptr);
+    ~RouteOptimizer();
+
+    // GUI thread; false while the previous plan is still running
+    bool planRoutes(const RoutePlanRequest &request);
+    // GUI thread, once finished() has fired
+    RoutePlan plan() const { return m_plan; }
+    const RoutePlanRequest &request() const { return m_request; }
+
+    // Pure, safe on any thread
+    static RoutePlan solve(const RoutePlanRequest &request);
+
+    static constexpr double ROAD_DETOUR = 1.3;
+    static const int NEIGHBOURS = 24;
+
+protected:
+    void run() override;
+
+private:
+    RoutePlanRequest m_request;
+    RoutePlan m_plan;
+};
+
+#endif // ROUTEOPTIMIZER_H
@@ -1,4 +1,9 @@
 #include "securityintelligencecenter.h"
+#include "simulationthread.h"
+#include "uiupdatescheduler.h"
+#include "metricsregistry.h"
+#include "tickdriver.h"
+#include "tracer.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -12,14 +17,17 @@
 #include <QtCharts/QChartView>
 #include <QtCharts/QValueAxis>
 
-SecurityIntelligenceCenter::SecurityIntelligenceCenter(QWidget *parent)
+SecurityIntelligenceCenter::SecurityIntelligenceCenter(SimulationThread *simulation, ActionExecutor *actions,
+                                                       QWidget *parent)
     : QWidget(parent)
-    , m_currentStabilityScore(85)
+    , m_currentStabilityScore(CityStabilityModel::instance()->cityScore())
     , m_simulationMode(false)
-    , m_wasteRisk(10)
-    , m_safetyRisk(15)
-    , m_energyRisk(8)
-    , m_cyberThreatLevel(5)
+    , m_simulation(simulation)
+    , m_actions(actions)
+    , m_busSensor(CityEventBus::instance()->sensorId("CITY-EVENT-BUS"))
+    , m_batchCount(0)
+    , m_stability(CityStabilityModel::instance())
+    , m_recommendationCandidate(-1)
 {
     setupUI();
     applyStyles();
@@ -29,17 +37,42 @@ SecurityIntelligenceCenter::SecurityIntelligenceCenter(QWidget *parent)
         m_riskHistory.append(15.0 + (QRandomGenerator::global()->bounded(10)));
     }
     
-    // Setup auto-update timer
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer, &QTimer::timeout, this, &SecurityIntelligenceCenter::updateRiskMetrics);
-    m_updateTimer->start(5000); // Update every 5 seconds
+    // Auto-update tick
+    TickDriver::instance()->add("Security", 5000, this, [this]() { updateRiskMetrics(); });
+    
+    // Threat rules and anomaly detection run over the event bus in 250 ms batches
+    loadThreatRules();
+    m_anomalyDetector.watchKind(EVENT_GAS_LEVEL, false);
+    m_anomalyDetector.watchKind(EVENT_SMOKE_LEVEL, false);
+    m_anomalyDetector.watchKind(EVENT_BIN_DEPOSIT, false);
+    m_anomalyDetector.watchKind(EVENT_POLE_POWER, true);
+    m_anomalyDetector.watchKind(EVENT_STATION_TAPS, true);
+    
+    // Which health row each kind of report counts toward; only pole
+    // heartbeats are expected on a schedule
+    for (int k = 0; k < EVENT_KIND_COUNT; ++k) {
+        m_kindHealthRow[k] = -1;
+        m_kindTimeoutMs[k] = 0;
+    }
+    m_kindHealthRow[EVENT_BIN_DEPOSIT] = HEALTH_RECYCLING;
+    m_kindHealthRow[EVENT_SPEED_READING] = HEALTH_PEDESTRIAN;
+    m_kindHealthRow[EVENT_HEARTBEAT] = HEALTH_LIGHTING;
+    m_kindTimeoutMs[EVENT_HEARTBEAT] = 10000;
+    m_kindHealthRow[EVENT_AUTH_FAILURE] = HEALTH_AUTHENTICATION;
+    
+    TickDriver::instance()->add("Threat rules", 250, this, [this]() { processEventBatch(); });
     
     // Initial log entries
     addLogEntry("INFO", "Security Intelligence Center initialized");
     addLogEntry("INFO", "All systems operational");
     addLogEntry("INFO", "Monitoring 6 city infrastructure modules");
+    addLogEntry("INFO", QString("%1 threat detection rules armed").arg(m_ruleEngine.ruleCount()));
     
-    // Generate initial recommendation
+    // Recommendations follow the engine's ranking
+    connect(RecommendationEngine::instance(), &RecommendationEngine::recommendationsChanged,
+            this, &SecurityIntelligenceCenter::generateStrategicRecommendation);
+    connect(m_actions, &ActionExecutor::commandApplied, this, &SecurityIntelligenceCenter::onActionApplied);
+    connect(m_actions, &ActionExecutor::commandCompleted, this, &SecurityIntelligenceCenter::onActionCompleted);
     generateStrategicRecommendation();
 }
 
@@ -105,7 +138,7 @@ void SecurityIntelligenceCenter::createSystemHealthPanel()
     title->setStyleSheet("font-size: 16px; font-weight: bold; color: #1E90FF; padding: 5px;");
     layout->addWidget(title);
     
-    m_systemHealthTable = new QTableWidget(6, 4);
+    m_systemHealthTable = new QTableWidget(HEALTH_ROW_COUNT, 4);
     m_systemHealthTable->setStyleSheet(getTableStyle());
     m_systemHealthTable->setHorizontalHeaderLabels({"Module", "Operational Status", "Last Signal", "Risk Level"});
     m_systemHealthTable->horizontalHeader()->setStretchLastSection(true);
@@ -125,7 +158,8 @@ void SecurityIntelligenceCenter::createSystemHealthPanel()
     QStringList signalTimes = {"2s ago", "1s ago", "3s ago", "10s ago", "1s ago", "2s ago"};
     QStringList risks = {"Low", "Medium", "Low", "Medium", "Low", "Low"};
     
-    for (int i = 0; i < 6; ++i) {
+    for (int i = 0; i < HEALTH_ROW_COUNT; ++i) {
+        m_liveness.addModule(modules[i]);
         m_systemHealthTable->setItem(i, 0, new QTableWidgetItem(modules[i]));
         
         QTableWidgetItem *statusItem = new QTableWidgetItem(statuses[i]);
@@ -671,7 +705,20 @@ void SecurityIntelligenceCenter::addLogEntry(const QString &level, const QString
     QString logLine = QString("<span style='color: %1;'>[%2] %3 - %4</span>")
         .arg(colorCode).arg(level).arg(timestamp).arg(message);
     
-    m_securityLog->appendHtml(logLine);
+    // Lines reach the log together on the next UI frame; a hidden page
+    // keeps only the newest LOG_BACKLOG_LINES
+    m_pendingLogLines.append(logLine);
+    if (m_pendingLogLines.size() > LOG_BACKLOG_LINES) m_pendingLogLines.removeFirst();
+    UiUpdateScheduler::instance()->post(this, REGION_LOG, UiUpdateScheduler::Low, [this]() { flushLog(); });
+}
+
+void SecurityIntelligenceCenter::flushLog()
+{
+    SCOPED_LATENCY("log_update_us", "Security");
+    for (const QString &line : m_pendingLogLines) {
+        m_securityLog->appendHtml(line);
+    }
+    m_pendingLogLines.clear();
     
     // Auto-scroll to bottom
     QScrollBar *scrollBar = m_securityLog->verticalScrollBar();
@@ -679,7 +726,8 @@ void SecurityIntelligenceCenter::addLogEntry(const QString &level, const QString
 }
 
 void SecurityIntelligenceCenter::addThreatAlert(const QString &type, const QString &module, 
-                                                const QString &severity, const QString &timestamp)
+                                                const QString &severity, const QString &timestamp,
+                                                double score)
 {
     int row = m_threatDetectionTable->rowCount();
     m_threatDetectionTable->insertRow(row);
@@ -704,12 +752,24 @@ void SecurityIntelligenceCenter::addThreatAlert(const QString &type, const QStri
     
     // Emit signal
     int severityLevel = (severity == "CRITICAL") ? 3 : (severity == "WARNING") ? 2 : 1;
-    emit threatDetected(module, severityLevel);
+    emit threatDetected(module, severityLevel, score);
 }
 
 void SecurityIntelligenceCenter::updateCityStabilityScore(int score)
 {
     m_currentStabilityScore = qBound(0, score, 100);
+    
+    // Add to history
+    addRiskDataPoint(100.0 - m_currentStabilityScore);
+    
+    UiUpdateScheduler::instance()->post(this, REGION_STABILITY, UiUpdateScheduler::Urgent, [this]() {
+        showCityStabilityScore();
+    });
+    emit riskUpdated(m_currentStabilityScore);
+}
+
+void SecurityIntelligenceCenter::showCityStabilityScore()
+{
     m_stabilityScoreLabel->setText(QString::number(m_currentStabilityScore));
     m_stabilityBar->setValue(m_currentStabilityScore);
     
@@ -741,11 +801,6 @@ void SecurityIntelligenceCenter::updateCityStabilityScore(int score)
         "   border-radius: 3px;"
         "}").arg(color)
     );
-    
-    // Add to history
-    addRiskDataPoint(100.0 - m_currentStabilityScore);
-    
-    emit riskUpdated(m_currentStabilityScore);
 }
 
 void SecurityIntelligenceCenter::addRiskDataPoint(double value)
@@ -753,42 +808,36 @@ void SecurityIntelligenceCenter::addRiskDataPoint(double value)
     m_riskHistory.removeFirst();
     m_riskHistory.append(value);
     
-    m_riskSeries->clear();
-    for (int i = 0; i < m_riskHistory.size(); ++i) {
-        m_riskSeries->append(i, m_riskHistory[i]);
-    }
-}
-
-int SecurityIntelligenceCenter::calculateCityStability()
-{
-    double score = 100.0;
-    score -= (m_wasteRisk * 0.3);
-    score -= (m_safetyRisk * 0.4);
-    score -= (m_energyRisk * 0.3);
-    score -= (m_cyberThreatLevel * 0.5);
-    
-    return qBound(0, static_cast<int>(score), 100);
+    UiUpdateScheduler::instance()->post(this, REGION_RISK_CHART, UiUpdateScheduler::Low, [this]() {
+        SCOPED_LATENCY("chart_update_us", "Security");
+        TRACE_SCOPE("SecurityIntelligenceCenter risk chart");
+        // Replace the points in one call so the chart redraws once
+        QList<QPointF> points;
+        for (int i = 0; i < m_riskHistory.size(); ++i) {
+            points.append(QPointF(i, m_riskHistory[i]));
+        }
+        m_riskSeries->replace(points);
+    });
 }
 
 void SecurityIntelligenceCenter::generateStrategicRecommendation()
 {
-    QStringList recommendations = {
-        "Increase monitoring frequency for waste collection points in Zone A to prevent overflow incidents.",
-        "Deploy additional pedestrian safety monitoring at high-traffic intersections during peak hours.",
-        "Optimize lighting schedule to reduce energy consumption while maintaining safety standards.",
-        "Implement enhanced authentication protocols for critical infrastructure access points.",
-        "Schedule preventive maintenance for communication nodes showing intermittent connectivity.",
-        "Activate backup power systems for smart lighting network to ensure continuous operation."
-    };
-    
-    QStringList types = {"Preventive", "Operational", "Strategic"};
-    QStringList priorities = {"Low", "Medium", "High"};
-    
-    int idx = QRandomGenerator::global()->bounded(recommendations.size());
-    m_recommendationLabel->setText(recommendations[idx]);
-    
-    QString type = types[QRandomGenerator::global()->bounded(types.size())];
-    QString priority = priorities[QRandomGenerator::global()->bounded(priorities.size())];
+    Recommendation recommendation;
+    QString text;
+    QString type = "Preventive";
+    QString priority = "Low";
+    if (RecommendationEngine::instance()->best(recommendation)) {
+        m_recommendationCandidate = recommendation.candidate;
+        m_recommendation = recommendation;
+        text = QString("%1 - predicted to remove %2 stability risk points over the next 24 hours.")
+               .arg(recommendation.text).arg(recommendation.reduction, 0, 'f', 1);
+        type = RecommendationEngine::actionType(recommendation.action);
+        priority = recommendation.impact;
+    } else {
+        m_recommendationCandidate = -1;
+        text = "All zones are at baseline risk. Continue routine monitoring.";
+    }
+    m_recommendationLabel->setText(text);
     
     m_recommendationTypeLabel->setText("Type: " + type);
     m_priorityLabel->setText("Priority: " + priority);
@@ -801,66 +850,47 @@ void SecurityIntelligenceCenter::generateStrategicRecommendation()
     m_recommendationTypeLabel->setStyleSheet(QString("color: %1; font-weight: bold;").arg(typeColor));
     m_priorityLabel->setStyleSheet(QString("color: %1; font-weight: bold;").arg(priorityColor));
     
-    emit recommendationGenerated(recommendations[idx]);
+    emit recommendationGenerated(text);
 }
 
 // Slot implementations
+// Scenario slots inject telemetry; the threat rules raise the alerts
 void SecurityIntelligenceCenter::onSimulateSpeedViolation()
 {
-    addLogEntry("WARNING", "Speed violation detected at Crosswalk 3 - Vehicle: 85 km/h in 50 km/h zone");
-    addThreatAlert("Speed Data Anomaly", "Pedestrian Safety", "WARNING", 
-                   QDateTime::currentDateTime().toString("HH:mm:ss"));
-    
-    m_safetyRisk += 10;
-    updateCityStabilityScore(calculateCityStability());
-    generatePrediction();
+    addLogEntry("INFO", "Scenario: Crosswalk 3 radar reports 85 km/h in 50 km/h zone");
+    CityEventBus *bus = CityEventBus::instance();
+    bus->publish(EVENT_SPEED_READING, bus->sensorId("CW-003"), 85);
 }
 
 void SecurityIntelligenceCenter::onSimulateWasteOverload()
 {
-    addLogEntry("CRITICAL", "Bin 8 overflow detected - Capacity exceeded by 35%");
-    addThreatAlert("Waste Overload", "Recycling Infrastructure", "CRITICAL", 
-                   QDateTime::currentDateTime().toString("HH:mm:ss"));
-    
-    m_wasteRisk += 15;
-    updateCityStabilityScore(calculateCityStability());
-    generatePrediction();
+    addLogEntry("INFO", "Scenario: Bin 8 reports a deposit 35% over capacity");
+    CityEventBus *bus = CityEventBus::instance();
+    bus->publish(EVENT_BIN_DEPOSIT, bus->sensorId("BIN-008"), RecyclingModel::BIN_CAPACITY_KG * 1.35);
 }
 
 void SecurityIntelligenceCenter::onSimulateLightingFailure()
 {
-    addLogEntry("CRITICAL", "Lighting Pole 7 communication lost - Potential hardware failure");
-    addThreatAlert("Sensor Offline", "Smart Lighting", "CRITICAL", 
-                   QDateTime::currentDateTime().toString("HH:mm:ss"));
-    
-    m_energyRisk += 12;
-    updateSystemHealth("Smart Lighting Network", "⚠ Warning", "High");
-    updateCityStabilityScore(calculateCityStability());
-    generatePrediction();
+    addLogEntry("INFO", "Scenario: Lighting Pole 7 hardware failure - heartbeat stops");
+    // POLE-007 stops reporting; the liveness tracker expires it after its timeout
+    m_simulation->post([](RecyclingModel &, LightingModel &lighting) {
+        lighting.setPoleFailed(6);
+    });
 }
 
 void SecurityIntelligenceCenter::onSimulateCyberAttack()
 {
-    addLogEntry("CRITICAL", "Suspicious login attempt detected from unknown IP - Potential intrusion");
-    addThreatAlert("Unauthorized Access Attempt", "Authentication System", "CRITICAL", 
-                   QDateTime::currentDateTime().toString("HH:mm:ss"));
-    
-    m_cyberThreatLevel += 20;
-    updateSystemHealth("Authentication System", "⛔ Critical", "High");
-    updateCityStabilityScore(calculateCityStability());
-    generatePrediction();
+    addLogEntry("INFO", "Scenario: burst of failed logins from unknown IP");
+    CityEventBus *bus = CityEventBus::instance();
+    bus->publish(EVENT_AUTH_FAILURE, bus->sensorId("AUTH-GATEWAY"), 25);
 }
 
 void SecurityIntelligenceCenter::onResetSystemState()
 {
     addLogEntry("INFO", "System reset initiated - Restoring baseline parameters");
     
-    m_wasteRisk = 10;
-    m_safetyRisk = 15;
-    m_energyRisk = 8;
-    m_cyberThreatLevel = 5;
-    
-    updateCityStabilityScore(calculateCityStability());
+    m_stability->reset();
+    updateCityStabilityScore(m_stability->cityScore());
     
     // Reset system health table
     for (int i = 0; i < m_systemHealthTable->rowCount(); ++i) {
@@ -891,34 +921,73 @@ void SecurityIntelligenceCenter::onTriggerSimulatedThreat()
         "Data Integrity Violation"
     };
     
-    QStringList modules = {
-        "Pedestrian Safety",
-        "Recycling Infrastructure",
-        "Smart Lighting",
-        "Communication Layer"
-    };
-    
+    // Each scenario injects tampered telemetry; the first two trip threat
+    // rules, the others are left to the anomaly detector
     int idx = QRandomGenerator::global()->bounded(threats.size());
-    QString severity = QRandomGenerator::global()->bounded(2) ? "WARNING" : "CRITICAL";
+    CityEventBus *bus = CityEventBus::instance();
+    QString bin = QString("BIN-%1").arg(1 + QRandomGenerator::global()->bounded(8), 3, 10, QChar('0'));
+    QString detail;
+    
+    if (idx == 0) {
+        int speed = QRandomGenerator::global()->bounded(2)
+                ? 300 + QRandomGenerator::global()->bounded(400)
+                : -QRandomGenerator::global()->bounded(1, 60);
+        bus->publish(EVENT_SPEED_READING, bus->sensorId("CW-005"), speed);
+        detail = QString("%1 km/h radar reading at CW-005").arg(speed);
+    } else if (idx == 1) {
+        double deposit = 40.0 + QRandomGenerator::global()->bounded(60);
+        bus->publish(EVENT_BIN_DEPOSIT, bus->sensorId(bin), deposit);
+        detail = QString("%1 kg deposit at %2").arg(deposit).arg(bin);
+    } else if (idx == 2) {
+        QString pole = QString("POLE-%1").arg(1 + QRandomGenerator::global()->bounded(7), 3, 10, QChar('0'));
+        double watts = 400.0 + QRandomGenerator::global()->bounded(500);
+        bus->publish(EVENT_POLE_POWER, bus->sensorId(pole), watts);
+        detail = QString("%1 W draw at %2").arg(watts).arg(pole);
+    } else {
+        double deposit = -(5.0 + QRandomGenerator::global()->bounded(40));
+        bus->publish(EVENT_BIN_DEPOSIT, bus->sensorId(bin), deposit);
+        detail = QString("%1 kg deposit at %2").arg(deposit).arg(bin);
+    }
     
-    addThreatAlert(threats[idx], modules[idx], severity, 
-                   QDateTime::currentDateTime().toString("HH:mm:ss"));
-    addLogEntry(severity, QString("%1 detected in %2").arg(threats[idx]).arg(modules[idx]));
+    addLogEntry("INFO", QString("Scenario: %1 - injecting %2").arg(threats[idx], detail));
 }
 
 void SecurityIntelligenceCenter::onApproveRecommendation()
 {
-    addLogEntry("INFO", "Strategic recommendation approved by operator");
-    addLogEntry("INFO", "Executing recommended action...");
+    if (m_recommendationCandidate < 0) return;
+    quint64 id = m_actions->submit(m_recommendation, ACTION_SOURCE);
+    addLogEntry("INFO", QString("Strategic recommendation approved by operator - action #%1: %2")
+                .arg(id).arg(m_recommendation.text));
+    RecommendationEngine::instance()->dismiss(m_recommendationCandidate, QDateTime::currentMSecsSinceEpoch());
     generateStrategicRecommendation();
 }
 
 void SecurityIntelligenceCenter::onRejectRecommendation()
 {
     addLogEntry("WARNING", "Strategic recommendation rejected by operator");
+    RecommendationEngine::instance()->dismiss(m_recommendationCandidate, QDateTime::currentMSecsSinceEpoch());
     generateStrategicRecommendation();
 }
 
+void SecurityIntelligenceCenter::onActionApplied(const ActionOutcome &outcome)
+{
+    if (!outcome.sources.contains(ACTION_SOURCE)) return;
+    addLogEntry("INFO", QString("Action #%1 executed in %2 ms - measuring effect")
+                .arg(outcome.id).arg(outcome.latencyMs()));
+}
+
+void SecurityIntelligenceCenter::onActionCompleted(const ActionOutcome &outcome)
+{
+    if (!outcome.sources.contains(ACTION_SOURCE)) return;
+    addLogEntry("INFO", QString("Action #%1 result: %2 risk %3 -> %4, city stability %5 -> %6")
+                .arg(outcome.id)
+                .arg(m_stability->zoneName(outcome.zone))
+                .arg(outcome.penaltyBefore, 0, 'f', 1)
+                .arg(outcome.penaltyAfter, 0, 'f', 1)
+                .arg(outcome.scoreBefore)
+                .arg(outcome.scoreAfter));
+}
+
 void SecurityIntelligenceCenter::onSimulationModeToggled(bool enabled)
 {
     m_simulationMode = enabled;
@@ -937,13 +1006,10 @@ void SecurityIntelligenceCenter::onSimulationModeToggled(bool enabled)
 
 void SecurityIntelligenceCenter::updateRiskMetrics()
 {
+    TRACE_SCOPE("SecurityIntelligenceCenter::updateRiskMetrics");
     // Gradually decrease risks over time (recovery)
-    if (m_wasteRisk > 10) m_wasteRisk -= 1;
-    if (m_safetyRisk > 15) m_safetyRisk -= 1;
-    if (m_energyRisk > 8) m_energyRisk -= 1;
-    if (m_cyberThreatLevel > 5) m_cyberThreatLevel -= 1;
-    
-    updateCityStabilityScore(calculateCityStability());
+    m_stability->recover(1.0);
+    updateCityStabilityScore(m_stability->cityScore());
     
     // Random log entries
     if (QRandomGenerator::global()->bounded(10) < 2) {
@@ -978,32 +1044,241 @@ void SecurityIntelligenceCenter::generatePrediction()
     }
 }
 
-void SecurityIntelligenceCenter::updateSystemHealth(const QString &module, const QString &status, 
-                                                    const QString &risk)
+void SecurityIntelligenceCenter::loadThreatRules()
 {
-    for (int i = 0; i < m_systemHealthTable->rowCount(); ++i) {
-        if (m_systemHealthTable->item(i, 0)->text() == module) {
-            QTableWidgetItem *statusItem = new QTableWidgetItem(status);
-            if (status.contains("✓")) {
-                statusItem->setForeground(QBrush(QColor(COLOR_SUCCESS)));
-            } else if (status.contains("⚠")) {
-                statusItem->setForeground(QBrush(QColor(COLOR_WARNING)));
-            } else {
-                statusItem->setForeground(QBrush(QColor(COLOR_CRITICAL)));
+    const double BIN_CAPACITY = RecyclingModel::BIN_CAPACITY_KG;
+    
+    // name, module, severity, event kind, condition, threshold, minimum, cooldown (s), ceiling
+    addThreatRule({"Fake Speed Data Injection", "Pedestrian Safety", "CRITICAL",
+                   EVENT_SPEED_READING, ThreatRule::ValueAbove, 250.0, 0.0, 30},
+                  {CityStabilityModel::SafetyRisk, 10, -1, QString()});
+    addThreatRule({"Fake Speed Data Injection", "Pedestrian Safety", "CRITICAL",
+                   EVENT_SPEED_READING, ThreatRule::ValueBelow, 0.0, 0.0, 30},
+                  {CityStabilityModel::SafetyRisk, 10, -1, QString()});
+    addThreatRule({"Speed Data Anomaly", "Pedestrian Safety", "WARNING",
+                   EVENT_SPEED_READING, ThreatRule::ValueInRange, 80.0, 0.0, 30, 250.0},
+                  {CityStabilityModel::SafetyRisk, 10, -1, QString()});
+    addThreatRule({"Unrealistic Waste Deposit", "Recycling Infrastructure", "CRITICAL",
+                   EVENT_BIN_DEPOSIT, ThreatRule::SpikeOverHistory, 20.0, 5.0, 60},
+                  {CityStabilityModel::WasteRisk, 15, -1, QString()});
+    addThreatRule({"Waste Overload", "Recycling Infrastructure", "CRITICAL",
+                   EVENT_BIN_DEPOSIT, ThreatRule::ValueAbove, BIN_CAPACITY, 0.0, 60},
+                  {CityStabilityModel::WasteRisk, 15, -1, QString()});
+    addThreatRule({"Unauthorized Access Attempt", "Authentication System", "CRITICAL",
+                   EVENT_AUTH_FAILURE, ThreatRule::ValueAbove, 5.0, 0.0, 30},
+                  {CityStabilityModel::CyberRisk, 20, HEALTH_AUTHENTICATION, "⛔ Critical"});
+}
+
+void SecurityIntelligenceCenter::addThreatRule(const ThreatRule &rule, const RuleResponse &response)
+{
+    m_ruleEngine.addRule(rule);
+    m_ruleResponses.append(response);
+}
+
+void SecurityIntelligenceCenter::processEventBatch()
+{
+    qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+
+    // The bus has been filling since startup; readings older than the
+    // longest liveness window are history, not threats to alert on now
+    qint64 notBeforeMs = 0;
+    if (m_batchCount == 0) {
+        qint64 windowMs = 0;
+        for (int k = 0; k < EVENT_KIND_COUNT; ++k) windowMs = qMax(windowMs, m_kindTimeoutMs[k]);
+        notBeforeMs = nowMs - windowMs;
+    }
+    CityEventBus::instance()->drain(m_eventBatch, notBeforeMs);
+    
+    bool expired = trackLiveness(nowMs);
+    if (++m_batchCount % 4 == 0) refreshLastSignals(nowMs);
+    
+    m_threatHits.clear();
+    m_anomalyHits.clear();
+    m_ruleEngine.evaluate(m_eventBatch, m_threatHits);
+    m_anomalyDetector.observe(m_eventBatch, m_anomalyHits);
+    if (!expired && m_threatHits.isEmpty() && m_anomalyHits.isEmpty()) return;
+    
+    // Alert latency runs from the reading's timestamp to its alert
+    static LatencyHistogram *alertLatency = MetricsRegistry::instance()->histogram("alert_latency_us", "Security");
+    for (const ThreatHit &hit : m_threatHits) {
+        alertLatency->record(qMax<qint64>(0, nowMs - hit.timestampMs) * 1000);
+        handleThreatHit(hit);
+    }
+    for (const AnomalyHit &hit : m_anomalyHits) {
+        // A reading a rule already flagged does not need a second alert
+        bool covered = false;
+        for (const ThreatHit &threat : m_threatHits) {
+            if (threat.sensor == hit.sensor && m_ruleEngine.rule(threat.rule).kind == hit.kind) {
+                covered = true;
+                break;
             }
-            m_systemHealthTable->setItem(i, 1, statusItem);
-            
-            QTableWidgetItem *riskItem = new QTableWidgetItem(risk);
-            if (risk == "Low") {
-                riskItem->setForeground(QBrush(QColor(COLOR_SUCCESS)));
-            } else if (risk == "Medium") {
-                riskItem->setForeground(QBrush(QColor(COLOR_WARNING)));
-            } else {
-                riskItem->setForeground(QBrush(QColor(COLOR_CRITICAL)));
+        }
+        if (covered) continue;
+        alertLatency->record(qMax<qint64>(0, nowMs - hit.timestampMs) * 1000);
+        handleAnomalyHit(hit);
+    }
+    updateCityStabilityScore(m_stability->cityScore());
+    generatePrediction();
+}
+
+void SecurityIntelligenceCenter::handleThreatHit(const ThreatHit &hit)
+{
+    const ThreatRule &rule = m_ruleEngine.rule(hit.rule);
+    const RuleResponse &response = m_ruleResponses[hit.rule];
+    QString sensor = CityEventBus::instance()->sensorName(hit.sensor);
+    
+    QString detail;
+    switch (rule.kind) {
+    case EVENT_SPEED_READING: detail = QString("%1 reports %2 km/h").arg(sensor).arg(hit.value); break;
+    case EVENT_BIN_DEPOSIT:   detail = QString("%1 reports a %2 kg deposit").arg(sensor).arg(hit.value, 0, 'f', 1); break;
+    case EVENT_HEARTBEAT:     detail = QString("%1 silent for %2 s").arg(sensor).arg(hit.value, 0, 'f', 0); break;
+    default:                  detail = QString("%1 reports %2 failed logins").arg(sensor).arg(hit.value); break;
+    }
+    
+    addLogEntry(rule.severity, QString("%1 - %2").arg(rule.name, detail));
+    addThreatAlert(rule.name, rule.module, rule.severity,
+                   QDateTime::fromMSecsSinceEpoch(hit.timestampMs).toString("HH:mm:ss"));
+    
+    m_stability->addRisk(m_stability->sensorZone(hit.sensor), response.factor, response.riskIncrease);
+    if (response.healthRow >= 0) {
+        updateSystemHealth(response.healthRow, response.healthStatus, "High");
+    }
+}
+
+bool SecurityIntelligenceCenter::trackLiveness(qint64 nowMs)
+{
+    for (const CityEvent &event : m_eventBatch) {
+        if (event.kind >= EVENT_KIND_COUNT) continue;
+        int row = m_kindHealthRow[event.kind];
+        if (row < 0) continue;
+        
+        if (m_liveness.touch(event.sensor, row, m_kindTimeoutMs[event.kind], event.timestampMs)) {
+            addLogEntry("INFO", QString("%1 signal restored")
+                        .arg(CityEventBus::instance()->sensorName(event.sensor)));
+            if (m_liveness.moduleOnline(row) == m_liveness.moduleDevices(row)) {
+                updateSystemHealth(row, "✓ Operational", "Low");
             }
-            m_systemHealthTable->setItem(i, 3, riskItem);
-            
-            break;
         }
     }
+    if (!m_eventBatch.isEmpty()) {
+        if (m_liveness.touch(m_busSensor, HEALTH_COMMUNICATION, 5000, nowMs)) {
+            addLogEntry("INFO", "City event bus traffic resumed");
+            updateSystemHealth(HEALTH_COMMUNICATION, "✓ Operational", "Low");
+        }
+    }
+    
+    m_expiredDevices.clear();
+    if (m_liveness.advance(nowMs, m_expiredDevices) == 0) return false;
+    for (quint32 device : m_expiredDevices) {
+        handleDeviceExpired(device, nowMs);
+    }
+    return true;
+}
+
+void SecurityIntelligenceCenter::handleDeviceExpired(quint32 device, qint64 nowMs)
+{
+    int row = m_liveness.deviceModule(device);
+    QString moduleName = m_liveness.moduleName(row);
+    qint64 silentSeconds = (nowMs - m_liveness.lastSeen(device)) / 1000;
+    
+    QString type = "Sensor Offline";
+    if (device == m_busSensor) {
+        type = "Communication Loss";
+        m_stability->addRisk(m_stability->coreZone(), CityStabilityModel::CyberRisk, 10);
+    } else if (row == HEALTH_LIGHTING) {
+        m_stability->addRisk(m_stability->sensorZone(device), CityStabilityModel::EnergyRisk, 12);
+    }
+    
+    addLogEntry("CRITICAL", QString("%1 - %2 silent for %3 s")
+                .arg(type, CityEventBus::instance()->sensorName(device))
+                .arg(silentSeconds));
+    addThreatAlert(type, moduleName, "CRITICAL",
+                   QDateTime::fromMSecsSinceEpoch(nowMs).toString("HH:mm:ss"));
+    
+    bool allDown = m_liveness.moduleOnline(row) == 0;
+    updateSystemHealth(row, allDown ? "⛔ Critical" : "⚠ Warning", "High");
+}
+
+void SecurityIntelligenceCenter::refreshLastSignals(qint64 nowMs)
+{
+    for (int row = 0; row < HEALTH_ROW_COUNT; ++row) {
+        qint64 lastSignal = m_liveness.moduleLastSignal(row);
+        if (lastSignal == 0) continue;  // no live feed yet; keep the placeholder
+        
+        qint64 seconds = qMax(Q_INT64_C(0), (nowMs - lastSignal) / 1000);
+        QString text;
+        if (seconds < 60) text = QString("%1s ago").arg(seconds);
+        else if (seconds < 3600) text = QString("%1m ago").arg(seconds / 60);
+        else text = QString("%1h ago").arg(seconds / 3600);
+        
+        QTableWidgetItem *item = m_systemHealthTable->item(row, 2);
+        if (item && item->text() != text) item->setText(text);
+    }
+}
+
+void SecurityIntelligenceCenter::handleAnomalyHit(const AnomalyHit &hit)
+{
+    QString sensor = CityEventBus::instance()->sensorName(hit.sensor);
+    QString type = "Data Integrity Violation";
+    QString module;
+    QString unit;
+    CityStabilityModel::RiskFactor factor = CityStabilityModel::CyberRisk;
+    
+    switch (hit.kind) {
+    case EVENT_POLE_POWER:
+        type = "Abnormal Energy Pattern";
+        module = "Smart Lighting";
+        unit = "W";
+        factor = CityStabilityModel::EnergyRisk;
+        break;
+    case EVENT_BIN_DEPOSIT:
+        module = "Recycling Infrastructure";
+        unit = "kg";
+        factor = CityStabilityModel::WasteRisk;
+        break;
+    case EVENT_STATION_TAPS:
+        module = "Smart Station";
+        unit = "taps";
+        break;
+    default:
+        module = "Smart Home Security";
+        unit = "ppm";
+        break;
+    }
+    m_stability->addRisk(m_stability->sensorZone(hit.sensor), factor,
+                         factor == CityStabilityModel::EnergyRisk ? 8 : 5);
+    
+    QString severity = hit.score >= 2.0 * AnomalyDetector::DEFAULT_THRESHOLD ? "CRITICAL" : "WARNING";
+    addLogEntry(severity, QString("%1 - %2 reads %3 %4, expected %5 (score %6)")
+                .arg(type, sensor)
+                .arg(hit.value, 0, 'f', 1).arg(unit)
+                .arg(hit.expected, 0, 'f', 1)
+                .arg(hit.score, 0, 'f', 1));
+    addThreatAlert(type, module, severity,
+                   QDateTime::fromMSecsSinceEpoch(hit.timestampMs).toString("HH:mm:ss"), hit.score);
+}
+
+void SecurityIntelligenceCenter::updateSystemHealth(int row, const QString &status, const QString &risk)
+{
+    if (row < 0 || row >= m_systemHealthTable->rowCount()) return;
+    
+    QTableWidgetItem *statusItem = new QTableWidgetItem(status);
+    if (status.contains("✓")) {
+        statusItem->setForeground(QBrush(QColor(COLOR_SUCCESS)));
+    } else if (status.contains("⚠")) {
+        statusItem->setForeground(QBrush(QColor(COLOR_WARNING)));
+    } else {
+        statusItem->setForeground(QBrush(QColor(COLOR_CRITICAL)));
+    }
+    m_systemHealthTable->setItem(row, 1, statusItem);
+    
+    QTableWidgetItem *riskItem = new QTableWidgetItem(risk);
+    if (risk == "Low") {
+        riskItem->setForeground(QBrush(QColor(COLOR_SUCCESS)));
+    } else if (risk == "Medium") {
+        riskItem->setForeground(QBrush(QColor(COLOR_WARNING)));
+    } else {
+        riskItem->setForeground(QBrush(QColor(COLOR_CRITICAL)));
+    }
+    m_systemHealthTable->setItem(row, 3, riskItem);
 }
@@ -8,25 +8,34 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QCheckBox>
-#include <QTimer>
 #include <QDateTime>
 #include <QVector>
+#include <QStringList>
 #include <QScrollArea>
 #include <QtCharts/QChart>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QChartView>
 #include <QtCharts/QValueAxis>
+#include "threatruleengine.h"
+#include "anomalydetector.h"
+#include "livenesstracker.h"
+#include "citystabilitymodel.h"
+#include "recommendationengine.h"
+#include "actionexecutor.h"
+
+class SimulationThread;
 
 class SecurityIntelligenceCenter : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit SecurityIntelligenceCenter(QWidget *parent = nullptr);
+    SecurityIntelligenceCenter(SimulationThread *simulation, ActionExecutor *actions,
+                               QWidget *parent = nullptr);
     ~SecurityIntelligenceCenter();
 
 signals:
-    void threatDetected(QString module, int severity);
+    void threatDetected(QString module, int severity, double score);
     void riskUpdated(int newScore);
     void recommendationGenerated(QString text);
 
@@ -43,6 +52,8 @@ private slots:
     // Recommendation actions
     void onApproveRecommendation();
     void onRejectRecommendation();
+    void onActionApplied(const ActionOutcome &outcome);
+    void onActionCompleted(const ActionOutcome &outcome);
     
     // Simulation mode toggle
     void onSimulationModeToggled(bool enabled);
@@ -50,6 +61,7 @@ private slots:
     // Auto-update
     void updateRiskMetrics();
     void generatePrediction();
+    void processEventBatch();
 
 private:
     // UI Creation Methods
@@ -69,14 +81,50 @@ private:
     
     // Logic methods
     void addLogEntry(const QString &level, const QString &message);
+    void flushLog();
     void addThreatAlert(const QString &type, const QString &module, 
-                        const QString &severity, const QString &timestamp);
-    void updateSystemHealth(const QString &module, const QString &status, 
-                           const QString &risk);
+                        const QString &severity, const QString &timestamp,
+                        double score = 0.0);
+    void updateSystemHealth(int row, const QString &status, const QString &risk);
     void updateCityStabilityScore(int score);
+    void showCityStabilityScore();
     void addRiskDataPoint(double value);
     void generateStrategicRecommendation();
-    int calculateCityStability();
+    
+    // System health rows; also the liveness tracker's module indices
+    enum HealthRow {
+        HEALTH_RECYCLING,
+        HEALTH_PEDESTRIAN,
+        HEALTH_LIGHTING,
+        HEALTH_COMMUNICATION,
+        HEALTH_DATABASE,
+        HEALTH_AUTHENTICATION,
+        HEALTH_ROW_COUNT
+    };
+    
+    // Widget regions posted to the UI scheduler
+    enum UiRegion {
+        REGION_STABILITY,
+        REGION_RISK_CHART,
+        REGION_LOG
+    };
+    static const int LOG_BACKLOG_LINES = 500;
+    
+    // Threat rules
+    struct RuleResponse
+    {
+        CityStabilityModel::RiskFactor factor;
+        int riskIncrease;
+        int healthRow;          // -1 = leave the health table alone
+        QString healthStatus;
+    };
+    void loadThreatRules();
+    void addThreatRule(const ThreatRule &rule, const RuleResponse &response);
+    void handleThreatHit(const ThreatHit &hit);
+    void handleAnomalyHit(const AnomalyHit &hit);
+    bool trackLiveness(qint64 nowMs);
+    void handleDeviceExpired(quint32 device, qint64 nowMs);
+    void refreshLastSignals(qint64 nowMs);
     
     // Panel 1: System Health Overview
     QTableWidget *m_systemHealthTable;
@@ -88,6 +136,7 @@ private:
     
     // Panel 3: Live Security Log
     QPlainTextEdit *m_securityLog;
+    QStringList m_pendingLogLines;     // formatted, not yet appended
     
     // Panel 4: Predictive Intelligence
     QTableWidget *m_predictiveTable;
@@ -116,13 +165,29 @@ private:
     QVector<double> m_riskHistory;
     int m_currentStabilityScore;
     bool m_simulationMode;
-    QTimer *m_updateTimer;
     
-    // Risk factors (simulated)
-    int m_wasteRisk;
-    int m_safetyRisk;
-    int m_energyRisk;
-    int m_cyberThreatLevel;
+    // Rule-based and statistical detection over the city event bus
+    SimulationThread *m_simulation;
+    ActionExecutor *m_actions;
+    ThreatRuleEngine m_ruleEngine;
+    QVector<RuleResponse> m_ruleResponses;
+    QVector<CityEvent> m_eventBatch;
+    QVector<ThreatHit> m_threatHits;
+    AnomalyDetector m_anomalyDetector;
+    QVector<AnomalyHit> m_anomalyHits;
+    
+    // Device liveness behind the "Last Signal" column
+    LivenessTracker m_liveness;
+    int m_kindHealthRow[EVENT_KIND_COUNT];     // -1 = not tracked
+    qint64 m_kindTimeoutMs[EVENT_KIND_COUNT];  // 0 = never expires
+    quint32 m_busSensor;                       // the bus itself, for the communication layer
+    QVector<quint32> m_expiredDevices;
+    int m_batchCount;
+    CityStabilityModel *m_stability;
+    int m_recommendationCandidate;         // -1 = nothing to act on
+    Recommendation m_recommendation;
+    // Tags this page's commands in the action executor
+    const QString ACTION_SOURCE = "Security Center";
     
     // Color definitions
     const QString COLOR_BACKGROUND = "#121212";
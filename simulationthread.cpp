@@ -0,0 +1,153 @@
+#include "simulationthread.h"
+#include "citystabilitymodel.h"
+#include "tracer.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QTime>
+
+SimulationThread::SimulationThread(QObject *parent)
+    : QThread(parent)
+    , m_sinceHeartbeatMs(HEARTBEAT_INTERVAL_MS)
+{
+    // Built on the GUI thread, so devices can be placed in the stability model here
+    CityEventBus *bus = CityEventBus::instance();
+    CityStabilityModel *stability = CityStabilityModel::instance();
+    for (int i = 0; i < m_recycling.binCount(); ++i) {
+        int zone = stability->zone(m_recycling.binLocation(i));
+        m_binSensors.append(bus->sensorId(m_recycling.binId(i)));
+        stability->assignSensor(m_binSensors.last(), zone);
+        if (!m_zones.contains(zone)) m_zones.append(zone);
+        m_binSlots.append(m_zones.indexOf(zone));
+    }
+    for (int i = 0; i < m_lighting.poleCount(); ++i) {
+        int zone = stability->zone(m_lighting.poleLocation(i));
+        m_poleSensors.append(bus->sensorId(m_lighting.poleId(i)));
+        stability->assignSensor(m_poleSensors.last(), zone);
+        if (!m_zones.contains(zone)) m_zones.append(zone);
+        m_poleSlots.append(m_zones.indexOf(zone));
+    }
+
+    // Initial frames so the UI has consistent state before the first step
+    publish();
+}
+
+SimulationThread::~SimulationThread()
+{
+    requestInterruption();
+    wait();
+}
+
+void SimulationThread::post(const std::function<void(RecyclingModel &, LightingModel &)> &command)
+{
+    QMutexLocker locker(&m_commandMutex);
+    m_commands.append(command);
+}
+
+void SimulationThread::run()
+{
+    QRandomGenerator rng(QRandomGenerator::global()->generate());
+
+    QElapsedTimer clock;
+    clock.start();
+    qint64 lastNs = clock.nsecsElapsed();
+
+    while (!isInterruptionRequested()) {
+        {
+            TRACE_SCOPE("SimulationThread::step");
+            runCommands();
+
+            qint64 nowNs = clock.nsecsElapsed();
+            double dtSeconds = (nowNs - lastNs) / 1e9;
+            lastNs = nowNs;
+
+            m_recycling.step(dtSeconds, rng);
+            m_recycling.updatePredictions(QDateTime::currentMSecsSinceEpoch());
+            m_lighting.step(dtSeconds, QTime::currentTime().hour(), rng);
+            publish();
+            publishTelemetry(dtSeconds);
+        }
+
+        msleep(STEP_MS);
+    }
+}
+
+void SimulationThread::runCommands()
+{
+    {
+        QMutexLocker locker(&m_commandMutex);
+        if (m_commands.isEmpty()) return;
+        m_runningCommands.swap(m_commands);
+    }
+
+    for (const auto &command : m_runningCommands) {
+        command(m_recycling, m_lighting);
+    }
+    m_runningCommands.clear();
+}
+
+void SimulationThread::publish()
+{
+    m_recycling.fillSnapshot(m_recyclingFrames.writeSlot());
+    m_recyclingFrames.publish();
+
+    m_lighting.fillSnapshot(m_lightingFrames.writeSlot());
+    m_lightingFrames.publish();
+
+    fillConditions(m_conditionFrames.writeSlot());
+    m_conditionFrames.publish();
+}
+
+void SimulationThread::fillConditions(ConditionSnapshot &snapshot) const
+{
+    // Slots are reused, so the vector keeps its capacity between frames
+    snapshot.zones.resize(m_zones.size());
+    for (int i = 0; i < m_zones.size(); ++i) {
+        snapshot.zones[i] = ZoneCondition();
+        snapshot.zones[i].zone = m_zones[i];
+    }
+    for (int i = 0; i < m_binSlots.size(); ++i) {
+        double over = m_recycling.fillLevel(i) - OVERFULL_PERCENT;
+        if (over > 0.0) snapshot.zones[m_binSlots[i]].binOverflow += over / (100.0 - OVERFULL_PERCENT);
+    }
+    for (int i = 0; i < m_poleSlots.size(); ++i) {
+        if (m_lighting.isPoleBoosted(i)) ++snapshot.zones[m_poleSlots[i]].boostedPoles;
+    }
+}
+
+void SimulationThread::publishTelemetry(double dtSeconds)
+{
+    qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    m_telemetry.clear();
+
+    CityEvent event;
+    event.timestampMs = nowMs;
+    event.reserved = 0;
+
+    event.kind = EVENT_BIN_DEPOSIT;
+    for (int i = 0; i < m_binSensors.size(); ++i) {
+        double deposit = m_recycling.lastDepositKg(i);
+        if (deposit <= 0.0) continue;
+        event.sensor = m_binSensors[i];
+        event.value = deposit;
+        m_telemetry.append(event);
+    }
+
+    m_sinceHeartbeatMs += dtSeconds * 1000.0;
+    if (m_sinceHeartbeatMs >= HEARTBEAT_INTERVAL_MS) {
+        m_sinceHeartbeatMs = 0.0;
+        for (int i = 0; i < m_poleSensors.size(); ++i) {
+            if (!m_lighting.isPoleActive(i)) continue;
+            event.sensor = m_poleSensors[i];
+            event.kind = EVENT_HEARTBEAT;
+            event.value = 1.0;
+            m_telemetry.append(event);
+            event.kind = EVENT_POLE_POWER;
+            event.value = m_lighting.polePowerWatts(i);
+            m_telemetry.append(event);
+        }
+    }
+
+    if (!m_telemetry.isEmpty()) CityEventBus::instance()->publishBatch(m_telemetry);
+}
@@ -0,0 +1,83 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <functional>
+#include "snapshotbuffer.h"
+#include "cityeventbus.h"
+#include "recyclingmodel.h"
+#include "lightingmodel.h"
+
+// What the devices in one stability zone are doing right now
+struct ZoneCondition
+{
+    int zone;
+    double binOverflow = 0.0;    // full bins' worth of fill above OVERFULL_PERCENT
+    int boostedPoles = 0;
+};
+
+// Immutable frame for the city conditions feed
+struct ConditionSnapshot
+{
+    QVector<ZoneCondition> zones;
+};
+
+// Advances the headless city models on a dedicated thread and publishes
+// one snapshot per model per step. The UI reads frames through the
+// snapshot buffers and never touches the models directly; changes go
+// through post(), which queues a command for the next step.
+class SimulationThread : public QThread
+{
+public:
+    explicit SimulationThread(QObject *parent = nullptr);
+    ~SimulationThread();
+
+    // Runs on the simulation thread before the next step
+    void post(const std::function<void(RecyclingModel &, LightingModel &)> &command);
+
+    // Consumer side, UI thread only
+    SnapshotBuffer<RecyclingSnapshot> &recyclingFrames() { return m_recyclingFrames; }
+    SnapshotBuffer<LightingSnapshot> &lightingFrames() { return m_lightingFrames; }
+    SnapshotBuffer<ConditionSnapshot> &conditionFrames() { return m_conditionFrames; }
+
+    static const int STEP_MS = 250;
+    static const int HEARTBEAT_INTERVAL_MS = 1000;
+    static constexpr double OVERFULL_PERCENT = 75.0;
+
+protected:
+    void run() override;
+
+private:
+    void runCommands();
+    void publish();
+    void fillConditions(ConditionSnapshot &snapshot) const;
+    void publishTelemetry(double dtSeconds);
+
+    RecyclingModel m_recycling;
+    LightingModel m_lighting;
+
+    SnapshotBuffer<RecyclingSnapshot> m_recyclingFrames;
+    SnapshotBuffer<LightingSnapshot> m_lightingFrames;
+    SnapshotBuffer<ConditionSnapshot> m_conditionFrames;
+
+    // Devices grouped by stability zone, for the condition frames
+    QVector<int> m_zones;          // distinct zones, as condition slots
+    QVector<int> m_binSlots;       // per bin, index into m_zones
+    QVector<int> m_poleSlots;      // per pole
+
+    // Telemetry for the event bus: bin deposits every step, pole heartbeats
+    // and power draw every HEARTBEAT_INTERVAL_MS while the pole is in service
+    QVector<quint32> m_binSensors;
+    QVector<quint32> m_poleSensors;
+    QVector<CityEvent> m_telemetry;
+    double m_sinceHeartbeatMs;
+
+    // Commands are rare (button presses), so a mutex is fine here
+    QMutex m_commandMutex;
+    QVector<std::function<void(RecyclingModel &, LightingModel &)>> m_commands;
+    QVector<std::function<void(RecyclingModel &, LightingModel &)>> m_runningCommands;
+};
+
+#endif // SIMULATIONTHREAD_H
@@ -1,4 +1,10 @@
 #include "smarthomesecuritypage.h"
+#include "cityeventbus.h"
+#include "citylayout.h"
+#include "uiupdatescheduler.h"
+#include "metricsregistry.h"
+#include "tickdriver.h"
+#include "tracer.h"
 
 SmartHomeSecurityPage::SmartHomeSecurityPage(QWidget *parent)
     : QWidget(parent)
@@ -15,18 +21,16 @@ SmartHomeSecurityPage::SmartHomeSecurityPage(QWidget *parent)
     applyDarkTheme();
     loadSampleData();
     
-    // Setup timers
-    sensorUpdateTimer = new QTimer(this);
-    connect(sensorUpdateTimer, &QTimer::timeout, this, &SmartHomeSecurityPage::updateSensorData);
-    sensorUpdateTimer->start(4000); // Update every 4 seconds
+    // Setup ticks
+    TickDriver *ticks = TickDriver::instance();
+    ticks->add("Home sensors", 4000, this, [this]() { updateSensorData(); });
+    chartUpdateTick = ticks->add("Home chart", 5000, this, [this]() { updateEnvironmentalChart(); });
+    ticks->add("Gas alerts", 3000, this, [this]() { checkGasAlerts(); });
     
-    chartUpdateTimer = new QTimer(this);
-    connect(chartUpdateTimer, &QTimer::timeout, this, &SmartHomeSecurityPage::updateEnvironmentalChart);
-    chartUpdateTimer->start(5000); // Update every 5 seconds
-    
-    gasAlertTimer = new QTimer(this);
-    connect(gasAlertTimer, &QTimer::timeout, this, &SmartHomeSecurityPage::checkGasAlerts);
-    gasAlertTimer->start(3000); // Check every 3 seconds
+    // Sensors and gas alerts run regardless; the environment chart's
+    // history pauses once the page has been hidden a while
+    lifecycle = new PageLifecycle(this);
+    lifecycle->manage(chartUpdateTick, 5000, 0);
 }
 
 SmartHomeSecurityPage::~SmartHomeSecurityPage()
@@ -439,7 +443,25 @@ void SmartHomeSecurityPage::loadSampleData()
     
     nextHomeId = 5009;
     
-    // Populate table
+    refreshHomeTable();
+}
+
+void SmartHomeSecurityPage::refreshHomeTable()
+{
+    // The city map follows the homes whether or not this page is showing
+    for (const Home &home : homes) {
+        CityLayout::instance()->place(CityLayout::Home, home.id, home.address);
+        CityLayout::instance()->setValue(CityLayout::Home, home.id, home.gasLevel / GAS_CRITICAL_THRESHOLD);
+    }
+    
+    UiUpdateScheduler *ui = UiUpdateScheduler::instance();
+    ui->post(this, KpiRegion, UiUpdateScheduler::High, [this]() { updateKPICards(); });
+    ui->post(this, HomeTableRegion, UiUpdateScheduler::Normal, [this]() { populateHomeTable(); });
+}
+
+void SmartHomeSecurityPage::populateHomeTable()
+{
+    SCOPED_LATENCY("table_update_us", "Home");
     homeTable->setRowCount(homes.size());
     for (int i = 0; i < homes.size(); ++i) {
         const Home &home = homes[i];
@@ -458,8 +480,6 @@ void SmartHomeSecurityPage::loadSampleData()
         statusItem->setForeground(QBrush(QColor(getAlertStatusColor(home.alertStatus))));
         homeTable->setItem(i, 7, statusItem);
     }
-    
-    updateKPICards();
 }
 
 void SmartHomeSecurityPage::updateKPICards()
@@ -584,7 +604,7 @@ void SmartHomeSecurityPage::onAddHomeClicked()
         }
         
         homes.append(newHome);
-        loadSampleData();
+        refreshHomeTable();
         
         QMessageBox::information(this, "Success", "Home registered successfully!");
     }
@@ -662,6 +682,7 @@ void SmartHomeSecurityPage::onEditHomeClicked()
         home.ownerName = ownerEdit->text();
         home.contact = contactEdit->text();
         home.address = addressEdit->text();
+        CityLayout::instance()->place(CityLayout::Home, home.id, home.address);
         home.gasLevel = gasSpin->value();
         home.smokeLevel = smokeSpin->value();
         home.temperature = tempSpin->value();
@@ -676,7 +697,7 @@ void SmartHomeSecurityPage::onEditHomeClicked()
             home.alertStatus = "Safe";
         }
         
-        loadSampleData();
+        refreshHomeTable();
         QMessageBox::information(this, "Success", "Home updated successfully!");
     }
 }
@@ -703,9 +724,10 @@ void SmartHomeSecurityPage::onDeleteHomeClicked()
     if (reply == QMessageBox::Yes) {
         // Remove from alert tracking
         alertedHomes.remove(homes[currentRow].id);
+        CityLayout::instance()->remove(CityLayout::Home, homes[currentRow].id);
         
         homes.removeAt(currentRow);
-        loadSampleData();
+        refreshHomeTable();
         QMessageBox::information(this, "Success", "Home deleted successfully!");
     }
 }
@@ -771,7 +793,7 @@ void SmartHomeSecurityPage::onEmergencyShutdownClicked()
             home.smokeLevel = 0;
         }
         
-        loadSampleData();
+        refreshHomeTable();
         
         // Update button appearance
         emergencyShutdownBtn->setText("✅ EMERGENCY MODE ACTIVE");
@@ -815,8 +837,11 @@ void SmartHomeSecurityPage::onGenerateCertificateClicked()
 
 void SmartHomeSecurityPage::updateSensorData()
 {
+    TRACE_SCOPE("SmartHomeSecurityPage::updateSensorData");
     if (emergencyMode) return;
     
+    CityEventBus *bus = CityEventBus::instance();
+    
     // Simulate sensor value changes
     for (Home &home : homes) {
         // Random fluctuations
@@ -832,6 +857,10 @@ void SmartHomeSecurityPage::updateSensorData()
         home.humidity += (QRandomGenerator::global()->generateDouble() - 0.5) * 4.0;
         home.humidity = qMax(30.0, qMin(home.humidity, 90.0));
         
+        quint32 sensor = bus->sensorId(home.id);
+        bus->publish(EVENT_GAS_LEVEL, sensor, home.gasLevel);
+        bus->publish(EVENT_SMOKE_LEVEL, sensor, home.smokeLevel);
+        
         // Update alert status
         if (home.gasLevel >= GAS_CRITICAL_THRESHOLD || home.smokeLevel >= SMOKE_WARNING_THRESHOLD) {
             home.alertStatus = "Critical";
@@ -842,7 +871,7 @@ void SmartHomeSecurityPage::updateSensorData()
         }
     }
     
-    loadSampleData();
+    refreshHomeTable();
 }
 
 void SmartHomeSecurityPage::updateEnvironmentalChart()
@@ -868,14 +897,18 @@ void SmartHomeSecurityPage::updateEnvironmentalChart()
     temperatureHistory.append(avgTemp);
     humidityHistory.append(avgHumidity);
     
-    // Update series
-    temperatureSeries->clear();
-    humiditySeries->clear();
-    
-    for (int i = 0; i < 24; ++i) {
-        temperatureSeries->append(i, temperatureHistory[i]);
-        humiditySeries->append(i, humidityHistory[i]);
-    }
+    UiUpdateScheduler::instance()->post(this, ChartRegion, UiUpdateScheduler::Low, [this]() {
+        SCOPED_LATENCY("chart_update_us", "Home");
+        TRACE_SCOPE("SmartHomeSecurityPage environment chart");
+        // Replace the points in one call per series so the chart redraws once
+        QList<QPointF> temperature, humidity;
+        for (int i = 0; i < 24; ++i) {
+            temperature.append(QPointF(i, temperatureHistory[i]));
+            humidity.append(QPointF(i, humidityHistory[i]));
+        }
+        temperatureSeries->replace(temperature);
+        humiditySeries->replace(humidity);
+    });
 }
 
 void SmartHomeSecurityPage::checkGasAlerts()
@@ -889,6 +922,18 @@ void SmartHomeSecurityPage::checkGasAlerts()
                 continue; // Skip - already alerted
             }
             
+            // Neighbouring homes to warn as well
+            QStringList neighbours;
+            double x = 0.0;
+            double y = 0.0;
+            if (CityLayout::instance()->position(CityLayout::Home, home.id, x, y)) {
+                QVector<CityEntity> nearby = CityLayout::instance()->withinRadius(
+                    x, y, GAS_NEIGHBOUR_RADIUS, CityLayout::typeBit(CityLayout::Home));
+                for (const CityEntity &entity : nearby) {
+                    if (entity.id != home.id) neighbours.append(entity.id);
+                }
+            }
+            
             // Show alert
             QMessageBox criticalAlert;
             criticalAlert.setIcon(QMessageBox::Critical);
@@ -898,12 +943,15 @@ void SmartHomeSecurityPage::checkGasAlerts()
                 "Home ID: %1\n"
                 "Owner: %2\n"
                 "Gas Level: %3 ppm\n"
-                "Threshold: %4 ppm\n\n"
+                "Threshold: %4 ppm\n"
+                "Homes within %5 m: %6\n\n"
                 "IMMEDIATE ACTION REQUIRED!"
             ).arg(home.id)
              .arg(home.ownerName)
              .arg(home.gasLevel, 0, 'f', 1)
-             .arg(GAS_CRITICAL_THRESHOLD, 0, 'f', 1));
+             .arg(GAS_CRITICAL_THRESHOLD, 0, 'f', 1)
+             .arg(GAS_NEIGHBOUR_RADIUS, 0, 'f', 0)
+             .arg(neighbours.isEmpty() ? QString("none") : neighbours.join(", ")));
             
             criticalAlert.setStyleSheet(
                 "QMessageBox {"
@@ -12,7 +12,6 @@
 #include <QHeaderView>
 #include <QLineEdit>
 #include <QComboBox>
-#include <QTimer>
 #include <QDateTime>
 #include <QRandomGenerator>
 #include <QDialog>
@@ -27,6 +26,7 @@
 #include <QtCharts/QChart>
 #include <QtCharts/QValueAxis>
 #include <QtCharts/QLegend>
+#include "pagelifecycle.h"
 
 class SmartHomeSecurityPage : public QWidget
 {
@@ -64,6 +64,8 @@ private:
     QFrame* createCard(const QString &title, const QString &value, const QString &color);
     void setupTable();
     void loadSampleData();
+    void refreshHomeTable();
+    void populateHomeTable();
     void updateKPICards();
     void applyDarkTheme();
     QString getAlertStatusColor(const QString &status);
@@ -104,9 +106,15 @@ private:
     QPushButton *generateCertBtn;
     
     // Update Timers
-    QTimer *sensorUpdateTimer;
-    QTimer *chartUpdateTimer;
-    QTimer *gasAlertTimer;
+    int chartUpdateTick;
+    PageLifecycle *lifecycle;
+    
+    // Widget regions posted to the UI scheduler
+    enum UiRegion {
+        KpiRegion,
+        HomeTableRegion,
+        ChartRegion
+    };
     
     // Data Storage
     struct Home {
@@ -132,6 +140,7 @@ private:
     const double SMOKE_WARNING_THRESHOLD = 300.0; // ppm
     const double TEMP_HIGH_THRESHOLD = 40.0;      // °C
     const double HUMIDITY_HIGH_THRESHOLD = 80.0;  // %
+    const double GAS_NEIGHBOUR_RADIUS = 300.0;    // m, homes warned with a critical one
 };
 
 #endif // SMARTHOMESECURITYPAGE_H
@@ -1,4 +1,9 @@
 #include "smartlightingmodule.h"
+#include "citylayout.h"
+#include "uiupdatescheduler.h"
+#include "metricsregistry.h"
+#include "tickdriver.h"
+#include "tracer.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -8,28 +13,27 @@
 #include <QRandomGenerator>
 #include <QScrollArea>
 #include <QDateTime>
+#include <QHash>
 #include <QtCharts/QValueAxis>
 
-SmartLightingModule::SmartLightingModule(QWidget *parent)
+SmartLightingModule::SmartLightingModule(SimulationThread *simulation, QWidget *parent)
     : QWidget(parent)
-    , m_energySavedPercentage(34.0)
+    , m_simulation(simulation)
+    , m_energySavedPercentage(-1.0)
+    , m_placedPoles(0)
     , m_currentMode("Auto Mode")
-    , m_totalPoles(85)
-    , m_activePoles(82)
     , m_manualIntensity(75)
 {
     setupUI();
     applyStyles();
     
-    // Initialize energy history (last 24 hours - percentage saved)
-    for (int i = 0; i < 24; ++i) {
-        m_energyHistory.append(25.0 + QRandomGenerator::global()->generateDouble() * 15.0);
-    }
+    // Render tick; state advances on the simulation thread
+    m_updateTick = TickDriver::instance()->add("Lighting", 1000, this, [this]() { updateLightingData(); });
     
-    // Setup auto-update timer
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer, &QTimer::timeout, this, &SmartLightingModule::updateLightingData);
-    m_updateTimer->start(7000); // Update every 7 seconds
+    // Pole heat on the map still follows the frames while the page is hidden
+    m_lifecycle = new PageLifecycle(this);
+    m_lifecycle->manage(m_updateTick, 1000, 5000);
+    connect(m_lifecycle, &PageLifecycle::resumed, this, &SmartLightingModule::updateLightingData);
     
     // Initial data population
     updateLightingData();
@@ -152,14 +156,14 @@ void SmartLightingModule::createKPISection()
     energyTitle->setAlignment(Qt::AlignLeft);
     energyTitle->setFixedHeight(16);
     
-    m_energySavedLabel = new QLabel("34 %");
+    m_energySavedLabel = new QLabel("0.0 %");
     m_energySavedLabel->setStyleSheet("font-size: 44px; font-weight: bold; color: " + COLOR_SUCCESS + "; margin-top: 5px;");
     m_energySavedLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
     m_energySavedLabel->setFixedHeight(52);
     
     m_energyBar = new QProgressBar();
     m_energyBar->setRange(0, 100);
-    m_energyBar->setValue(34);
+    m_energyBar->setValue(0);
     m_energyBar->setTextVisible(false);
     m_energyBar->setFixedHeight(14);
     m_energyBar->setStyleSheet(
@@ -382,11 +386,8 @@ void SmartLightingModule::createEnergyChart()
     chartTitle->setStyleSheet("font-size: 16px; font-weight: bold; color: " + COLOR_TEXT + ";");
     chartLayout->addWidget(chartTitle);
     
-    // Create line chart
+    // Create line chart (filled from measured hourly buckets)
     m_energySeries = new QLineSeries();
-    for (int i = 0; i < m_energyHistory.size(); ++i) {
-        m_energySeries->append(i, m_energyHistory[i]);
-    }
     
     QPen pen{QColor(COLOR_SUCCESS)};
     pen.setWidth(3);
@@ -409,7 +410,7 @@ void SmartLightingModule::createEnergyChart()
     m_energySeries->attachAxis(axisX);
     
     QValueAxis *axisY = new QValueAxis();
-    axisY->setRange(0, 50);
+    axisY->setRange(0, 100);
     axisY->setLabelFormat("%d%%");
     axisY->setTitleText("Energy Saved");
     axisY->setLabelsColor(QColor(COLOR_TEXT));
@@ -450,64 +451,105 @@ void SmartLightingModule::createStreetlightTable()
     m_streetlightTable->setStyleSheet(getTableStyle());
     m_streetlightTable->setMinimumHeight(280);
     
-    // Populate with sample data
-    updateStreetlight("POLE-001", "Main Street North", 85, "Detected", "Active");
-    updateStreetlight("POLE-002", "Main Street South", 45, "None", "Active");
-    updateStreetlight("POLE-003", "Central Plaza", 90, "Detected", "Active");
-    updateStreetlight("POLE-004", "Park Avenue", 60, "None", "Active");
-    updateStreetlight("POLE-005", "University Gate", 95, "Detected", "Active");
-    updateStreetlight("POLE-006", "Shopping District", 75, "Detected", "Active");
-    updateStreetlight("POLE-007", "Residential Zone", 40, "None", "Active");
-    updateStreetlight("POLE-008", "Industrial Area", 0, "None", "Maintenance");
-    updateStreetlight("POLE-009", "Sports Complex", 80, "Detected", "Active");
-    updateStreetlight("POLE-010", "Hospital Road", 100, "Detected", "Active");
+    // Rows are filled from the first simulation frame
     
     tableLayout->addWidget(m_streetlightTable);
 }
 
 void SmartLightingModule::updateLightingData()
 {
-    // Simulate energy savings fluctuation
-    double newSaving = m_energySavedPercentage + (QRandomGenerator::global()->generateDouble() * 5.0 - 2.0);
-    newSaving = qBound(20.0, newSaving, 50.0);
-    m_energySavedPercentage = newSaving;
-    
-    m_energySavedLabel->setText(QString::number(m_energySavedPercentage, 'f', 1) + " %");
-    m_energyBar->setValue(static_cast<int>(m_energySavedPercentage));
-    
-    // Update energy history
-    m_energyHistory.removeFirst();
-    m_energyHistory.append(m_energySavedPercentage);
-    
-    // Update chart
-    m_energySeries->clear();
-    for (int i = 0; i < m_energyHistory.size(); ++i) {
-        m_energySeries->append(i, m_energyHistory[i]);
+    TRACE_SCOPE("SmartLightingModule::updateLightingData");
+    // Take the newest published frame; nothing to draw if none arrived
+    SnapshotBuffer<LightingSnapshot> &frames = m_simulation->lightingFrames();
+    if (!frames.update()) return;
+    const LightingSnapshot &frame = frames.current();
+    
+    // The city map gets poles and their heat whether or not this page is showing
+    if (m_placedPoles != frame.poles.size()) {
+        for (const StreetlightPole &pole : frame.poles) {
+            CityLayout::instance()->place(CityLayout::Pole, pole.id, pole.location);
+        }
+        m_placedPoles = frame.poles.size();
     }
     
-    // Update streetlight intensities (simulate presence detection)
-    for (int i = 0; i < m_streetlightTable->rowCount(); ++i) {
-        QString status = m_streetlightTable->item(i, 4)->text();
-        if (status == "Active") {
-            // Randomly detect presence
-            bool presenceDetected = QRandomGenerator::global()->bounded(100) < 40; // 40% chance
-            m_streetlightTable->item(i, 3)->setText(presenceDetected ? "Detected" : "None");
-            
-            // Adjust intensity based on presence
-            int currentIntensity = m_streetlightTable->item(i, 2)->text().remove("%").toInt();
-            int newIntensity;
-            if (m_currentMode == "Auto Mode") {
-                newIntensity = presenceDetected ? qMin(100, currentIntensity + 10) : qMax(30, currentIntensity - 5);
-            } else if (m_currentMode == "Eco Mode") {
-                newIntensity = presenceDetected ? 70 : 25;
-            } else {
-                newIntensity = m_manualIntensity;
-            }
-            m_streetlightTable->item(i, 2)->setText(QString::number(newIntensity) + "%");
+    // Pole heat: its zone's consumption against the busiest zone
+    double busiestWh = 0.0;
+    QHash<QString, double> zoneWh;
+    for (const LightingZoneEnergy &zone : frame.zones) {
+        zoneWh.insert(zone.name, zone.consumedWh);
+        busiestWh = qMax(busiestWh, zone.consumedWh);
+    }
+    if (busiestWh > 0.0) {
+        for (const StreetlightPole &pole : frame.poles) {
+            CityLayout::instance()->setValue(CityLayout::Pole, pole.id, zoneWh.value(pole.location) / busiestWh);
         }
     }
     
-    emit energySaved(m_energySavedPercentage);
+    if (frame.energySavedPercentage != m_energySavedPercentage) {
+        m_energySavedPercentage = frame.energySavedPercentage;
+        emit energySaved(m_energySavedPercentage);
+    }
+    
+    // Widgets follow on the UI frame clock, from whatever frame is current then
+    UiUpdateScheduler *ui = UiUpdateScheduler::instance();
+    ui->post(this, KpiRegion, UiUpdateScheduler::High, [this]() {
+        const LightingSnapshot &current = m_simulation->lightingFrames().current();
+        m_totalPolesLabel->setText(QString::number(current.totalPoles));
+        m_activePolesLabel->setText(QString::number(current.activePoles));
+    });
+    ui->post(this, StreetlightTableRegion, UiUpdateScheduler::Normal, [this]() { refreshStreetlightTable(); });
+    ui->post(this, EnergyRegion, UiUpdateScheduler::Low, [this]() {
+        updateEnergyData(m_simulation->lightingFrames().current());
+    });
+}
+
+void SmartLightingModule::refreshStreetlightTable()
+{
+    SCOPED_LATENCY("table_update_us", "Lighting");
+    const LightingSnapshot &frame = m_simulation->lightingFrames().current();
+    
+    // Update streetlight rows
+    if (m_streetlightTable->rowCount() != frame.poles.size()) {
+        m_streetlightTable->setRowCount(0);
+        for (const StreetlightPole &pole : frame.poles) {
+            updateStreetlight(pole.id, pole.location, pole.intensity,
+                              pole.presence ? "Detected" : "None", pole.status);
+        }
+    } else {
+        for (int i = 0; i < frame.poles.size(); ++i) {
+            setStreetlightRow(i, frame.poles[i]);
+        }
+    }
+}
+
+void SmartLightingModule::updateEnergyData(const LightingSnapshot &frame)
+{
+    SCOPED_LATENCY("chart_update_us", "Lighting");
+    TRACE_SCOPE("SmartLightingModule::updateEnergyData");
+    m_energySavedLabel->setText(QString::number(frame.energySavedPercentage, 'f', 1) + " %");
+    m_energyBar->setValue(static_cast<int>(frame.energySavedPercentage));
+    
+    // Plot measured savings per hour of day
+    QList<QPointF> points;
+    for (int hour = 0; hour < 24; ++hour) {
+        if (frame.hourlyValid[hour]) {
+            points.append(QPointF(hour, frame.hourlySaved[hour]));
+        }
+    }
+    m_energySeries->replace(points);
+}
+
+void SmartLightingModule::setStreetlightRow(int row, const StreetlightPole &pole)
+{
+    m_streetlightTable->item(row, 2)->setText(QString::number(pole.intensity) + "%");
+    
+    QTableWidgetItem *presenceItem = m_streetlightTable->item(row, 3);
+    presenceItem->setText(pole.presence ? "Detected" : "None");
+    presenceItem->setForeground(QBrush(QColor(pole.presence ? COLOR_SUCCESS : COLOR_TEXT)));
+    
+    QTableWidgetItem *statusItem = m_streetlightTable->item(row, 4);
+    statusItem->setText(pole.status);
+    statusItem->setForeground(QBrush(QColor(getStatusColor(pole.status))));
 }
 
 void SmartLightingModule::updateStreetlight(const QString &poleId, const QString &location,
@@ -562,6 +604,11 @@ void SmartLightingModule::onModeChanged(int index)
             break;
     }
     
+    QString mode = m_currentMode;
+    m_simulation->post([mode](RecyclingModel &, LightingModel &lighting) {
+        lighting.setMode(mode);
+    });
+    
     emit lightingModeChanged(m_currentMode);
 }
 
@@ -570,6 +617,10 @@ void SmartLightingModule::onManualIntensityChanged(int value)
     m_manualIntensity = value;
     m_intensityValueLabel->setText(QString::number(value) + "%");
     
+    m_simulation->post([value](RecyclingModel &, LightingModel &lighting) {
+        lighting.setManualIntensity(value);
+    });
+    
     if (m_currentMode == "Manual Override") {
         addLogMessage("Manual intensity adjusted to " + QString::number(value) + "%");
     }
@@ -584,19 +635,34 @@ void SmartLightingModule::onRefreshData()
 void SmartLightingModule::onExportEnergyReport()
 {
     addLogMessage("Exporting energy report... [PDF/Excel format]");
+    
+    // The frame on screen; only the refresh tick takes new frames
+    const LightingSnapshot &frame = m_simulation->lightingFrames().current();
+    for (const LightingZoneEnergy &zone : frame.zones) {
+        addLogMessage(QString("%1: %2 kWh used / %3 kWh at full brightness")
+                      .arg(zone.name)
+                      .arg(zone.consumedWh / 1000.0, 0, 'f', 3)
+                      .arg(zone.baselineWh / 1000.0, 0, 'f', 3));
+    }
+    
+    const SnapshotLatency &latency = m_simulation->lightingFrames().latency();
+    addLogMessage(QString("Frame #%1, handoff %2 ms (mean %3 ms, max %4 ms)")
+                  .arg(m_simulation->lightingFrames().currentSequence())
+                  .arg(latency.lastNs / 1e6, 0, 'f', 3)
+                  .arg(latency.meanNs / 1e6, 0, 'f', 3)
+                  .arg(latency.maxNs / 1e6, 0, 'f', 3));
 }
 
 void SmartLightingModule::onSimulateFailure()
 {
-    if (m_streetlightTable->rowCount() > 0) {
-        int randomRow = QRandomGenerator::global()->bounded(m_streetlightTable->rowCount());
-        m_streetlightTable->item(randomRow, 2)->setText("0%");
-        m_streetlightTable->item(randomRow, 4)->setText("Maintenance");
-        m_streetlightTable->item(randomRow, 4)->setForeground(QBrush(QColor(COLOR_WARNING)));
+    const LightingSnapshot &frame = m_simulation->lightingFrames().current();
+    if (!frame.poles.isEmpty()) {
+        int randomRow = QRandomGenerator::global()->bounded(frame.poles.size());
+        QString poleId = frame.poles[randomRow].id;
         
-        QString poleId = m_streetlightTable->item(randomRow, 0)->text();
-        m_activePoles--;
-        m_activePolesLabel->setText(QString::number(m_activePoles));
+        m_simulation->post([randomRow](RecyclingModel &, LightingModel &lighting) {
+            lighting.setPoleFailed(randomRow);
+        });
         
         addLogMessage("⚠️ ALERT: " + poleId + " requires maintenance - lighting failure detected!");
         emit streetlightStatusChanged(poleId, "Maintenance");
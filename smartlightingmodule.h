@@ -7,19 +7,20 @@
 #include <QPushButton>
 #include <QComboBox>
 #include <QSlider>
-#include <QTimer>
 #include <QVector>
 #include <QProgressBar>
 #include <QtCharts/QChart>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QChartView>
+#include "simulationthread.h"
+#include "pagelifecycle.h"
 
 class SmartLightingModule : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit SmartLightingModule(QWidget *parent = nullptr);
+    explicit SmartLightingModule(SimulationThread *simulation, QWidget *parent = nullptr);
     ~SmartLightingModule();
 
 signals:
@@ -50,8 +51,9 @@ private:
     QString getButtonStyle(const QString &color);
     void updateStreetlight(const QString &poleId, const QString &location,
                           int intensity, const QString &presence, const QString &status);
-    void updateEnergyData();
-    void calculateEnergySavings();
+    void setStreetlightRow(int row, const StreetlightPole &pole);
+    void updateEnergyData(const LightingSnapshot &frame);
+    void refreshStreetlightTable();
     void addLogMessage(const QString &message);
     QString getStatusColor(const QString &status);
     
@@ -81,14 +83,21 @@ private:
     QPushButton *m_exportBtn;
     QPushButton *m_simulateBtn;
     
-    // Data tracking
-    QTimer *m_updateTimer;
+    // Widget regions posted to the UI scheduler
+    enum UiRegion {
+        KpiRegion,
+        StreetlightTableRegion,
+        EnergyRegion
+    };
+    
+    // Data tracking (frames come from the simulation thread)
+    SimulationThread *m_simulation;
+    int m_updateTick;
+    PageLifecycle *m_lifecycle;
     double m_energySavedPercentage;
+    int m_placedPoles;              // poles registered with the city layout
     QString m_currentMode;
-    int m_totalPoles;
-    int m_activePoles;
     int m_manualIntensity;
-    QVector<double> m_energyHistory; // Last 24 hours
     
     // Color definitions
     const QString COLOR_BACKGROUND = "#121212";
@@ -1,4 +1,9 @@
 #include "smartrecyclingmodule.h"
+#include "citylayout.h"
+#include "uiupdatescheduler.h"
+#include "metricsregistry.h"
+#include "tickdriver.h"
+#include "tracer.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -10,21 +15,32 @@
 #include <QtCharts/QPieSlice>
 #include <QDateTime>
 
-SmartRecyclingModule::SmartRecyclingModule(QWidget *parent)
+namespace {
+// Bins predicted full within this many hours go on the next collection round
+const int COLLECTION_HORIZON_HOURS = 2;
+const double FLEET_CAPACITIES_KG[] = {400.0, 400.0, 250.0};
+const int LEADERBOARD_ROWS = 100;
+const double HIGH_PERFORMER_KG = 200.0;
+}
+
+SmartRecyclingModule::SmartRecyclingModule(SimulationThread *simulation, QWidget *parent)
     : QWidget(parent)
-    , m_totalRecycled(847.0)
-    , m_plasticTotal(320.0)
-    , m_metalTotal(285.0)
-    , m_glassTotal(242.0)
-    , m_activeBins(12)
+    , m_simulation(simulation)
+    , m_totalRecycled(-1.0)
+    , m_routeOptimizer(new RouteOptimizer(this))
+    , m_leaderboardVersion(0)
 {
     setupUI();
     applyStyles();
     
-    // Setup auto-update timer
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer, &QTimer::timeout, this, &SmartRecyclingModule::updateRecyclingData);
-    m_updateTimer->start(8000); // Update every 8 seconds
+    // Render tick; state advances on the simulation thread
+    m_updateTick = TickDriver::instance()->add("Recycling", 1000, this, [this]() { updateRecyclingData(); });
+    connect(m_routeOptimizer, &QThread::finished, this, &SmartRecyclingModule::onRoutesPlanned);
+    
+    // Rewards and the map still follow the frames while the page is hidden
+    m_lifecycle = new PageLifecycle(this);
+    m_lifecycle->manage(m_updateTick, 1000, 5000);
+    connect(m_lifecycle, &PageLifecycle::resumed, this, &SmartRecyclingModule::updateRecyclingData);
     
     // Initial data population
     updateRecyclingData();
@@ -231,17 +247,17 @@ void SmartRecyclingModule::createWasteTypesChart()
     // Create pie chart
     m_wasteSeries = new QPieSeries();
     
-    QPieSlice *plasticSlice = m_wasteSeries->append("Plastic", m_plasticTotal);
+    QPieSlice *plasticSlice = m_wasteSeries->append("Plastic", 0);
     plasticSlice->setColor(QColor(COLOR_ACCENT));
     plasticSlice->setLabelVisible(true);
     plasticSlice->setLabelColor(QColor(COLOR_TEXT));
     
-    QPieSlice *metalSlice = m_wasteSeries->append("Metal", m_metalTotal);
+    QPieSlice *metalSlice = m_wasteSeries->append("Metal", 0);
     metalSlice->setColor(QColor(COLOR_WARNING));
     metalSlice->setLabelVisible(true);
     metalSlice->setLabelColor(QColor(COLOR_TEXT));
     
-    QPieSlice *glassSlice = m_wasteSeries->append("Glass", m_glassTotal);
+    QPieSlice *glassSlice = m_wasteSeries->append("Glass", 0);
     glassSlice->setColor(QColor(COLOR_SUCCESS));
     glassSlice->setLabelVisible(true);
     glassSlice->setLabelColor(QColor(COLOR_TEXT));
@@ -275,8 +291,8 @@ void SmartRecyclingModule::createBinStatusTable()
     tableLayout->addWidget(tableTitle);
     
     m_binStatusTable = new QTableWidget();
-    m_binStatusTable->setColumnCount(4);
-    m_binStatusTable->setHorizontalHeaderLabels({"Bin ID", "Location", "Fill Level", "Status"});
+    m_binStatusTable->setColumnCount(5);
+    m_binStatusTable->setHorizontalHeaderLabels({"Bin ID", "Location", "Fill Level", "Status", "Full In"});
     m_binStatusTable->horizontalHeader()->setStretchLastSection(true);
     m_binStatusTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     m_binStatusTable->verticalHeader()->setVisible(false);
@@ -286,16 +302,7 @@ void SmartRecyclingModule::createBinStatusTable()
     m_binStatusTable->setStyleSheet(getTableStyle());
     m_binStatusTable->setMinimumHeight(280);
     
-    // Populate with sample data
-    updateBinStatus("BIN-001", "Main Street Plaza", 35, "Operational");
-    updateBinStatus("BIN-002", "Central Park East", 68, "Almost Full");
-    updateBinStatus("BIN-003", "City Hall", 92, "Full");
-    updateBinStatus("BIN-004", "Shopping District", 45, "Operational");
-    updateBinStatus("BIN-005", "University Campus", 78, "Almost Full");
-    updateBinStatus("BIN-006", "Residential Zone A", 22, "Operational");
-    updateBinStatus("BIN-007", "Industrial Park", 88, "Full");
-    updateBinStatus("BIN-008", "Sports Complex", 41, "Operational");
-    
+    // Rows are filled from the first simulation frame
     tableLayout->addWidget(m_binStatusTable);
 }
 
@@ -312,8 +319,8 @@ void SmartRecyclingModule::createCitizenRewardsTable()
     tableLayout->addWidget(tableTitle);
     
     m_citizenRewardsTable = new QTableWidget();
-    m_citizenRewardsTable->setColumnCount(3);
-    m_citizenRewardsTable->setHorizontalHeaderLabels({"Citizen Name", "Total Recycled (kg)", "Money Earned ($)"});
+    m_citizenRewardsTable->setColumnCount(4);
+    m_citizenRewardsTable->setHorizontalHeaderLabels({"Rank", "Citizen Name", "Total Recycled (kg)", "Money Earned ($)"});
     m_citizenRewardsTable->horizontalHeader()->setStretchLastSection(true);
     m_citizenRewardsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     m_citizenRewardsTable->verticalHeader()->setVisible(false);
@@ -323,77 +330,140 @@ void SmartRecyclingModule::createCitizenRewardsTable()
     m_citizenRewardsTable->setStyleSheet(getTableStyle());
     m_citizenRewardsTable->setMinimumHeight(250);
     
-    // Populate with sample data
-    updateCitizenReward("Sarah Johnson", 245.5, 122.75);
-    updateCitizenReward("Michael Chen", 198.3, 99.15);
-    updateCitizenReward("Emma Williams", 176.2, 88.10);
-    updateCitizenReward("David Martinez", 154.8, 77.40);
-    updateCitizenReward("Lisa Anderson", 132.6, 66.30);
-    updateCitizenReward("James Wilson", 118.4, 59.20);
+    // Opening balances of the enrolled citizens
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    m_rewards.record(m_rewards.citizenId("Sarah Johnson"), 245.5, nowMs);
+    m_rewards.record(m_rewards.citizenId("Michael Chen"), 198.3, nowMs);
+    m_rewards.record(m_rewards.citizenId("Emma Williams"), 176.2, nowMs);
+    m_rewards.record(m_rewards.citizenId("David Martinez"), 154.8, nowMs);
+    m_rewards.record(m_rewards.citizenId("Lisa Anderson"), 132.6, nowMs);
+    m_rewards.record(m_rewards.citizenId("James Wilson"), 118.4, nowMs);
+    refreshLeaderboard();
     
     tableLayout->addWidget(m_citizenRewardsTable);
 }
 
 void SmartRecyclingModule::updateRecyclingData()
 {
-    // Simulate small increments in recycling data
-    double increment = 1.0 + QRandomGenerator::global()->generateDouble() * 4.0;
-    m_totalRecycled += increment;
-    
-    // Distribute increment among waste types
-    m_plasticTotal += increment * 0.38;
-    m_metalTotal += increment * 0.34;
-    m_glassTotal += increment * 0.28;
-    
-    // Update KPI labels
-    m_totalRecycledLabel->setText(QString::number(m_totalRecycled, 'f', 1) + " kg");
-    m_plasticTotalLabel->setText(QString::number(m_plasticTotal, 'f', 1) + " kg");
-    m_metalTotalLabel->setText(QString::number(m_metalTotal, 'f', 1) + " kg");
-    m_glassTotalLabel->setText(QString::number(m_glassTotal, 'f', 1) + " kg");
-    
-    // Update pie chart
-    m_wasteSeries->clear();
-    QPieSlice *plasticSlice = m_wasteSeries->append("Plastic", m_plasticTotal);
-    plasticSlice->setColor(QColor(COLOR_ACCENT));
-    plasticSlice->setLabelVisible(true);
-    plasticSlice->setLabelColor(QColor(COLOR_TEXT));
+    TRACE_SCOPE("SmartRecyclingModule::updateRecyclingData");
+    // Take the newest published frame; nothing to draw if none arrived
+    SnapshotBuffer<RecyclingSnapshot> &frames = m_simulation->recyclingFrames();
+    if (!frames.update()) return;
+    const RecyclingSnapshot &frame = frames.current();
+    
+    // The city map gets bins whether or not this page is showing
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    if (m_binFullAt.size() != frame.bins.size()) {
+        for (const RecyclingBin &bin : frame.bins) {
+            CityLayout::instance()->place(CityLayout::Bin, bin.id, bin.x, bin.y);
+        }
+    }
     
-    QPieSlice *metalSlice = m_wasteSeries->append("Metal", m_metalTotal);
-    metalSlice->setColor(QColor(COLOR_WARNING));
-    metalSlice->setLabelVisible(true);
-    metalSlice->setLabelColor(QColor(COLOR_TEXT));
+    // Only bins in the full-soon list have a prediction worth showing
+    m_binFullAt.fill(FillRatePredictor::NEVER, frame.bins.size());
+    for (const BinForecast &forecast : frame.fullSoon) m_binFullAt[forecast.bin] = forecast.fullAtMs;
     
-    QPieSlice *glassSlice = m_wasteSeries->append("Glass", m_glassTotal);
-    glassSlice->setColor(QColor(COLOR_SUCCESS));
-    glassSlice->setLabelVisible(true);
-    glassSlice->setLabelColor(QColor(COLOR_TEXT));
+    if (m_totalRecycled >= 0.0 && frame.totalRecycled > m_totalRecycled) {
+        double kg = frame.totalRecycled - m_totalRecycled;
+        emit wasteCollected(kg);
+        
+        // The simulation does not tag deposits with a card, so attribution
+        // is simulated: the new weight goes to a randomly chosen citizen
+        quint32 citizen = QRandomGenerator::global()->bounded(m_rewards.citizenCount());
+        creditCitizen(citizen, kg, nowMs);
+    }
+    m_totalRecycled = frame.totalRecycled;
+    
+    // Widgets follow on the UI frame clock, from whatever frame is current then
+    UiUpdateScheduler *ui = UiUpdateScheduler::instance();
+    ui->post(this, KpiRegion, UiUpdateScheduler::High, [this]() { showTotals(); });
+    ui->post(this, BinTableRegion, UiUpdateScheduler::Normal, [this]() { refreshBinTable(); });
+    ui->post(this, LeaderboardRegion, UiUpdateScheduler::Normal, [this]() { refreshLeaderboard(); });
+    ui->post(this, ChartRegion, UiUpdateScheduler::Low, [this]() { refreshWasteChart(); });
+}
+
+void SmartRecyclingModule::showTotals()
+{
+    const RecyclingSnapshot &frame = m_simulation->recyclingFrames().current();
+    m_totalRecycledLabel->setText(QString::number(frame.totalRecycled, 'f', 1) + " kg");
+    m_plasticTotalLabel->setText(QString::number(frame.plasticTotal, 'f', 1) + " kg");
+    m_metalTotalLabel->setText(QString::number(frame.metalTotal, 'f', 1) + " kg");
+    m_glassTotalLabel->setText(QString::number(frame.glassTotal, 'f', 1) + " kg");
+    m_activeBinsLabel->setText(QString::number(frame.activeBins));
+}
+
+void SmartRecyclingModule::refreshWasteChart()
+{
+    SCOPED_LATENCY("chart_update_us", "Recycling");
+    TRACE_SCOPE("SmartRecyclingModule::refreshWasteChart");
+    const RecyclingSnapshot &frame = m_simulation->recyclingFrames().current();
+    
+    // Update pie chart in place
+    QList<QPieSlice*> slices = m_wasteSeries->slices();
+    if (slices.size() == 3) {
+        slices[0]->setValue(frame.plasticTotal);
+        slices[1]->setValue(frame.metalTotal);
+        slices[2]->setValue(frame.glassTotal);
+    }
+}
+
+void SmartRecyclingModule::refreshBinTable()
+{
+    SCOPED_LATENCY("table_update_us", "Recycling");
+    const RecyclingSnapshot &frame = m_simulation->recyclingFrames().current();
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
     
     // Update bin fill levels
-    for (int i = 0; i < m_binStatusTable->rowCount(); ++i) {
-        QString binId = m_binStatusTable->item(i, 0)->text();
-        int fillLevel = calculateFillLevel(binId);
-        m_binStatusTable->item(i, 2)->setText(QString::number(fillLevel) + "%");
-        
-        // Update status based on fill level
-        QString status;
-        if (fillLevel >= 90) {
-            status = "Full";
-            m_binStatusTable->item(i, 3)->setForeground(QBrush(QColor(COLOR_CRITICAL)));
-        } else if (fillLevel >= 70) {
-            status = "Almost Full";
-            m_binStatusTable->item(i, 3)->setForeground(QBrush(QColor(COLOR_WARNING)));
-        } else {
-            status = "Operational";
-            m_binStatusTable->item(i, 3)->setForeground(QBrush(QColor(COLOR_SUCCESS)));
+    if (m_binStatusTable->rowCount() != frame.bins.size()) {
+        m_binStatusTable->setRowCount(0);
+        for (int i = 0; i < frame.bins.size(); ++i) {
+            const RecyclingBin &bin = frame.bins[i];
+            updateBinStatus(bin.id, bin.location, qRound(bin.fillLevel), binStatus(bin.fillLevel),
+                            timeToFull(m_binFullAt[i], nowMs));
+        }
+    } else {
+        for (int i = 0; i < frame.bins.size(); ++i) {
+            setBinRow(i, frame.bins[i], timeToFull(m_binFullAt[i], nowMs));
         }
-        m_binStatusTable->item(i, 3)->setText(status);
     }
+}
+
+QString SmartRecyclingModule::binStatus(double fillLevel) const
+{
+    if (fillLevel >= 90) return "Full";
+    if (fillLevel >= 70) return "Almost Full";
+    return "Operational";
+}
+
+QString SmartRecyclingModule::timeToFull(qint64 fullAtMs, qint64 nowMs) const
+{
+    if (fullAtMs == FillRatePredictor::NEVER) return QString("> %1 h").arg(RecyclingModel::FULL_SOON_HOURS);
+    qint64 minutes = (fullAtMs - nowMs) / 60000;
+    if (minutes <= 0) return "Now";
+    if (minutes < 60) return QString("%1 min").arg(minutes);
+    return QString("%1 h").arg(minutes / 60.0, 0, 'f', 1);
+}
+
+void SmartRecyclingModule::setBinRow(int row, const RecyclingBin &bin, const QString &fullIn)
+{
+    int fillLevel = qRound(bin.fillLevel);
+    m_binStatusTable->item(row, 2)->setText(QString::number(fillLevel) + "%");
     
-    emit wasteCollected(increment);
+    // Update status based on fill level
+    QString status = binStatus(bin.fillLevel);
+    if (fillLevel >= 90) {
+        m_binStatusTable->item(row, 3)->setForeground(QBrush(QColor(COLOR_CRITICAL)));
+    } else if (fillLevel >= 70) {
+        m_binStatusTable->item(row, 3)->setForeground(QBrush(QColor(COLOR_WARNING)));
+    } else {
+        m_binStatusTable->item(row, 3)->setForeground(QBrush(QColor(COLOR_SUCCESS)));
+    }
+    m_binStatusTable->item(row, 3)->setText(status);
+    m_binStatusTable->item(row, 4)->setText(fullIn);
 }
 
 void SmartRecyclingModule::updateBinStatus(const QString &binId, const QString &location, 
-                                          int fillLevel, const QString &status)
+                                          int fillLevel, const QString &status, const QString &fullIn)
 {
     int row = m_binStatusTable->rowCount();
     m_binStatusTable->insertRow(row);
@@ -402,6 +472,7 @@ void SmartRecyclingModule::updateBinStatus(const QString &binId, const QString &
     m_binStatusTable->setItem(row, 1, new QTableWidgetItem(location));
     m_binStatusTable->setItem(row, 2, new QTableWidgetItem(QString::number(fillLevel) + "%"));
     m_binStatusTable->setItem(row, 3, new QTableWidgetItem(status));
+    m_binStatusTable->setItem(row, 4, new QTableWidgetItem(fullIn));
     
     // Color-code the status
     if (fillLevel >= 90) {
@@ -413,43 +484,54 @@ void SmartRecyclingModule::updateBinStatus(const QString &binId, const QString &
     }
 }
 
-void SmartRecyclingModule::updateCitizenReward(const QString &name, double totalRecycled, double earned)
+void SmartRecyclingModule::creditCitizen(quint32 citizen, double kg, qint64 nowMs)
 {
-    int row = m_citizenRewardsTable->rowCount();
-    m_citizenRewardsTable->insertRow(row);
-    
-    m_citizenRewardsTable->setItem(row, 0, new QTableWidgetItem(name));
-    m_citizenRewardsTable->setItem(row, 1, new QTableWidgetItem(QString::number(totalRecycled, 'f', 1)));
-    m_citizenRewardsTable->setItem(row, 2, new QTableWidgetItem(QString::number(earned, 'f', 2)));
-    
-    // Highlight high performers
-    if (totalRecycled > 200) {
-        m_citizenRewardsTable->item(row, 0)->setForeground(QBrush(QColor(COLOR_SUCCESS)));
-    }
+    double amount = m_rewards.record(citizen, kg, nowMs);
+    if (amount > 0.0) emit rewardIssued(m_rewards.citizenName(citizen), amount);
 }
 
-int SmartRecyclingModule::calculateFillLevel(const QString &binId)
+void SmartRecyclingModule::refreshLeaderboard()
 {
-    // Simulate gradual fill increase
-    int currentLevel = 0;
-    for (int i = 0; i < m_binStatusTable->rowCount(); ++i) {
-        if (m_binStatusTable->item(i, 0)->text() == binId) {
-            QString levelStr = m_binStatusTable->item(i, 2)->text();
-            levelStr.remove("%");
-            currentLevel = levelStr.toInt();
-            break;
+    SCOPED_LATENCY("table_update_us", "Recycling");
+    // The ledger keeps the order; only redraw the top when it moved
+    if (m_rewards.version() == m_leaderboardVersion) return;
+    m_leaderboardVersion = m_rewards.version();
+    
+    QVector<quint32> top;
+    int rows = m_rewards.top(LEADERBOARD_ROWS, top);
+    int existing = m_citizenRewardsTable->rowCount();
+    m_citizenRewardsTable->setRowCount(rows);
+    for (int row = existing; row < rows; ++row) {
+        for (int column = 0; column < 4; ++column) {
+            m_citizenRewardsTable->setItem(row, column, new QTableWidgetItem());
         }
     }
+    for (int row = 0; row < rows; ++row) setCitizenRow(row, top[row]);
+}
+
+void SmartRecyclingModule::setCitizenRow(int row, quint32 citizen)
+{
+    double totalRecycled = m_rewards.totalKg(citizen);
+    m_citizenRewardsTable->item(row, 0)->setText(QString::number(row + 1));
+    m_citizenRewardsTable->item(row, 1)->setText(m_rewards.citizenName(citizen));
+    m_citizenRewardsTable->item(row, 2)->setText(QString::number(totalRecycled, 'f', 1));
+    m_citizenRewardsTable->item(row, 3)->setText(QString::number(m_rewards.earned(citizen), 'f', 2));
     
-    // Small random increase
-    int increase = QRandomGenerator::global()->bounded(0, 3);
-    return qMin(100, currentLevel + increase);
+    // Highlight high performers
+    QColor color(totalRecycled > HIGH_PERFORMER_KG ? COLOR_SUCCESS : COLOR_TEXT);
+    m_citizenRewardsTable->item(row, 1)->setForeground(QBrush(color));
 }
 
 void SmartRecyclingModule::onRefreshData()
 {
     updateRecyclingData();
-    addLogMessage("Data refreshed successfully");
+    
+    const SnapshotLatency &latency = m_simulation->recyclingFrames().latency();
+    addLogMessage(QString("Data refreshed successfully (frame #%1, handoff %2 ms, max %3 ms, %4 frames coalesced)")
+                  .arg(m_simulation->recyclingFrames().currentSequence())
+                  .arg(latency.lastNs / 1e6, 0, 'f', 3)
+                  .arg(latency.maxNs / 1e6, 0, 'f', 3)
+                  .arg(latency.skipped));
 }
 
 void SmartRecyclingModule::onExportReport()
@@ -460,26 +542,70 @@ void SmartRecyclingModule::onExportReport()
 
 void SmartRecyclingModule::onNotifyCollection()
 {
-    addLogMessage("Collection team notified for full bins");
-    // Find and highlight full bins
-    for (int i = 0; i < m_binStatusTable->rowCount(); ++i) {
-        QString status = m_binStatusTable->item(i, 3)->text();
-        if (status == "Full") {
-            QString binId = m_binStatusTable->item(i, 0)->text();
-            emit binStatusChanged(binId, "Collection Notified");
+    // Plan rounds for every bin predicted to fill before the next sweep;
+    // the list is sorted, so the walk stops at the horizon. Trucks plan
+    // for the bin being full by the time they arrive.
+    const RecyclingSnapshot &frame = m_simulation->recyclingFrames().current();
+    const qint64 deadlineMs = QDateTime::currentMSecsSinceEpoch()
+            + static_cast<qint64>(COLLECTION_HORIZON_HOURS) * 3600 * 1000;
+    RoutePlanRequest request;
+    for (const BinForecast &forecast : frame.fullSoon) {
+        if (forecast.fullAtMs > deadlineMs) break;
+        const RecyclingBin &bin = frame.bins[forecast.bin];
+        request.stops.append({bin.id, bin.x, bin.y, RecyclingModel::BIN_CAPACITY_KG});
+    }
+    for (double capacity : FLEET_CAPACITIES_KG) request.truckCapacitiesKg.append(capacity);
+    
+    if (request.stops.isEmpty()) {
+        addLogMessage(QString("No bins predicted full within %1 h - no collection needed").arg(COLLECTION_HORIZON_HOURS));
+        return;
+    }
+    if (!m_routeOptimizer->planRoutes(request)) {
+        addLogMessage("Route planning already in progress");
+        return;
+    }
+    m_notifyBtn->setEnabled(false);
+    addLogMessage(QString("Planning collection routes for %1 bins...").arg(request.stops.size()));
+}
+
+void SmartRecyclingModule::onRoutesPlanned()
+{
+    m_notifyBtn->setEnabled(true);
+    
+    const RoutePlanRequest &request = m_routeOptimizer->request();
+    RoutePlan plan = m_routeOptimizer->plan();
+    if (!plan.valid) {
+        addLogMessage("Route planning failed - no trucks available");
+        return;
+    }
+    
+    for (const VehicleRoute &route : plan.routes) {
+        QStringList stops;
+        for (int stop : route.stops) {
+            stops.append(request.stops[stop].id);
+            emit binStatusChanged(request.stops[stop].id, "Collection Notified");
         }
+        addLogMessage(QString("Truck %1 trip %2: depot → %3 → depot (%4 kg, %5 km)")
+                      .arg(route.truck + 1).arg(route.trip).arg(stops.join(" → "))
+                      .arg(route.loadKg, 0, 'f', 0).arg(route.distanceMetres / 1000.0, 0, 'f', 1));
+    }
+    for (int stop : plan.unrouted) {
+        addLogMessage("⚠️ " + request.stops[stop].id + " exceeds every truck's capacity - manual pickup required");
     }
+    addLogMessage(QString("Collection team notified: %1 trips, %2 km total, planned in %3 ms")
+                  .arg(plan.routes.size()).arg(plan.totalDistanceMetres / 1000.0, 0, 'f', 1).arg(plan.planMs));
 }
 
 void SmartRecyclingModule::onSimulateBinFull()
 {
-    if (m_binStatusTable->rowCount() > 0) {
-        int randomRow = QRandomGenerator::global()->bounded(m_binStatusTable->rowCount());
-        m_binStatusTable->item(randomRow, 2)->setText("95%");
-        m_binStatusTable->item(randomRow, 3)->setText("Full");
-        m_binStatusTable->item(randomRow, 3)->setForeground(QBrush(QColor(COLOR_CRITICAL)));
+    const RecyclingSnapshot &frame = m_simulation->recyclingFrames().current();
+    if (!frame.bins.isEmpty()) {
+        int randomRow = QRandomGenerator::global()->bounded(frame.bins.size());
+        m_simulation->post([randomRow](RecyclingModel &recycling, LightingModel &) {
+            recycling.setFillLevel(randomRow, 95);
+        });
         
-        QString binId = m_binStatusTable->item(randomRow, 0)->text();
+        QString binId = frame.bins[randomRow].id;
         addLogMessage("⚠️ ALERT: " + binId + " is now FULL - immediate collection required!");
         emit binStatusChanged(binId, "Full");
     }
@@ -5,18 +5,21 @@
 #include <QTableWidget>
 #include <QLabel>
 #include <QPushButton>
-#include <QTimer>
 #include <QVector>
 #include <QtCharts/QChart>
 #include <QtCharts/QPieSeries>
 #include <QtCharts/QChartView>
+#include "simulationthread.h"
+#include "routeoptimizer.h"
+#include "rewardsledger.h"
+#include "pagelifecycle.h"
 
 class SmartRecyclingModule : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit SmartRecyclingModule(QWidget *parent = nullptr);
+    explicit SmartRecyclingModule(SimulationThread *simulation, QWidget *parent = nullptr);
     ~SmartRecyclingModule();
 
 signals:
@@ -30,6 +33,7 @@ private slots:
     void onExportReport();
     void onNotifyCollection();
     void onSimulateBinFull();
+    void onRoutesPlanned();
 
 private:
     // UI Creation Methods
@@ -45,10 +49,17 @@ private:
     QString getTableStyle();
     QString getButtonStyle(const QString &color);
     void updateBinStatus(const QString &binId, const QString &location, 
-                        int fillLevel, const QString &status);
-    void updateCitizenReward(const QString &name, double totalRecycled, double earned);
+                        int fillLevel, const QString &status, const QString &fullIn);
+    void creditCitizen(quint32 citizen, double kg, qint64 nowMs);
+    void refreshLeaderboard();
+    void showTotals();
+    void refreshWasteChart();
+    void refreshBinTable();
+    void setCitizenRow(int row, quint32 citizen);
     void addLogMessage(const QString &message);
-    int calculateFillLevel(const QString &binId);
+    void setBinRow(int row, const RecyclingBin &bin, const QString &fullIn);
+    QString binStatus(double fillLevel) const;
+    QString timeToFull(qint64 fullAtMs, qint64 nowMs) const;
     
     // KPI Components
     QLabel *m_totalRecycledLabel;
@@ -72,13 +83,23 @@ private:
     QPushButton *m_notifyBtn;
     QPushButton *m_simulateBtn;
     
-    // Data tracking
-    QTimer *m_updateTimer;
-    double m_totalRecycled;
-    double m_plasticTotal;
-    double m_metalTotal;
-    double m_glassTotal;
-    int m_activeBins;
+    // Widget regions posted to the UI scheduler
+    enum UiRegion {
+        KpiRegion,
+        BinTableRegion,
+        LeaderboardRegion,
+        ChartRegion
+    };
+    
+    // Data tracking (frames come from the simulation thread)
+    SimulationThread *m_simulation;
+    int m_updateTick;
+    PageLifecycle *m_lifecycle;
+    double m_totalRecycled;     // last rendered total
+    RouteOptimizer *m_routeOptimizer;
+    QVector<qint64> m_binFullAt;    // per table row, from the frame's full-soon list
+    RewardsLedger m_rewards;
+    quint64 m_leaderboardVersion;   // ledger version last rendered
     
     // Color definitions
     const QString COLOR_BACKGROUND = "#121212";
@@ -1,30 +1,63 @@
 #include "smartstationpage.h"
+#include "cityeventbus.h"
+#include "citystabilitymodel.h"
+#include "citylayout.h"
+#include "uiupdatescheduler.h"
+#include "metricsregistry.h"
+#include "tickdriver.h"
+#include "tracer.h"
+#include <QtMath>
 
 SmartStationPage::SmartStationPage(QWidget *parent)
     : QWidget(parent)
+    , nextVehicleReport(0)
     , nextStationId(1001)
-    , busArrivalSeconds(180)
 {
+    rfidIngest = new RfidIngest(&occupancyEngine);
+    
     createUI();
     applyDarkTheme();
     loadSampleData();
-    
-    // Setup timers
-    rfidUpdateTimer = new QTimer(this);
-    connect(rfidUpdateTimer, &QTimer::timeout, this, &SmartStationPage::updateRFIDLog);
-    rfidUpdateTimer->start(3000); // Update every 3 seconds
-    
-    busArrivalTimer = new QTimer(this);
-    connect(busArrivalTimer, &QTimer::timeout, this, &SmartStationPage::updateBusArrival);
-    busArrivalTimer->start(1000); // Update every second
-    
-    statsUpdateTimer = new QTimer(this);
-    connect(statsUpdateTimer, &QTimer::timeout, this, &SmartStationPage::updateStatistics);
-    statsUpdateTimer->start(5000); // Update every 5 seconds
+    loadTransitSchedule();
+    
+    // Fare gate reader; NEOCITY_RFID_TAPS_PER_SEC overrides the simulated load
+    rfidReader = new RfidReaderThread(rfidIngest->queue(), this);
+    bool rateSet = false;
+    int tapRate = qEnvironmentVariableIntValue("NEOCITY_RFID_TAPS_PER_SEC", &rateSet);
+    if (rateSet) rfidReader->setTapsPerSecond(tapRate);
+    rfidReader->setStationSlots(occupancyEngine.stationSlots());
+    rfidReader->start();
+    
+    // Setup ticks; taps are drained on the fastest shared wakeup
+    TickDriver *ticks = TickDriver::instance();
+    rfidUpdateTick = ticks->add("RFID log", TickDriver::BASE_TICK_MS, this, [this]() { updateRFIDLog(); });
+    busArrivalTick = ticks->add("Bus arrival", 1000, this, [this]() { updateBusArrival(); });
+    ticks->add("Station stats", 5000, this, [this]() { updateStatistics(); });
+    
+    // Hidden, taps are still drained into the occupancy engine, just in
+    // larger batches; bus positions are only needed for the arrival board
+    // and are recomputed from elapsed time when it is shown again
+    lifecycle = new PageLifecycle(this);
+    lifecycle->manage(rfidUpdateTick, 500, 1000);
+    lifecycle->manage(busArrivalTick, 5000, 0);
+    connect(lifecycle, &PageLifecycle::resumed, this, &SmartStationPage::updateRFIDLog);
+    connect(lifecycle, &PageLifecycle::resumed, this, &SmartStationPage::updateBusArrival);
+    
+    // The simulated gates slow down with the page and stop once it is suspended
+    connect(lifecycle, &PageLifecycle::stateChanged, this, [this](PageLifecycle::State state) {
+        rfidReader->setRateScale(state == PageLifecycle::Active ? 1.0
+                                 : state == PageLifecycle::Background ? BACKGROUND_TAP_SCALE : 0.0);
+    });
 }
 
 SmartStationPage::~SmartStationPage()
 {
+    rfidReader->requestInterruption();
+    rfidReader->wait();
+    // The log model reads the ingest's interning tables, and as a child it
+    // would otherwise outlive the ingest until QObject teardown
+    delete rfidLogModel;
+    delete rfidIngest;
 }
 
 void SmartStationPage::createUI()
@@ -242,9 +275,9 @@ QFrame* SmartStationPage::createStationManagementSection()
 void SmartStationPage::setupTable()
 {
     stationTable = new QTableWidget();
-    stationTable->setColumnCount(6);
+    stationTable->setColumnCount(7);
     stationTable->setHorizontalHeaderLabels({
-        "Station ID", "Location", "Capacity", "Current Passengers", "Occupancy %", "Status"
+        "Station ID", "Location", "Capacity", "Current Passengers", "Occupancy %", "Status", "Time to Full"
     });
     
     // Table styling
@@ -263,6 +296,7 @@ void SmartStationPage::setupTable()
     stationTable->setColumnWidth(2, 100);
     stationTable->setColumnWidth(3, 150);
     stationTable->setColumnWidth(4, 120);
+    stationTable->setColumnWidth(5, 120);
 }
 
 QFrame* SmartStationPage::createOccupancyChartSection()
@@ -329,24 +363,36 @@ QFrame* SmartStationPage::createRFIDLogSection()
     QVBoxLayout *rfidLayout = new QVBoxLayout(rfidFrame);
     rfidLayout->setContentsMargins(15, 15, 15, 15);
     
+    QHBoxLayout *rfidHeaderLayout = new QHBoxLayout();
+    
     QLabel *rfidTitle = new QLabel("📡 Real-Time RFID Tap Log");
     rfidTitle->setStyleSheet("font-size: 15px; font-weight: bold; color: white;");
     
-    rfidLogTable = new QTableWidget();
-    rfidLogTable->setColumnCount(3);
-    rfidLogTable->setHorizontalHeaderLabels({"Timestamp", "Passenger ID", "Station ID"});
-    rfidLogTable->setMinimumHeight(180);
-    rfidLogTable->setSelectionMode(QAbstractItemView::NoSelection);
-    rfidLogTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    rfidLogTable->setAlternatingRowColors(true);
-    rfidLogTable->verticalHeader()->setVisible(false);
-    rfidLogTable->horizontalHeader()->setStretchLastSection(true);
-    rfidLogTable->setColumnWidth(0, 140);
-    rfidLogTable->setColumnWidth(1, 130);
-    rfidLogTable->setShowGrid(true);
-    
-    rfidLayout->addWidget(rfidTitle);
-    rfidLayout->addWidget(rfidLogTable, 1);
+    rfidRateLabel = new QLabel("0 taps/s");
+    rfidRateLabel->setStyleSheet("font-size: 12px; color: #B0B0B0;");
+    
+    rfidHeaderLayout->addWidget(rfidTitle);
+    rfidHeaderLayout->addStretch();
+    rfidHeaderLayout->addWidget(rfidRateLabel);
+    
+    rfidLogModel = new RfidLogModel(rfidIngest, this);
+    
+    rfidLogView = new QTableView();
+    rfidLogView->setModel(rfidLogModel);
+    rfidLogView->setMinimumHeight(180);
+    rfidLogView->setSelectionMode(QAbstractItemView::NoSelection);
+    rfidLogView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    rfidLogView->setAlternatingRowColors(true);
+    rfidLogView->verticalHeader()->setVisible(false);
+    rfidLogView->verticalHeader()->setDefaultSectionSize(24);
+    rfidLogView->horizontalHeader()->setStretchLastSection(true);
+    rfidLogView->setColumnWidth(0, 140);
+    rfidLogView->setColumnWidth(1, 130);
+    rfidLogView->setColumnWidth(2, 100);
+    rfidLogView->setShowGrid(true);
+    
+    rfidLayout->addLayout(rfidHeaderLayout);
+    rfidLayout->addWidget(rfidLogView, 1);
     
     return rfidFrame;
 }
@@ -367,13 +413,13 @@ QFrame* SmartStationPage::createBusArrivalSection()
     busArrivalLabel->setAlignment(Qt::AlignCenter);
     busArrivalLabel->setStyleSheet("font-size: 36px; font-weight: bold; color: #1E90FF; padding: 20px;");
     
-    QLabel *subLabel = new QLabel("Minutes:Seconds");
-    subLabel->setAlignment(Qt::AlignCenter);
-    subLabel->setStyleSheet("font-size: 12px; color: #AAAAAA;");
+    busRouteLabel = new QLabel("Minutes:Seconds");
+    busRouteLabel->setAlignment(Qt::AlignCenter);
+    busRouteLabel->setStyleSheet("font-size: 12px; color: #AAAAAA;");
     
     busLayout->addWidget(busTitle);
     busLayout->addWidget(busArrivalLabel);
-    busLayout->addWidget(subLabel);
+    busLayout->addWidget(busRouteLabel);
     
     return busFrame;
 }
@@ -411,18 +457,54 @@ void SmartStationPage::loadSampleData()
     stations.clear();
     
     // Sample stations
-    stations.append({"ST-1001", "Downtown Central", 500, 456, "Full"});
-    stations.append({"ST-1002", "North District", 400, 234, "Operational"});
-    stations.append({"ST-1003", "East Terminal", 600, 289, "Operational"});
-    stations.append({"ST-1004", "West Plaza", 450, 445, "Full"});
-    stations.append({"ST-1005", "South Gate", 350, 120, "Operational"});
-    stations.append({"ST-1006", "Airport Link", 550, 0, "Maintenance"});
-    stations.append({"ST-1007", "University Hub", 480, 370, "Operational"});
-    stations.append({"ST-1008", "Business Park", 420, 315, "Operational"});
+    stations.append({"ST-1001", "Downtown Central", 500, 456, "Full", -1});
+    stations.append({"ST-1002", "North District", 400, 234, "Operational", -1});
+    stations.append({"ST-1003", "East Terminal", 600, 289, "Operational", -1});
+    stations.append({"ST-1004", "West Plaza", 450, 445, "Full", -1});
+    stations.append({"ST-1005", "South Gate", 350, 120, "Operational", -1});
+    stations.append({"ST-1006", "Airport Link", 550, 0, "Maintenance", -1});
+    stations.append({"ST-1007", "University Hub", 480, 370, "Operational", -1});
+    stations.append({"ST-1008", "Business Park", 420, 315, "Operational", -1});
     
     nextStationId = 1009;
     
-    // Populate table
+    // Seed the occupancy engine; from here on counts move only through taps
+    for (Station &station : stations) {
+        station.engineIndex = occupancyEngine.addStation(station.id, station.capacity,
+                                                         station.currentPassengers);
+        occupancyEngine.setInService(station.engineIndex, station.status != "Maintenance");
+        CityLayout::instance()->place(CityLayout::Station, station.id, station.location);
+    }
+    occupancyEngine.tick(QDateTime::currentMSecsSinceEpoch());
+    
+    refreshStationTable();
+}
+
+void SmartStationPage::refreshStationTable()
+{
+    // Pull derived occupancy and predicted status from the engine
+    for (Station &station : stations) {
+        int index = station.engineIndex;
+        station.currentPassengers = occupancyEngine.occupancy(index);
+        if (!occupancyEngine.isInService(index)) {
+            station.status = "Maintenance";
+        } else if (occupancyEngine.isFull(index)) {
+            station.status = "Full";
+        } else {
+            station.status = "Operational";
+        }
+        CityLayout::instance()->setValue(CityLayout::Station, station.id, occupancyEngine.occupancyPercent(index) / 100.0);
+    }
+    
+    UiUpdateScheduler *ui = UiUpdateScheduler::instance();
+    ui->post(this, KpiRegion, UiUpdateScheduler::High, [this]() { updateKPICards(); });
+    ui->post(this, StationTableRegion, UiUpdateScheduler::Normal, [this]() { populateStationTable(); });
+    ui->post(this, OccupancyChartRegion, UiUpdateScheduler::Low, [this]() { updateOccupancyChart(); });
+}
+
+void SmartStationPage::populateStationTable()
+{
+    SCOPED_LATENCY("table_update_us", "Station");
     stationTable->setRowCount(stations.size());
     for (int i = 0; i < stations.size(); ++i) {
         const Station &station = stations[i];
@@ -432,16 +514,26 @@ void SmartStationPage::loadSampleData()
         stationTable->setItem(i, 2, new QTableWidgetItem(QString::number(station.capacity)));
         stationTable->setItem(i, 3, new QTableWidgetItem(QString::number(station.currentPassengers)));
         
-        int occupancy = (station.currentPassengers * 100) / station.capacity;
-        stationTable->setItem(i, 4, new QTableWidgetItem(QString::number(occupancy) + "%"));
+        double occupancy = occupancyEngine.occupancyPercent(station.engineIndex);
+        stationTable->setItem(i, 4, new QTableWidgetItem(QString::number(occupancy, 'f', 1) + "%"));
         
         QTableWidgetItem *statusItem = new QTableWidgetItem(station.status);
         statusItem->setForeground(QBrush(QColor(getStatusColor(station.status))));
         stationTable->setItem(i, 5, statusItem);
+        
+        double minutesToFull = occupancyEngine.minutesToFull(station.engineIndex);
+        QString eta = "--";
+        if (minutesToFull == 0.0) {
+            eta = "Full";
+        } else if (minutesToFull > 0.0 && minutesToFull < 600.0) {
+            eta = QString("~%1 min").arg(qCeil(minutesToFull));
+        }
+        QTableWidgetItem *etaItem = new QTableWidgetItem(eta);
+        if (minutesToFull >= 0.0 && minutesToFull <= StationOccupancyEngine::FULL_HORIZON_MINUTES) {
+            etaItem->setForeground(QBrush(QColor(getStatusColor("Full"))));
+        }
+        stationTable->setItem(i, 6, etaItem);
     }
-    
-    updateKPICards();
-    updateOccupancyChart();
 }
 
 void SmartStationPage::updateKPICards()
@@ -449,34 +541,34 @@ void SmartStationPage::updateKPICards()
     int totalStations = stations.size();
     int fullStations = 0;
     int totalPassengers = 0;
-    int totalOccupancy = 0;
+    double totalOccupancy = 0.0;
     
     for (const Station &station : stations) {
         if (station.status == "Full") fullStations++;
         totalPassengers += station.currentPassengers;
-        if (station.capacity > 0) {
-            totalOccupancy += (station.currentPassengers * 100) / station.capacity;
-        }
+        totalOccupancy += occupancyEngine.occupancyPercent(station.engineIndex);
     }
     
-    int avgOccupancy = totalStations > 0 ? totalOccupancy / totalStations : 0;
+    double avgOccupancy = totalStations > 0 ? totalOccupancy / totalStations : 0.0;
     
     totalStationsLabel->setText(QString::number(totalStations));
     stationsFullLabel->setText(QString::number(fullStations));
     totalPassengersLabel->setText(QString::number(totalPassengers));
-    avgOccupancyLabel->setText(QString::number(avgOccupancy) + "%");
+    avgOccupancyLabel->setText(QString::number(avgOccupancy, 'f', 1) + "%");
 }
 
 void SmartStationPage::updateOccupancyChart()
 {
+    SCOPED_LATENCY("chart_update_us", "Station");
+    TRACE_SCOPE("SmartStationPage::updateOccupancyChart");
     int fullCount = 0;
     int almostFullCount = 0;
     int availableCount = 0;
     
     for (const Station &station : stations) {
-        int occupancy = (station.currentPassengers * 100) / station.capacity;
+        double occupancy = occupancyEngine.occupancyPercent(station.engineIndex);
         
-        if (occupancy >= 90) fullCount++;
+        if (occupancy >= 90.0) fullCount++;
         else if (occupancy >= 70) almostFullCount++;
         else availableCount++;
     }
@@ -554,9 +646,15 @@ void SmartStationPage::onAddStationClicked()
         newStation.capacity = capacitySpin->value();
         newStation.currentPassengers = passengersSpin->value();
         newStation.status = statusCombo->currentText();
+        newStation.engineIndex = occupancyEngine.addStation(newStation.id, newStation.capacity,
+                                                            newStation.currentPassengers);
+        occupancyEngine.setInService(newStation.engineIndex, newStation.status != "Maintenance");
         
         stations.append(newStation);
-        loadSampleData();
+        CityLayout::instance()->place(CityLayout::Station, newStation.id, newStation.location);
+        rfidReader->setStationSlots(occupancyEngine.stationSlots());
+        transitEngine.setStopCount(occupancyEngine.stationSlots());
+        refreshStationTable();
         
         QMessageBox::information(this, "Success", "Station added successfully!");
     }
@@ -618,11 +716,17 @@ void SmartStationPage::onEditStationClicked()
     
     if (dialog.exec() == QDialog::Accepted) {
         station.location = locationEdit->text();
+        CityLayout::instance()->place(CityLayout::Station, station.id, station.location);
         station.capacity = capacitySpin->value();
         station.currentPassengers = passengersSpin->value();
         station.status = statusCombo->currentText();
         
-        loadSampleData();
+        // Operator values override the tap-derived count
+        occupancyEngine.setCapacity(station.engineIndex, station.capacity);
+        occupancyEngine.setOccupancy(station.engineIndex, station.currentPassengers);
+        occupancyEngine.setInService(station.engineIndex, station.status != "Maintenance");
+        
+        refreshStationTable();
         QMessageBox::information(this, "Success", "Station updated successfully!");
     }
 }
@@ -647,8 +751,10 @@ void SmartStationPage::onDeleteStationClicked()
     );
     
     if (reply == QMessageBox::Yes) {
+        occupancyEngine.removeStation(stations[currentRow].id);
+        CityLayout::instance()->remove(CityLayout::Station, stations[currentRow].id);
         stations.removeAt(currentRow);
-        loadSampleData();
+        refreshStationTable();
         QMessageBox::information(this, "Success", "Station deleted successfully!");
     }
 }
@@ -704,35 +810,118 @@ void SmartStationPage::onExportPDFClicked()
 
 void SmartStationPage::updateRFIDLog()
 {
-    // Simulate new RFID tap
-    QDateTime now = QDateTime::currentDateTime();
-    QString timestamp = now.toString("hh:mm:ss");
-    QString passengerId = QString("PASS-%1").arg(QRandomGenerator::global()->bounded(10000, 99999));
-    QString stationId = stations.isEmpty() ? "ST-1001" : 
-                        stations[QRandomGenerator::global()->bounded(stations.size())].id;
-    
-    // Add to top of table
-    rfidLogTable->insertRow(0);
-    rfidLogTable->setItem(0, 0, new QTableWidgetItem(timestamp));
-    rfidLogTable->setItem(0, 1, new QTableWidgetItem(passengerId));
-    rfidLogTable->setItem(0, 2, new QTableWidgetItem(stationId));
-    
-    // Keep only last 10 entries
-    while (rfidLogTable->rowCount() > 10) {
-        rfidLogTable->removeRow(rfidLogTable->rowCount() - 1);
+    // Consume whatever the reader queued since the last frame; the model
+    // notifies the view once no matter how many taps arrived
+    static MetricCounter *taps = MetricsRegistry::instance()->counter("events_total", "RFID taps");
+    static MetricGauge *depth = MetricsRegistry::instance()->gauge("queue_depth", "RFID taps");
+    depth->set(rfidIngest->queue()->size());
+    taps->add(rfidIngest->drain(rfidLogModel));
+    UiUpdateScheduler::instance()->post(this, RfidLogRegion, UiUpdateScheduler::Normal, [this]() {
+        showRFIDLog();
+    });
+}
+
+void SmartStationPage::showRFIDLog()
+{
+    SCOPED_LATENCY("log_update_us", "Station");
+    rfidLogModel->publish();
+    
+    QString rateText = QString("%1 taps/s  •  %2 passengers")
+        .arg(qRound(rfidIngest->tapsPerSecond()))
+        .arg(rfidIngest->passengerCount());
+    if (rfidRateLabel->text() != rateText) {
+        rfidRateLabel->setText(rateText);
+    }
+}
+
+void SmartStationPage::loadTransitSchedule()
+{
+    // Static loop routes over the sample stations: stop sequence and
+    // scheduled seconds to the next stop
+    struct RouteDef {
+        QString name;
+        QStringList stationIds;
+        QVector<int> legSeconds;
+    };
+    const QList<RouteDef> routes = {
+        {"Route 1", {"ST-1001", "ST-1002", "ST-1003", "ST-1007", "ST-1008"}, {240, 300, 180, 240, 360}},
+        {"Route 2", {"ST-1001", "ST-1004", "ST-1005", "ST-1006"}, {300, 240, 420, 420}},
+        {"Route 3", {"ST-1007", "ST-1003", "ST-1008", "ST-1004"}, {180, 240, 300, 300}}
+    };
+    const int vehiclesPerRoute = 3;
+    
+    transitEngine.setStopCount(occupancyEngine.stationSlots());
+    
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    int busNumber = 101;
+    for (const RouteDef &def : routes) {
+        QVector<int> stops;
+        for (const QString &id : def.stationIds) {
+            stops.append(occupancyEngine.stationIndex(id));
+        }
+        int route = transitEngine.addRoute(def.name, stops, def.legSeconds);
+        if (route < 0) continue;
+        
+        // Space buses evenly around the loop
+        int loop = transitEngine.routeLoopSeconds(route);
+        for (int k = 0; k < vehiclesPerRoute; ++k) {
+            transitEngine.addVehicle(QString("BUS-%1").arg(busNumber++), route,
+                                     loop * k / double(vehiclesPerRoute), now);
+        }
+    }
+    transitEngine.rebuildStopIndex();
+}
+
+void SmartStationPage::simulateVehicleFeed(qint64 nowMs)
+{
+    // Simulated AVL feed: each bus reports roughly every 10 seconds with
+    // traffic-dependent progress; reports are spread across ticks
+    int vehicles = transitEngine.vehicleCount();
+    if (vehicles == 0) return;
+    
+    int reports = qMax(1, vehicles / 10);
+    for (int i = 0; i < reports; ++i) {
+        int vehicle = nextVehicleReport;
+        nextVehicleReport = (nextVehicleReport + 1) % vehicles;
+        
+        double elapsed = (nowMs - transitEngine.vehicleReportMs(vehicle)) / 1000.0;
+        double pace = 0.7 + QRandomGenerator::global()->bounded(50) / 100.0;
+        transitEngine.updateVehicle(vehicle, transitEngine.vehicleProgress(vehicle) + elapsed * pace, nowMs);
+    }
+}
+
+int SmartStationPage::selectedStationSlot() const
+{
+    int row = stationTable->currentRow();
+    if (row >= 0 && stationTable->item(row, 0)) {
+        return occupancyEngine.stationIndex(stationTable->item(row, 0)->text());
     }
+    return stations.isEmpty() ? -1 : stations.first().engineIndex;
 }
 
 void SmartStationPage::updateBusArrival()
 {
-    busArrivalSeconds--;
-    
-    if (busArrivalSeconds <= 0) {
-        busArrivalSeconds = QRandomGenerator::global()->bounded(120, 300); // 2-5 minutes
+    simulateVehicleFeed(QDateTime::currentMSecsSinceEpoch());
+    UiUpdateScheduler::instance()->post(this, BusArrivalRegion, UiUpdateScheduler::High, [this]() {
+        showBusArrival();
+    });
+}
+
+void SmartStationPage::showBusArrival()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    int station = selectedStationSlot();
+    int arrivalSeconds = transitEngine.secondsUntilArrival(station, now);
+    
+    if (arrivalSeconds < 0) {
+        busArrivalLabel->setText("--:--");
+        busArrivalLabel->setStyleSheet("font-size: 36px; font-weight: bold; color: #AAAAAA; padding: 20px;");
+        busRouteLabel->setText(QString("No scheduled service at %1").arg(occupancyEngine.stationId(station)));
+        return;
     }
     
-    int minutes = busArrivalSeconds / 60;
-    int seconds = busArrivalSeconds % 60;
+    int minutes = arrivalSeconds / 60;
+    int seconds = arrivalSeconds % 60;
     
     QString timeText = QString("%1:%2")
         .arg(minutes, 2, 10, QChar('0'))
@@ -740,10 +929,16 @@ void SmartStationPage::updateBusArrival()
     
     busArrivalLabel->setText(timeText);
     
+    int vehicle = transitEngine.nextArrivalVehicle(station, now);
+    busRouteLabel->setText(QString("%1 (%2) → %3")
+        .arg(transitEngine.routeName(transitEngine.vehicleRoute(vehicle)))
+        .arg(transitEngine.vehicleId(vehicle))
+        .arg(occupancyEngine.stationId(station)));
+    
     // Change color based on time
-    if (busArrivalSeconds < 30) {
+    if (arrivalSeconds < 30) {
         busArrivalLabel->setStyleSheet("font-size: 36px; font-weight: bold; color: #00C853; padding: 20px;");
-    } else if (busArrivalSeconds < 60) {
+    } else if (arrivalSeconds < 60) {
         busArrivalLabel->setStyleSheet("font-size: 36px; font-weight: bold; color: #FF9800; padding: 20px;");
     } else {
         busArrivalLabel->setStyleSheet("font-size: 36px; font-weight: bold; color: #1E90FF; padding: 20px;");
@@ -752,23 +947,33 @@ void SmartStationPage::updateBusArrival()
 
 void SmartStationPage::updateStatistics()
 {
-    // Simulate passenger count changes
-    for (Station &station : stations) {
-        if (station.status != "Maintenance") {
-            int change = QRandomGenerator::global()->bounded(-10, 15);
-            station.currentPassengers = qBound(0, station.currentPassengers + change, station.capacity);
-            
-            // Update status based on occupancy
-            int occupancy = (station.currentPassengers * 100) / station.capacity;
-            if (occupancy >= 95) {
-                station.status = "Full";
-            } else if (station.status == "Full" && occupancy < 90) {
-                station.status = "Operational";
-            }
+    TRACE_SCOPE("SmartStationPage::updateStatistics");
+    // Close elapsed minutes, refresh forecasts and predicted Full flags
+    occupancyEngine.tick(QDateTime::currentMSecsSinceEpoch());
+    refreshStationTable();
+    publishStationTaps();
+}
+
+void SmartStationPage::publishStationTaps()
+{
+    // Taps per station since the previous statistics tick
+    CityEventBus *bus = CityEventBus::instance();
+    CityStabilityModel *stability = CityStabilityModel::instance();
+    for (const Station &station : stations) {
+        int slot = station.engineIndex;
+        quint64 taps = rfidIngest->stationEntries(slot) + rfidIngest->stationExits(slot);
+        // Stations are not visited in slot order, so every new slot starts
+        // unpublished rather than at zero
+        if (slot >= publishedTaps.size()) publishedTaps.resize(slot + 1, NO_TAPS_PUBLISHED);
+        if (publishedTaps[slot] == NO_TAPS_PUBLISHED) {
+            // First tick for this station only sets the starting point
+            publishedTaps[slot] = taps;
+            stability->assignSensor(bus->sensorId(station.id), stability->zone(station.location));
+            continue;
         }
+        bus->publish(EVENT_STATION_TAPS, bus->sensorId(station.id), taps - publishedTaps[slot]);
+        publishedTaps[slot] = taps;
     }
-    
-    loadSampleData();
 }
 
 QString SmartStationPage::getStatusColor(const QString &status)
@@ -802,7 +1007,7 @@ void SmartStationPage::applyDarkTheme()
             border: 1px solid #2A2A2A;
         }
         
-        QTableWidget {
+        QTableView {
             background-color: #1E1E1E;
             alternate-background-color: #252525;
             gridline-color: #2A2A2A;
@@ -811,7 +1016,7 @@ void SmartStationPage::applyDarkTheme()
             border-radius: 5px;
         }
         
-        QTableWidget::item {
+        QTableView::item {
             padding: 8px;
         }
         
@@ -9,10 +9,10 @@
 #include <QFrame>
 #include <QPushButton>
 #include <QTableWidget>
+#include <QTableView>
 #include <QHeaderView>
 #include <QLineEdit>
 #include <QComboBox>
-#include <QTimer>
 #include <QDateTime>
 #include <QRandomGenerator>
 #include <QDialog>
@@ -24,6 +24,11 @@
 #include <QtCharts/QPieSeries>
 #include <QtCharts/QChart>
 #include <QtCharts/QLegend>
+#include "stationoccupancyengine.h"
+#include "rfidingest.h"
+#include "rfidlogmodel.h"
+#include "transitscheduleengine.h"
+#include "pagelifecycle.h"
 
 class SmartStationPage : public QWidget
 {
@@ -32,6 +37,11 @@ class SmartStationPage : public QWidget
 public:
     explicit SmartStationPage(QWidget *parent = nullptr);
     ~SmartStationPage();
+    
+    // Share of the configured tap rate the reader generates while hidden
+    static constexpr double BACKGROUND_TAP_SCALE = 0.25;
+    // publishedTaps entry of a slot whose station has not reported yet
+    static constexpr quint64 NO_TAPS_PUBLISHED = ~quint64(0);
 
 private slots:
     void onAddStationClicked();
@@ -62,6 +72,14 @@ private:
     QFrame* createCard(const QString &title, const QString &value, const QString &color);
     void setupTable();
     void loadSampleData();
+    void refreshStationTable();
+    void populateStationTable();
+    void showRFIDLog();
+    void showBusArrival();
+    void loadTransitSchedule();
+    void simulateVehicleFeed(qint64 nowMs);
+    int selectedStationSlot() const;
+    void publishStationTaps();
     void updateKPICards();
     void updateOccupancyChart();
     void applyDarkTheme();
@@ -92,16 +110,36 @@ private:
     QPieSeries *occupancySeries;
     
     // RFID Log
-    QTableWidget *rfidLogTable;
+    QTableView *rfidLogView;
+    RfidLogModel *rfidLogModel;
+    QLabel *rfidRateLabel;
+    
+    // RFID ingest: reader thread -> SPSC queue -> drained at display rate
+    RfidIngest *rfidIngest;
+    RfidReaderThread *rfidReader;
+    QVector<quint64> publishedTaps;   // per station slot, for the event bus
     
     // Bus Arrival
     QLabel *busArrivalLabel;
-    QTimer *busArrivalTimer;
-    int busArrivalSeconds;
+    QLabel *busRouteLabel;
+    int busArrivalTick;
+    
+    // Transit schedule and live vehicle positions
+    TransitScheduleEngine transitEngine;
+    int nextVehicleReport;
     
-    // Update Timers
-    QTimer *rfidUpdateTimer;
-    QTimer *statsUpdateTimer;
+    // Update ticks
+    int rfidUpdateTick;
+    PageLifecycle *lifecycle;
+    
+    // Widget regions posted to the UI scheduler
+    enum UiRegion {
+        KpiRegion,
+        StationTableRegion,
+        OccupancyChartRegion,
+        RfidLogRegion,
+        BusArrivalRegion
+    };
     
     // Data Storage
     struct Station {
@@ -110,10 +148,14 @@ private:
         int capacity;
         int currentPassengers;
         QString status;
+        int engineIndex;
     };
     
     QList<Station> stations;
     int nextStationId;
+    
+    // Occupancy derived from RFID taps, with time-to-full forecasting
+    StationOccupancyEngine occupancyEngine;
 };
 
 #endif // SMARTSTATIONPAGE_H
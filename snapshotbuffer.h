@@ -0,0 +1,98 @@
+#ifndef SNAPSHOTBUFFER_H
+#define SNAPSHOTBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+
+// Consumer-side handoff statistics, in nanoseconds
+struct SnapshotLatency
+{
+    qint64 lastNs = 0;
+    qint64 maxNs = 0;
+    double meanNs = 0.0;      // EWMA
+    quint64 frames = 0;       // snapshots taken by the consumer
+    quint64 skipped = 0;      // published but superseded before being read
+};
+
+// Lock-free triple buffer for one producer and one consumer thread.
+// The producer fills the back slot and swaps it with the middle slot; the
+// consumer swaps the middle slot into front only when it holds a newer
+// frame. Neither side ever waits, the consumer always reads a complete
+// frame, and the frame it holds stays untouched until its next update().
+// T is expected to use implicitly shared Qt containers so filling a slot
+// from the model's state is a reference-count bump, not a deep copy.
+template <typename T>
+class SnapshotBuffer
+{
+public:
+    SnapshotBuffer()
+        : m_middle(1)
+        , m_back(2)
+        , m_nextSequence(1)
+        , m_front(0)
+    {
+        for (int i = 0; i < 3; ++i) {
+            m_sequence[i] = 0;
+            m_publishedNs[i] = 0;
+        }
+    }
+
+    static qint64 monotonicNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Producer side
+    T &writeSlot() { return m_slots[m_back]; }
+
+    void publish()
+    {
+        m_sequence[m_back] = m_nextSequence++;
+        m_publishedNs[m_back] = monotonicNs();
+        int previous = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+        m_back = previous & INDEX_MASK;
+    }
+
+    // Consumer side; returns true when a newer frame was taken
+    bool update()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+
+        quint64 previousSequence = m_sequence[m_front];
+        int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & INDEX_MASK;
+
+        qint64 latency = monotonicNs() - m_publishedNs[m_front];
+        m_latency.lastNs = latency;
+        m_latency.maxNs = qMax(m_latency.maxNs, latency);
+        m_latency.meanNs = m_latency.frames == 0
+                ? latency : 0.9 * m_latency.meanNs + 0.1 * latency;
+        if (previousSequence > 0 && m_sequence[m_front] > previousSequence + 1) {
+            m_latency.skipped += m_sequence[m_front] - previousSequence - 1;
+        }
+        ++m_latency.frames;
+        return true;
+    }
+
+    const T &current() const { return m_slots[m_front]; }
+    quint64 currentSequence() const { return m_sequence[m_front]; }
+    const SnapshotLatency &latency() const { return m_latency; }
+
+private:
+    static const int FRESH = 0x4;
+    static const int INDEX_MASK = 0x3;
+
+    T m_slots[3];
+    quint64 m_sequence[3];
+    qint64 m_publishedNs[3];
+
+    alignas(64) std::atomic<int> m_middle;   // slot index | FRESH
+    alignas(64) int m_back;                  // producer only
+    quint64 m_nextSequence;                  // producer only
+    alignas(64) int m_front;                 // consumer only
+    SnapshotLatency m_latency;               // consumer only
+};
+
+#endif // SNAPSHOTBUFFER_H
@@ -0,0 +1,201 @@
+#include "spatialindex.h"
+#include <cmath>
+
+SpatialIndex::SpatialIndex(double cellMetres)
+    : m_cellMetres(cellMetres)
+    , m_count(0)
+    , m_minCellX(0)
+    , m_minCellY(0)
+    , m_maxCellX(-1)
+    , m_maxCellY(-1)
+{
+}
+
+int SpatialIndex::cellCoord(double value) const
+{
+    return static_cast<int>(std::floor(value / m_cellMetres));
+}
+
+quint64 SpatialIndex::cellKey(int cx, int cy)
+{
+    return (static_cast<quint64>(static_cast<quint32>(cx)) << 32) | static_cast<quint32>(cy);
+}
+
+int SpatialIndex::insert(int type, double x, double y)
+{
+    int handle;
+    if (!m_free.isEmpty()) {
+        handle = m_free.takeLast();
+    } else {
+        handle = m_entries.size();
+        m_entries.append(Entry());
+    }
+    Entry &entry = m_entries[handle];
+    entry.type = type;
+    entry.x = x;
+    entry.y = y;
+    addToCell(handle);
+    ++m_count;
+    return handle;
+}
+
+void SpatialIndex::move(int handle, double x, double y)
+{
+    if (!contains(handle)) return;
+    Entry &entry = m_entries[handle];
+    quint64 cell = cellKey(cellCoord(x), cellCoord(y));
+    if (cell != entry.cell) {
+        removeFromCell(handle);
+        entry.x = x;
+        entry.y = y;
+        addToCell(handle);
+    } else {
+        entry.x = x;
+        entry.y = y;
+    }
+}
+
+void SpatialIndex::remove(int handle)
+{
+    if (!contains(handle)) return;
+    removeFromCell(handle);
+    m_entries[handle].type = -1;
+    m_free.append(handle);
+    --m_count;
+}
+
+bool SpatialIndex::contains(int handle) const
+{
+    return handle >= 0 && handle < m_entries.size() && m_entries[handle].type >= 0;
+}
+
+void SpatialIndex::addToCell(int handle)
+{
+    Entry &entry = m_entries[handle];
+    int cx = cellCoord(entry.x);
+    int cy = cellCoord(entry.y);
+    entry.cell = cellKey(cx, cy);
+    m_cells[entry.cell].append(handle);
+
+    if (m_maxCellX < m_minCellX) {
+        m_minCellX = m_maxCellX = cx;
+        m_minCellY = m_maxCellY = cy;
+    } else {
+        m_minCellX = qMin(m_minCellX, cx);
+        m_maxCellX = qMax(m_maxCellX, cx);
+        m_minCellY = qMin(m_minCellY, cy);
+        m_maxCellY = qMax(m_maxCellY, cy);
+    }
+}
+
+void SpatialIndex::removeFromCell(int handle)
+{
+    const quint64 cell = m_entries[handle].cell;
+    QVector<int> &members = m_cells[cell];
+    int index = members.indexOf(handle);
+    if (index >= 0) {
+        members[index] = members.last();
+        members.removeLast();
+    }
+    if (members.isEmpty()) m_cells.remove(cell);
+}
+
+int SpatialIndex::withinRadius(double x, double y, double radius, quint32 typeMask, QVector<int> &out) const
+{
+    const double radiusSquared = radius * radius;
+    int count = 0;
+    for (int cx = cellCoord(x - radius); cx <= cellCoord(x + radius); ++cx) {
+        for (int cy = cellCoord(y - radius); cy <= cellCoord(y + radius); ++cy) {
+            QHash<quint64, QVector<int>>::const_iterator it = m_cells.constFind(cellKey(cx, cy));
+            if (it == m_cells.constEnd()) continue;
+            for (int handle : it.value()) {
+                const Entry &entry = m_entries[handle];
+                if (!(typeMask & typeBit(entry.type))) continue;
+                double dx = entry.x - x;
+                double dy = entry.y - y;
+                if (dx * dx + dy * dy <= radiusSquared) {
+                    out.append(handle);
+                    ++count;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+int SpatialIndex::withinBox(double minX, double minY, double maxX, double maxY, quint32 typeMask, QVector<int> &out) const
+{
+    int count = 0;
+    for (int cx = cellCoord(minX); cx <= cellCoord(maxX); ++cx) {
+        for (int cy = cellCoord(minY); cy <= cellCoord(maxY); ++cy) {
+            QHash<quint64, QVector<int>>::const_iterator it = m_cells.constFind(cellKey(cx, cy));
+            if (it == m_cells.constEnd()) continue;
+            for (int handle : it.value()) {
+                const Entry &entry = m_entries[handle];
+                if (!(typeMask & typeBit(entry.type))) continue;
+                if (entry.x >= minX && entry.x <= maxX && entry.y >= minY && entry.y <= maxY) {
+                    out.append(handle);
+                    ++count;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+int SpatialIndex::nearest(double x, double y, int k, quint32 typeMask, QVector<int> &out, int exclude) const
+{
+    if (k <= 0 || m_count == 0) return 0;
+
+    // Best k so far, sorted by squared distance
+    QVector<int> best;
+    QVector<double> bestDistance;
+    best.reserve(k + 1);
+    bestDistance.reserve(k + 1);
+
+    const int cx = cellCoord(x);
+    const int cy = cellCoord(y);
+    // Distance from the point to the edge of its own cell
+    const double fx = x - cx * m_cellMetres;
+    const double fy = y - cy * m_cellMetres;
+    const double edge = qMin(qMin(fx, m_cellMetres - fx), qMin(fy, m_cellMetres - fy));
+    const int maxRing = qMax(qMax(cx - m_minCellX, m_maxCellX - cx), qMax(cy - m_minCellY, m_maxCellY - cy));
+
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        // Nothing outside the rings walked so far can be closer than this
+        if (best.size() == k) {
+            double reach = (ring - 1) * m_cellMetres + edge;
+            if (reach > 0.0 && reach * reach >= bestDistance.last()) break;
+        }
+
+        for (int gx = cx - ring; gx <= cx + ring; ++gx) {
+            // Only the perimeter of the ring; the inside was walked already
+            int step = (gx == cx - ring || gx == cx + ring) ? 1 : 2 * ring;
+            for (int gy = cy - ring; gy <= cy + ring; gy += qMax(step, 1)) {
+                QHash<quint64, QVector<int>>::const_iterator it = m_cells.constFind(cellKey(gx, gy));
+                if (it == m_cells.constEnd()) continue;
+                for (int handle : it.value()) {
+                    if (handle == exclude) continue;
+                    const Entry &entry = m_entries[handle];
+                    if (!(typeMask & typeBit(entry.type))) continue;
+                    double dx = entry.x - x;
+                    double dy = entry.y - y;
+                    double distance = dx * dx + dy * dy;
+                    if (best.size() == k && distance >= bestDistance.last()) continue;
+
+                    int position = best.size();
+                    while (position > 0 && bestDistance[position - 1] > distance) --position;
+                    best.insert(position, handle);
+                    bestDistance.insert(position, distance);
+                    if (best.size() > k) {
+                        best.removeLast();
+                        bestDistance.removeLast();
+                    }
+                }
+            }
+        }
+    }
+
+    out.append(best);
+    return best.size();
+}
@@ -0,0 +1,65 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <QVector>
+#include <QHash>
+
+// Points of several entity types in city metres, bucketed in a uniform
+// grid of square cells. Only occupied cells are stored (hashed by cell
+// coordinates), so the city can grow in any direction, and a query only
+// visits the cells its shape overlaps; nearest-k walks rings of cells
+// outward and stops once no unvisited cell can beat the k-th candidate.
+// Types are small integers (< 32) so queries can filter with a bit mask.
+class SpatialIndex
+{
+public:
+    explicit SpatialIndex(double cellMetres = DEFAULT_CELL_METRES);
+
+    // Handles are reused after remove()
+    int insert(int type, double x, double y);
+    void move(int handle, double x, double y);
+    void remove(int handle);
+    bool contains(int handle) const;
+    int count() const { return m_count; }
+
+    int type(int handle) const { return m_entries[handle].type; }
+    double x(int handle) const { return m_entries[handle].x; }
+    double y(int handle) const { return m_entries[handle].y; }
+
+    // Queries append handles to out and return how many they added
+    int withinRadius(double x, double y, double radius, quint32 typeMask, QVector<int> &out) const;
+    int withinBox(double minX, double minY, double maxX, double maxY, quint32 typeMask, QVector<int> &out) const;
+    // Closest first; exclude skips one handle (usually the query's own entity)
+    int nearest(double x, double y, int k, quint32 typeMask, QVector<int> &out, int exclude = -1) const;
+
+    static quint32 typeBit(int type) { return 1u << type; }
+    static const quint32 ALL_TYPES = 0xFFFFFFFFu;
+    static constexpr double DEFAULT_CELL_METRES = 250.0;
+
+private:
+    struct Entry
+    {
+        double x = 0.0;
+        double y = 0.0;
+        int type = -1;          // -1 = free slot
+        quint64 cell = 0;
+    };
+
+    int cellCoord(double value) const;
+    static quint64 cellKey(int cx, int cy);
+    void addToCell(int handle);
+    void removeFromCell(int handle);
+
+    double m_cellMetres;
+    QVector<Entry> m_entries;
+    QVector<int> m_free;
+    QHash<quint64, QVector<int>> m_cells;
+    int m_count;
+    // Occupied cell range seen so far; bounds the nearest-k ring walk
+    int m_minCellX;
+    int m_minCellY;
+    int m_maxCellX;
+    int m_maxCellY;
+};
+
+#endif // SPATIALINDEX_H
@@ -0,0 +1,86 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer/single-consumer ring. The producer only writes
+// m_head and the consumer only writes m_tail, so neither side takes a lock;
+// each side caches the other's index to avoid touching its cache line on
+// every call. Capacity must be a power of two.
+template <typename T, int Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : m_head(0), m_cachedTail(0), m_tail(0), m_cachedHead(0) {}
+
+    // Producer side
+    bool tryPush(const T &value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == Capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == Capacity) return false;
+        }
+        m_buffer[head & MASK] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: pushes as many of the values as fit; returns that count
+    int pushBatch(const T *values, int count)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (Capacity - (head - m_cachedTail) < static_cast<size_t>(count)) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+        const size_t room = Capacity - (head - m_cachedTail);
+        const int pushed = static_cast<int>(qMin<size_t>(room, static_cast<size_t>(count)));
+        for (int i = 0; i < pushed; ++i) {
+            m_buffer[(head + i) & MASK] = values[i];
+        }
+        m_head.store(head + pushed, std::memory_order_release);
+        return pushed;
+    }
+
+    // Either side; only a snapshot while the other side is active
+    int size() const
+    {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        return static_cast<int>(m_head.load(std::memory_order_acquire) - tail);
+    }
+
+    // Consumer side: moves up to maxCount items into out
+    int popBatch(T *out, int maxCount)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (m_cachedHead == tail) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (m_cachedHead == tail) return 0;
+        }
+        const size_t available = m_cachedHead - tail;
+        const int count = static_cast<int>(qMin<size_t>(available, static_cast<size_t>(maxCount)));
+        for (int i = 0; i < count; ++i) {
+            out[i] = m_buffer[(tail + i) & MASK];
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    static constexpr int capacity() { return Capacity; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    alignas(64) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+    alignas(64) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+    alignas(64) T m_buffer[Capacity];
+};
+
+#endif // SPSCQUEUE_H
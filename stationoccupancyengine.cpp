@@ -0,0 +1,258 @@
+#include "stationoccupancyengine.h"
+#include <QtGlobal>
+
+StationOccupancyEngine::StationOccupancyEngine()
+    : m_seriesHead(0)
+    , m_currentMinute(-1)
+{
+}
+
+int StationOccupancyEngine::addStation(const QString &id, int capacity, int occupancy)
+{
+    int existing = stationIndex(id);
+    if (existing >= 0) {
+        // Re-adding a retired id brings its slot back into service
+        m_retired[existing] = 0;
+        m_inService[existing] = 1;
+        setCapacity(existing, capacity);
+        setOccupancy(existing, occupancy);
+        return existing;
+    }
+
+    int index = m_capacity.size();
+    m_ids.append(id);
+    m_lookup.insert(id, index);
+    m_capacity.append(qMax(1, capacity));
+    m_occupancy.append(qBound(0, occupancy, qMax(1, capacity)));
+    m_inService.append(1);
+    m_retired.append(0);
+    m_full.append(0);
+    m_minuteEntries.append(0);
+    m_minuteExits.append(0);
+    m_level.append(m_occupancy.last());
+    m_trend.append(0.0);
+    m_modelSeeded.append(0);
+    m_seriesCount.append(0);
+    m_series.resize(m_series.size() + HISTORY_MINUTES);
+
+    updateFullFlag(index);
+    return index;
+}
+
+void StationOccupancyEngine::removeStation(const QString &id)
+{
+    int station = stationIndex(id);
+    if (station < 0) return;
+
+    m_retired[station] = 1;
+    m_inService[station] = 0;
+    m_occupancy[station] = 0;
+    m_full[station] = 0;
+    m_seriesCount[station] = 0;
+    m_modelSeeded[station] = 0;
+}
+
+int StationOccupancyEngine::stationIndex(const QString &id) const
+{
+    return m_lookup.value(id, -1);
+}
+
+void StationOccupancyEngine::setCapacity(int station, int capacity)
+{
+    if (!isValid(station)) return;
+    m_capacity[station] = qMax(1, capacity);
+    m_occupancy[station] = qMin(m_occupancy[station], m_capacity[station]);
+    updateFullFlag(station);
+}
+
+void StationOccupancyEngine::setOccupancy(int station, int occupancy)
+{
+    if (!isValid(station)) return;
+    m_occupancy[station] = qBound(0, occupancy, m_capacity[station]);
+
+    // A manual correction invalidates the learned trend
+    m_level[station] = m_occupancy[station];
+    m_trend[station] = 0.0;
+    m_modelSeeded[station] = 0;
+    updateFullFlag(station);
+}
+
+void StationOccupancyEngine::setInService(int station, bool inService)
+{
+    if (!isValid(station)) return;
+    m_inService[station] = inService ? 1 : 0;
+    updateFullFlag(station);
+}
+
+void StationOccupancyEngine::recordTap(int station, TapDirection direction)
+{
+    if (direction == Entry) {
+        recordTaps(station, 1, 0);
+    } else {
+        recordTaps(station, 0, 1);
+    }
+}
+
+void StationOccupancyEngine::recordTaps(int station, int entries, int exits)
+{
+    if (!isValid(station) || !m_inService[station]) return;
+
+    m_minuteEntries[station] += entries;
+    m_minuteExits[station] += exits;
+
+    // Gates reject entries at capacity and nobody can leave an empty station
+    int next = m_occupancy[station] + entries - exits;
+    m_occupancy[station] = qBound(0, next, m_capacity[station]);
+}
+
+void StationOccupancyEngine::tick(qint64 nowMs)
+{
+    const qint64 minute = nowMs / 60000;
+
+    if (m_currentMinute < 0) {
+        m_currentMinute = minute;
+    } else if (minute > m_currentMinute) {
+        // Close every elapsed minute; after a long stall the whole history
+        // window is simply refilled with the current occupancy
+        qint64 elapsed = qMin<qint64>(minute - m_currentMinute, HISTORY_MINUTES);
+        const int stations = m_capacity.size();
+        for (qint64 step = 0; step < elapsed; ++step) {
+            for (int s = 0; s < stations; ++s) {
+                if (!m_retired[s]) closeMinute(s);
+            }
+            m_seriesHead = (m_seriesHead + 1) % HISTORY_MINUTES;
+        }
+        m_currentMinute = minute;
+    }
+
+    const int stations = m_capacity.size();
+    for (int s = 0; s < stations; ++s) {
+        updateFullFlag(s);
+    }
+}
+
+void StationOccupancyEngine::closeMinute(int station)
+{
+    const double observed = m_occupancy[station];
+
+    m_series[station * HISTORY_MINUTES + m_seriesHead] = m_occupancy[station];
+    if (m_seriesCount[station] < HISTORY_MINUTES) {
+        ++m_seriesCount[station];
+    }
+
+    // Holt's linear smoothing: level tracks occupancy, trend tracks net
+    // passengers per minute
+    if (!m_modelSeeded[station]) {
+        m_trend[station] = observed - m_level[station];
+        m_level[station] = observed;
+        m_modelSeeded[station] = 1;
+    } else {
+        double previousLevel = m_level[station];
+        m_level[station] = LEVEL_ALPHA * observed
+                + (1.0 - LEVEL_ALPHA) * (previousLevel + m_trend[station]);
+        m_trend[station] = TREND_BETA * (m_level[station] - previousLevel)
+                + (1.0 - TREND_BETA) * m_trend[station];
+    }
+
+    m_minuteEntries[station] = 0;
+    m_minuteExits[station] = 0;
+}
+
+void StationOccupancyEngine::updateFullFlag(int station)
+{
+    if (m_retired[station] || !m_inService[station]) {
+        m_full[station] = 0;
+        return;
+    }
+
+    const double load = occupancyPercent(station) / 100.0;
+    if (load >= FULL_THRESHOLD) {
+        m_full[station] = 1;
+        return;
+    }
+
+    double eta = minutesToFull(station);
+    bool predicted = eta >= 0.0 && eta <= FULL_HORIZON_MINUTES;
+    if (predicted) {
+        m_full[station] = 1;
+    } else if (m_full[station] && load < RELEASE_THRESHOLD) {
+        m_full[station] = 0;
+    }
+}
+
+int StationOccupancyEngine::occupancy(int station) const
+{
+    return isValid(station) ? m_occupancy[station] : 0;
+}
+
+int StationOccupancyEngine::capacity(int station) const
+{
+    return isValid(station) ? m_capacity[station] : 0;
+}
+
+double StationOccupancyEngine::occupancyPercent(int station) const
+{
+    if (!isValid(station)) return 0.0;
+    return m_occupancy[station] * 100.0 / m_capacity[station];
+}
+
+bool StationOccupancyEngine::isInService(int station) const
+{
+    return isValid(station) && m_inService[station];
+}
+
+bool StationOccupancyEngine::isFull(int station) const
+{
+    return isValid(station) && m_full[station];
+}
+
+double StationOccupancyEngine::fillRatePerMinute(int station) const
+{
+    if (!isValid(station) || !m_modelSeeded[station]) return 0.0;
+    return m_trend[station];
+}
+
+double StationOccupancyEngine::minutesToFull(int station) const
+{
+    if (!isValid(station) || !m_inService[station]) return -1.0;
+
+    const double target = m_capacity[station] * FULL_THRESHOLD;
+    if (m_occupancy[station] >= target) return 0.0;
+
+    double rate = fillRatePerMinute(station);
+    if (rate <= 0.0) return -1.0;
+
+    // Project from the live count rather than the smoothed level so taps
+    // within the current minute move the estimate immediately
+    return (target - m_occupancy[station]) / rate;
+}
+
+int StationOccupancyEngine::entriesThisMinute(int station) const
+{
+    return isValid(station) ? m_minuteEntries[station] : 0;
+}
+
+int StationOccupancyEngine::exitsThisMinute(int station) const
+{
+    return isValid(station) ? m_minuteExits[station] : 0;
+}
+
+QVector<int> StationOccupancyEngine::minuteSeries(int station) const
+{
+    QVector<int> series;
+    if (!isValid(station)) return series;
+
+    const int count = m_seriesCount[station];
+    const int *history = m_series.constData() + station * HISTORY_MINUTES;
+    series.reserve(count);
+    for (int i = count; i > 0; --i) {
+        int slot = (m_seriesHead - i + HISTORY_MINUTES) % HISTORY_MINUTES;
+        series.append(history[slot]);
+    }
+    return series;
+}
+
+bool StationOccupancyEngine::isValid(int station) const
+{
+    return station >= 0 && station < m_capacity.size() && !m_retired[station];
+}
@@ -0,0 +1,92 @@
+#ifndef STATIONOCCUPANCYENGINE_H
+#define STATIONOCCUPANCYENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+// Derives station occupancy from the RFID tap stream (entries - exits),
+// keeps a per-station minute series and forecasts time-to-full with
+// Holt's linear smoothing so "Full" can be flagged before it happens.
+// Station slots are never reused: removed stations are retired in place
+// so indices handed out to the tap pipeline stay valid.
+class StationOccupancyEngine
+{
+public:
+    enum TapDirection {
+        Entry,
+        Exit
+    };
+
+    StationOccupancyEngine();
+
+    // Station registry
+    int addStation(const QString &id, int capacity, int occupancy);
+    void removeStation(const QString &id);
+    int stationIndex(const QString &id) const;
+    int stationSlots() const { return m_capacity.size(); }
+    QString stationId(int station) const { return m_ids.value(station); }
+
+    // Operator overrides (add/edit dialog)
+    void setCapacity(int station, int capacity);
+    void setOccupancy(int station, int occupancy);
+    void setInService(int station, bool inService);
+
+    // Tap stream
+    void recordTap(int station, TapDirection direction);
+    void recordTaps(int station, int entries, int exits);
+
+    // Closes elapsed minutes and refreshes forecasts and Full flags
+    void tick(qint64 nowMs);
+
+    // Queries
+    int occupancy(int station) const;
+    int capacity(int station) const;
+    double occupancyPercent(int station) const;
+    bool isInService(int station) const;
+    bool isFull(int station) const;
+    double fillRatePerMinute(int station) const;
+    double minutesToFull(int station) const;   // < 0 when not filling
+    int entriesThisMinute(int station) const;
+    int exitsThisMinute(int station) const;
+    QVector<int> minuteSeries(int station) const; // oldest first
+
+    static const int HISTORY_MINUTES = 120;
+
+    // Forecast tuning
+    static constexpr double FULL_THRESHOLD = 0.95;      // share of capacity
+    static constexpr double RELEASE_THRESHOLD = 0.90;   // hysteresis
+    static constexpr double FULL_HORIZON_MINUTES = 5.0; // predicted-full window
+    static constexpr double LEVEL_ALPHA = 0.4;
+    static constexpr double TREND_BETA = 0.2;
+
+private:
+    bool isValid(int station) const;
+    void closeMinute(int station);
+    void updateFullFlag(int station);
+
+    // Per-station state (structure of arrays)
+    QStringList m_ids;
+    QHash<QString, int> m_lookup;
+    QVector<int> m_capacity;
+    QVector<int> m_occupancy;
+    QVector<quint8> m_inService;
+    QVector<quint8> m_retired;
+    QVector<quint8> m_full;
+    QVector<int> m_minuteEntries;
+    QVector<int> m_minuteExits;
+
+    // Holt's linear model per station
+    QVector<double> m_level;
+    QVector<double> m_trend;
+    QVector<quint8> m_modelSeeded;
+
+    // Minute series: HISTORY_MINUTES slots per station in one flat buffer
+    QVector<int> m_series;
+    QVector<int> m_seriesCount;
+    int m_seriesHead;
+    qint64 m_currentMinute;
+};
+
+#endif // STATIONOCCUPANCYENGINE_H
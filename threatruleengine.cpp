@@ -0,0 +1,160 @@
+#include "threatruleengine.h"
+
+ThreatRuleEngine::ThreatRuleEngine()
+    : m_dirty(false)
+    , m_sensorCapacity(0)
+    , m_eventsEvaluated(0)
+{
+    for (int k = 0; k <= EVENT_KIND_COUNT; ++k) m_kindStart[k] = 0;
+}
+
+int ThreatRuleEngine::addRule(const ThreatRule &rule)
+{
+    m_rules.append(rule);
+    m_dirty = true;
+    return m_rules.size() - 1;
+}
+
+void ThreatRuleEngine::compile()
+{
+    m_program.clear();
+    m_spikeState.clear();
+
+    // Counting sort of the instructions by kind
+    for (int kind = 0; kind < EVENT_KIND_COUNT; ++kind) {
+        m_kindStart[kind] = m_program.size();
+        for (int r = 0; r < m_rules.size(); ++r) {
+            const ThreatRule &rule = m_rules[r];
+            if (rule.kind != kind) continue;
+
+            Instruction ins;
+            ins.rule = static_cast<quint16>(r);
+            ins.state = 0;
+            ins.a = rule.threshold;
+            ins.b = rule.minimum;
+            ins.cooldownMs = static_cast<qint64>(rule.cooldownSeconds) * 1000;
+            switch (rule.condition) {
+            case ThreatRule::ValueAbove: ins.op = OP_ABOVE; break;
+            case ThreatRule::ValueBelow: ins.op = OP_BELOW; break;
+            case ThreatRule::ValueInRange:
+                ins.op = OP_RANGE;
+                ins.b = rule.ceiling;
+                break;
+            default:
+                ins.op = OP_SPIKE;
+                ins.state = static_cast<quint16>(m_spikeState.size());
+                m_spikeState.append(SpikeState());
+                break;
+            }
+            m_program.append(ins);
+        }
+    }
+    m_kindStart[EVENT_KIND_COUNT] = m_program.size();
+
+    // Rule-indexed state must be re-laid out for the new rule count
+    int capacity = m_sensorCapacity;
+    m_sensorCapacity = 0;
+    m_lastFired.clear();
+    if (capacity > 0) ensureSensor(static_cast<quint32>(capacity - 1));
+
+    m_dirty = false;
+}
+
+void ThreatRuleEngine::ensureSensor(quint32 sensor)
+{
+    if (static_cast<int>(sensor) < m_sensorCapacity) return;
+
+    int oldCapacity = m_sensorCapacity;
+    int capacity = qMax(64, oldCapacity);
+    while (capacity <= static_cast<int>(sensor)) capacity *= 2;
+
+    for (int s = 0; s < m_spikeState.size(); ++s) {
+        m_spikeState[s].mean.resize(capacity);
+        m_spikeState[s].samples.resize(capacity);
+    }
+
+    // Re-stride the [rule][sensor] table
+    QVector<qint64> lastFired(m_rules.size() * capacity, 0);
+    for (int r = 0; r < m_rules.size() && oldCapacity > 0; ++r) {
+        for (int s = 0; s < oldCapacity; ++s) {
+            lastFired[r * capacity + s] = m_lastFired.value(r * oldCapacity + s);
+        }
+    }
+    m_lastFired.swap(lastFired);
+
+    m_sensorCapacity = capacity;
+}
+
+bool ThreatRuleEngine::fire(int rule, quint32 sensor, double value, qint64 timestampMs,
+                            qint64 cooldownMs, QVector<ThreatHit> &out)
+{
+    qint64 &last = m_lastFired[rule * m_sensorCapacity + static_cast<int>(sensor)];
+    if (last != 0 && timestampMs - last < cooldownMs) return false;
+    last = timestampMs;
+
+    ThreatHit hit;
+    hit.rule = rule;
+    hit.sensor = sensor;
+    hit.value = value;
+    hit.timestampMs = timestampMs;
+    out.append(hit);
+    return true;
+}
+
+int ThreatRuleEngine::evaluate(const QVector<CityEvent> &events, QVector<ThreatHit> &out)
+{
+    if (m_dirty) compile();
+    int before = out.size();
+
+    const Instruction *program = m_program.constData();
+    const CityEvent *event = events.constData();
+    const CityEvent *end = event + events.size();
+
+    for (; event != end; ++event) {
+        if (event->kind >= EVENT_KIND_COUNT) continue;
+        if (static_cast<int>(event->sensor) >= m_sensorCapacity) ensureSensor(event->sensor);
+
+        const int first = m_kindStart[event->kind];
+        const int last = m_kindStart[event->kind + 1];
+        for (int i = first; i < last; ++i) {
+            const Instruction &ins = program[i];
+            switch (ins.op) {
+            case OP_ABOVE:
+                if (event->value > ins.a) {
+                    fire(ins.rule, event->sensor, event->value, event->timestampMs, ins.cooldownMs, out);
+                }
+                break;
+            case OP_BELOW:
+                if (event->value < ins.a) {
+                    fire(ins.rule, event->sensor, event->value, event->timestampMs, ins.cooldownMs, out);
+                }
+                break;
+            case OP_RANGE:
+                if (event->value > ins.a && event->value <= ins.b) {
+                    fire(ins.rule, event->sensor, event->value, event->timestampMs, ins.cooldownMs, out);
+                }
+                break;
+            case OP_SPIKE: {
+                SpikeState &state = m_spikeState[ins.state];
+                double &mean = state.mean[event->sensor];
+                quint32 &samples = state.samples[event->sensor];
+
+                bool spike = samples >= SPIKE_WARMUP_SAMPLES
+                        && event->value > ins.b
+                        && event->value > ins.a * mean;
+                if (spike) {
+                    // Spikes are kept out of the history they are judged against
+                    fire(ins.rule, event->sensor, event->value, event->timestampMs, ins.cooldownMs, out);
+                } else {
+                    mean = samples == 0 ? event->value : mean + SPIKE_ALPHA * (event->value - mean);
+                    ++samples;
+                }
+                break;
+            }
+            }
+        }
+    }
+    m_eventsEvaluated += events.size();
+
+    return out.size() - before;
+}
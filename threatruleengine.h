@@ -0,0 +1,100 @@
+#ifndef THREATRULEENGINE_H
+#define THREATRULEENGINE_H
+
+#include <QString>
+#include <QVector>
+#include "cityeventbus.h"
+
+// Declarative detection rule over the event stream
+struct ThreatRule
+{
+    enum Condition {
+        ValueAbove,       // value > threshold
+        ValueBelow,       // value < threshold
+        ValueInRange,     // threshold < value <= ceiling
+        SpikeOverHistory  // value > threshold * per-sensor EWMA and > minimum
+    };
+
+    QString name;          // threat type shown in the alert table
+    QString module;        // affected module
+    QString severity;      // "CRITICAL", "HIGH", ...
+    quint16 kind;          // CityEventKind the rule watches
+    Condition condition;
+    double threshold;
+    double minimum;        // SpikeOverHistory: absolute floor to fire
+    int cooldownSeconds;   // per-sensor re-fire suppression
+    double ceiling = 0.0;  // ValueInRange: inclusive upper bound
+};
+
+// One rule firing
+struct ThreatHit
+{
+    int rule;
+    quint32 sensor;
+    double value;
+    qint64 timestampMs;
+};
+
+// Evaluates ThreatRules against batches of CityEvents. Rules are compiled
+// into one flat instruction array ordered by event kind, so each event
+// runs only the handful of instructions for its kind with no string or
+// hash work; per-sensor state (spike history, cooldowns) lives
+// in plain vectors indexed by the interned sensor id. Silence is not a
+// rule; LivenessTracker expires quiet devices without scanning them.
+class ThreatRuleEngine
+{
+public:
+    ThreatRuleEngine();
+
+    int addRule(const ThreatRule &rule);
+    const ThreatRule &rule(int index) const { return m_rules[index]; }
+    int ruleCount() const { return m_rules.size(); }
+
+    // Appends hits for the batch to out; returns the number appended
+    int evaluate(const QVector<CityEvent> &events, QVector<ThreatHit> &out);
+
+    quint64 eventsEvaluated() const { return m_eventsEvaluated; }
+
+private:
+    enum OpCode : quint8 { OP_ABOVE, OP_BELOW, OP_RANGE, OP_SPIKE };
+
+    struct Instruction
+    {
+        quint8 op;
+        quint16 rule;
+        quint16 state;     // OP_SPIKE: index into m_spikeState
+        double a;          // threshold
+        double b;          // minimum, or ceiling for OP_RANGE
+        qint64 cooldownMs;
+    };
+
+    struct SpikeState
+    {
+        QVector<double> mean;
+        QVector<quint32> samples;
+    };
+
+    void compile();
+    bool fire(int rule, quint32 sensor, double value, qint64 timestampMs,
+              qint64 cooldownMs, QVector<ThreatHit> &out);
+    void ensureSensor(quint32 sensor);
+
+    QVector<ThreatRule> m_rules;
+    bool m_dirty;
+
+    // Compiled program: instructions for kind k are [m_kindStart[k], m_kindStart[k + 1])
+    QVector<Instruction> m_program;
+    int m_kindStart[EVENT_KIND_COUNT + 1];
+    QVector<SpikeState> m_spikeState;
+
+    // Per-sensor state
+    int m_sensorCapacity;
+    QVector<qint64> m_lastFired;   // [rule * capacity + sensor]
+
+    quint64 m_eventsEvaluated;
+
+    static const int SPIKE_WARMUP_SAMPLES = 8;
+    static constexpr double SPIKE_ALPHA = 0.1;
+};
+
+#endif // THREATRULEENGINE_H
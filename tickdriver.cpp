@@ -0,0 +1,152 @@
+#include "tickdriver.h"
+#include "tracer.h"
+#include "metricsregistry.h"
+
+namespace {
+const double JITTER_SMOOTHING = 0.1;
+}
+
+TickDriver::TickDriver()
+    : QObject(nullptr)
+    , m_scheduledTick(-1)
+    , m_rateWindowStartMs(0)
+    , m_rateWindowWakeups(0)
+{
+    MetricsRegistry *metrics = MetricsRegistry::instance();
+    m_jitterMetric = metrics->histogram("tick_jitter_us", "Tick driver");
+    m_wakeupMetric = metrics->counter("wakeups_total", "Tick driver");
+    m_overrunMetric = metrics->counter("tick_overruns_total", "Tick driver");
+
+    m_clock.start();
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &TickDriver::wake);
+}
+
+TickDriver *TickDriver::instance()
+{
+    static TickDriver driver;
+    return &driver;
+}
+
+int TickDriver::quantise(int intervalMs)
+{
+    if (intervalMs <= 0) return 0;
+    if (intervalMs < 1000) return intervalMs < 2 * BASE_TICK_MS ? BASE_TICK_MS : 2 * BASE_TICK_MS;
+    return qMax(1, qRound(intervalMs / 1000.0)) * 1000;
+}
+
+int TickDriver::add(const QString &name, int intervalMs, QObject *context, const std::function<void()> &callback)
+{
+    Tick tick;
+    tick.callback = callback;
+    tick.periodTicks = 0;
+    tick.nextTick = 0;
+    tick.stats.name = name;
+    tick.duration = MetricsRegistry::instance()->histogram("tick_duration_us", name);
+    tick.newCalls = MetricsRegistry::instance()->counter("tick_operator_new_total", name);
+    m_ticks.append(tick);
+
+    const int id = m_ticks.size() - 1;
+    connect(context, &QObject::destroyed, this, [this, id]() { remove(id); });
+    setInterval(id, intervalMs);
+    return id;
+}
+
+void TickDriver::setInterval(int tick, int intervalMs)
+{
+    Tick &entry = m_ticks[tick];
+    const int quantised = quantise(intervalMs);
+    if (quantised == entry.stats.intervalMs || !entry.callback) return;
+    entry.stats.intervalMs = quantised;
+    entry.periodTicks = quantised / BASE_TICK_MS;
+    if (entry.periodTicks > 0) {
+        entry.nextTick = (currentTick() / entry.periodTicks + 1) * entry.periodTicks;
+    }
+    schedule();
+}
+
+void TickDriver::remove(int tick)
+{
+    Tick &entry = m_ticks[tick];
+    entry.callback = nullptr;
+    entry.periodTicks = 0;
+    entry.stats.intervalMs = 0;
+    schedule();
+}
+
+void TickDriver::wake()
+{
+    TRACE_SCOPE("TickDriver::wake");
+    const qint64 wokeMs = m_clock.elapsed();
+    const qint64 now = wokeMs / BASE_TICK_MS;
+
+    // Lateness against the tick this wakeup was scheduled for
+    double jitter = qMax<qint64>(0, wokeMs - m_scheduledTick * BASE_TICK_MS);
+    ++m_stats.wakeups;
+    m_stats.lastJitterMs = jitter;
+    m_stats.maxJitterMs = qMax(m_stats.maxJitterMs, jitter);
+    m_stats.meanJitterMs += JITTER_SMOOTHING * (jitter - m_stats.meanJitterMs);
+    m_jitterMetric->record(static_cast<quint64>(jitter * 1000));
+    m_wakeupMetric->add();
+
+    // Ticks added by a callback are already aligned to a later wakeup
+    const int count = m_ticks.size();
+    QElapsedTimer run;
+    for (int i = 0; i < count; ++i) {
+        if (m_ticks[i].periodTicks == 0 || m_ticks[i].nextTick > now) continue;
+        const qint64 period = m_ticks[i].periodTicks;
+        m_ticks[i].stats.missed += (now - m_ticks[i].nextTick) / period;
+        m_ticks[i].nextTick = (now / period + 1) * period;
+
+        // The callback may add ticks, so the entry is looked up again after it
+        std::function<void()> callback = m_ticks[i].callback;
+        const quint64 newCallsBefore = MetricsRegistry::threadNewCalls();
+        run.start();
+        callback();
+        const qint64 ns = run.nsecsElapsed();
+        double ms = ns / 1e6;
+        m_ticks[i].duration->record(ns / 1000);
+        m_ticks[i].newCalls->add(MetricsRegistry::threadNewCalls() - newCallsBefore);
+
+        TickStats &stats = m_ticks[i].stats;
+        ++stats.runs;
+        stats.lastMs = ms;
+        stats.maxMs = qMax(stats.maxMs, ms);
+        stats.totalMs += ms;
+    }
+
+    const qint64 doneMs = m_clock.elapsed();
+    if (doneMs >= (now + 1) * BASE_TICK_MS) {
+        ++m_stats.overruns;
+        m_overrunMetric->add();
+    }
+
+    ++m_rateWindowWakeups;
+    if (doneMs - m_rateWindowStartMs >= 1000) {
+        m_stats.wakeupsPerSecond = m_rateWindowWakeups * 1000.0 / (doneMs - m_rateWindowStartMs);
+        m_rateWindowStartMs = doneMs;
+        m_rateWindowWakeups = 0;
+    }
+
+    m_scheduledTick = -1;
+    schedule();
+}
+
+void TickDriver::schedule()
+{
+    qint64 next = -1;
+    for (const Tick &tick : m_ticks) {
+        if (tick.periodTicks == 0) continue;
+        if (next < 0 || tick.nextTick < next) next = tick.nextTick;
+    }
+    if (next == m_scheduledTick && m_timer->isActive()) return;
+
+    m_scheduledTick = next;
+    if (next < 0) {
+        m_timer->stop();
+        return;
+    }
+    m_timer->start(static_cast<int>(qMax<qint64>(0, next * BASE_TICK_MS - m_clock.elapsed())));
+}
@@ -0,0 +1,102 @@
+#ifndef TICKDRIVER_H
+#define TICKDRIVER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <functional>
+
+class LatencyHistogram;
+class MetricCounter;
+
+// Per-tick accounting
+struct TickStats
+{
+    QString name;
+    int intervalMs = 0;          // after quantising; 0 = paused
+    quint64 runs = 0;
+    quint64 missed = 0;          // periods skipped because a wakeup came late
+    double lastMs = 0.0;
+    double maxMs = 0.0;
+    double totalMs = 0.0;
+};
+
+// Wakeup accounting for the driver as a whole
+struct TickDriverStats
+{
+    quint64 wakeups = 0;
+    quint64 overruns = 0;        // wakeups whose ticks ran into the next base tick
+    double lastJitterMs = 0.0;   // how late the last wakeup was
+    double maxJitterMs = 0.0;
+    double meanJitterMs = 0.0;   // exponential average
+    double wakeupsPerSecond = 0.0;
+};
+
+// The one clock behind every periodic page and window update. Intervals
+// are quantised onto a two-level ladder of BASE_TICK_MS steps: below a
+// second they become 250 or 500 ms, which divide the second, and from a
+// second up they are rounded to whole seconds. Each tick fires on the
+// multiples of its own period counted from the driver's start, so any
+// two ticks whose periods divide one another share their wakeups (every
+// 5 s tick lands on a 1 s tick, and so on). Between due ticks the driver
+// sleeps on a single precise timer against the monotonic clock, so it
+// wakes only when something is due and never drifts. Intervals can be
+// changed at runtime. Tick cost and operator new calls, wakeup jitter and
+// overruns are also published to the MetricsRegistry. GUI thread only.
+class TickDriver : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TickDriver *instance();
+
+    // Runs callback every intervalMs (quantised) until context is destroyed
+    int add(const QString &name, int intervalMs, QObject *context, const std::function<void()> &callback);
+    // 0 pauses the tick; a new period starts on its next aligned wakeup
+    void setInterval(int tick, int intervalMs);
+    int interval(int tick) const { return m_ticks[tick].stats.intervalMs; }
+    void remove(int tick);
+
+    int tickCount() const { return m_ticks.size(); }
+    bool isActive(int tick) const { return static_cast<bool>(m_ticks[tick].callback); }
+    const TickStats &tickStats(int tick) const { return m_ticks[tick].stats; }
+    const TickDriverStats &stats() const { return m_stats; }
+
+    static int quantise(int intervalMs);
+
+    static const int BASE_TICK_MS = 250;
+    static const int TICKS_PER_SECOND = 1000 / BASE_TICK_MS;
+
+private slots:
+    void wake();
+
+private:
+    struct Tick
+    {
+        std::function<void()> callback;
+        qint64 periodTicks;          // 0 = paused
+        qint64 nextTick;
+        TickStats stats;
+        LatencyHistogram *duration;
+        MetricCounter *newCalls;
+    };
+
+    TickDriver();
+    qint64 currentTick() const { return m_clock.elapsed() / BASE_TICK_MS; }
+    void schedule();
+
+    QVector<Tick> m_ticks;
+    QElapsedTimer m_clock;           // monotonic; tick n is due at n * BASE_TICK_MS
+    QTimer *m_timer;
+    qint64 m_scheduledTick;          // -1 = idle
+    TickDriverStats m_stats;
+    qint64 m_rateWindowStartMs;
+    quint64 m_rateWindowWakeups;
+    LatencyHistogram *m_jitterMetric;
+    MetricCounter *m_wakeupMetric;
+    MetricCounter *m_overrunMetric;
+};
+
+#endif // TICKDRIVER_H
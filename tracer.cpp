@@ -0,0 +1,184 @@
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QFile>
+#include <QByteArray>
+#include <cstdio>
+
+namespace {
+struct TraceEvent
+{
+    const char *name;
+    qint64 startNs;
+    qint64 endNs;
+};
+
+// Written only by its own thread; kept after the thread exits so its
+// spans still make it into the dump. The owner moves its ring to a new
+// trace lazily: the first span it records under a new epoch marks where
+// that trace starts, so starting a trace never writes to another
+// thread's ring.
+struct ThreadRing
+{
+    TraceEvent events[Tracer::RING_EVENTS];
+    std::atomic<quint64> written{0};
+    std::atomic<quint64> first{0};     // index of the current trace's first span
+    std::atomic<quint32> epoch{0};     // trace the spans from first on belong to
+    int tid;
+    QString threadName;
+};
+
+// Copied out under the rings lock so formatting and file writes happen
+// without it
+struct RingSnapshot
+{
+    int tid;
+    QString threadName;
+    QVector<TraceEvent> events;
+};
+
+const quint64 RING_MASK = Tracer::RING_EVENTS - 1;
+
+QMutex g_ringsMutex;
+QVector<ThreadRing *> g_rings;
+thread_local ThreadRing *t_ring = nullptr;
+
+// Bumped by every start, after g_startedNs is set; spans begun before
+// g_startedNs belong to an earlier trace
+std::atomic<quint32> g_epoch{0};
+std::atomic<qint64> g_startedNs{0};
+
+QElapsedTimer startedClock()
+{
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+ThreadRing *registerThread()
+{
+    ThreadRing *ring = new ThreadRing();
+    QMutexLocker locker(&g_ringsMutex);
+    ring->tid = g_rings.size() + 1;
+    QThread *thread = QThread::currentThread();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        ring->threadName = "GUI";
+    } else if (!thread->objectName().isEmpty()) {
+        ring->threadName = thread->objectName();
+    } else {
+        ring->threadName = QString("Thread %1").arg(ring->tid);
+    }
+    g_rings.append(ring);
+    return ring;
+}
+
+void appendMicros(QByteArray &out, qint64 ns)
+{
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%lld.%03lld",
+                                static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+    out.append(digits, length);
+}
+}
+
+std::atomic<bool> Tracer::s_enabled{false};
+QElapsedTimer Tracer::s_clock = startedClock();
+
+void Tracer::setEnabled(bool enabled)
+{
+    if (enabled && !isEnabled()) {
+        g_startedNs.store(nowNs(), std::memory_order_relaxed);
+        g_epoch.fetch_add(1, std::memory_order_release);
+    }
+    s_enabled.store(enabled, std::memory_order_release);
+}
+
+void Tracer::record(const char *name, qint64 startNs, qint64 endNs)
+{
+    // Tracing may have stopped, or stopped and restarted, since the span
+    // began. Reading the epoch first makes the start time at least as new.
+    const quint32 epoch = g_epoch.load(std::memory_order_acquire);
+    if (!s_enabled.load(std::memory_order_acquire)) return;
+    if (startNs < g_startedNs.load(std::memory_order_relaxed)) return;
+
+    ThreadRing *ring = t_ring;
+    if (!ring) ring = t_ring = registerThread();
+    const quint64 index = ring->written.load(std::memory_order_relaxed);
+    if (ring->epoch.load(std::memory_order_relaxed) != epoch) {
+        ring->first.store(index, std::memory_order_relaxed);
+        ring->epoch.store(epoch, std::memory_order_release);
+    }
+    ring->events[index & RING_MASK] = {name, startNs, endNs};
+    ring->written.store(index + 1, std::memory_order_release);
+}
+
+bool Tracer::writeChromeTrace(const QString &path)
+{
+    setEnabled(false);
+
+    // A span that passed its enabled check just before the stop may still
+    // land in the slot after written, so that slot, the oldest once the
+    // ring has wrapped, is never copied. Spans overwritten while copying
+    // are dropped by checking written again afterwards.
+    const quint32 epoch = g_epoch.load(std::memory_order_acquire);
+    const quint64 window = RING_EVENTS - 1;
+    QVector<RingSnapshot> snapshots;
+    {
+        QMutexLocker locker(&g_ringsMutex);
+        snapshots.reserve(g_rings.size());
+        for (const ThreadRing *ring : g_rings) {
+            RingSnapshot snapshot;
+            snapshot.tid = ring->tid;
+            snapshot.threadName = ring->threadName;
+            if (ring->epoch.load(std::memory_order_acquire) == epoch) {
+                const quint64 first = ring->first.load(std::memory_order_relaxed);
+                const quint64 end = ring->written.load(std::memory_order_acquire);
+                quint64 begin = end - qMin(end - first, window);
+                snapshot.events.reserve(static_cast<int>(end - begin));
+                for (quint64 i = begin; i < end; ++i) snapshot.events.append(ring->events[i & RING_MASK]);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                const quint64 after = ring->written.load(std::memory_order_relaxed);
+                if (after > begin + window) {
+                    const int overwritten = static_cast<int>(qMin(after - window - begin, end - begin));
+                    snapshot.events.remove(0, overwritten);
+                }
+            }
+            snapshots.append(snapshot);
+        }
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    QByteArray out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const RingSnapshot &snapshot : snapshots) {
+        QByteArray threadName = snapshot.threadName.toUtf8();
+        threadName.replace('\\', "\\\\").replace('"', "\\\"");
+        if (!first) out += ",\n";
+        first = false;
+        const QByteArray tid = QByteArray::number(snapshot.tid);
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid
+               + ",\"args\":{\"name\":\"" + threadName + "\"}}";
+
+        // Oldest surviving span first
+        for (const TraceEvent &event : snapshot.events) {
+            out += ",\n{\"name\":\"";
+            out += event.name;
+            out += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid + ",\"ts\":";
+            appendMicros(out, event.startNs);
+            out += ",\"dur\":";
+            appendMicros(out, event.endNs - event.startNs);
+            out += '}';
+        }
+        file.write(out);
+        out.truncate(0);
+    }
+    out += "\n]}\n";
+    file.write(out);
+    return true;
+}
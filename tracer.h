@@ -0,0 +1,62 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QElapsedTimer>
+#include <atomic>
+
+// Span tracing for finding which update or repaint makes the UI stutter.
+// TRACE_SCOPE("name") records the enclosing scope as one span; the name
+// must be a string literal. Each thread writes its spans into its own
+// ring of RING_EVENTS, so recording takes no lock and keeps the latest
+// spans of each thread. While tracing is off a span costs one relaxed
+// atomic load; building with NEOCITY_NO_TRACING removes spans entirely.
+// writeChromeTrace() dumps every thread's ring as Chrome trace event JSON,
+// which Perfetto (ui.perfetto.dev) and chrome://tracing open directly.
+class Tracer
+{
+public:
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // Starting a trace drops the spans of the previous one
+    static void setEnabled(bool enabled);
+
+    // Stops tracing first; false if the file cannot be written
+    static bool writeChromeTrace(const QString &path);
+
+    static qint64 nowNs() { return s_clock.nsecsElapsed(); }
+    static void record(const char *name, qint64 startNs, qint64 endNs);
+
+    static const int RING_EVENTS = 1 << 15;
+
+private:
+    static std::atomic<bool> s_enabled;
+    static QElapsedTimer s_clock;
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : m_name(Tracer::isEnabled() ? name : nullptr)
+        , m_startNs(m_name ? Tracer::nowNs() : 0)
+    {
+    }
+    ~TraceSpan()
+    {
+        if (m_name) Tracer::record(m_name, m_startNs, Tracer::nowNs());
+    }
+
+private:
+    const char *m_name;
+    qint64 m_startNs;
+};
+
+#ifdef NEOCITY_NO_TRACING
+#define TRACE_SCOPE(name)
+#else
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#endif
+
+#endif // TRACER_H
@@ -0,0 +1,216 @@
+#include "transitscheduleengine.h"
+#include <QtGlobal>
+#include <QtMath>
+#include <cmath>
+
+namespace {
+const double PACE_ALPHA = 0.3;
+const double MIN_PACE = 0.25;
+const double MAX_PACE = 2.0;
+}
+
+TransitScheduleEngine::TransitScheduleEngine()
+    : m_stopCount(0)
+{
+    m_routeOffset.append(0);
+}
+
+void TransitScheduleEngine::setStopCount(int stops)
+{
+    if (stops == m_stopCount) return;
+    m_stopCount = qMax(0, stops);
+    rebuildStopIndex();
+}
+
+int TransitScheduleEngine::addRoute(const QString &name, const QVector<int> &stops,
+                                    const QVector<int> &legSeconds)
+{
+    if (stops.isEmpty() || legSeconds.size() != stops.size()) return -1;
+
+    // legSeconds[i] is the scheduled run from stops[i] to the next stop;
+    // the last leg returns to the first stop and closes the loop
+    int cumulative = 0;
+    for (int i = 0; i < stops.size(); ++i) {
+        m_routeStops.append(stops[i]);
+        m_routeCumSeconds.append(cumulative);
+        cumulative += qMax(1, legSeconds[i]);
+    }
+    m_routeLoopSeconds.append(cumulative);
+    m_routeOffset.append(m_routeStops.size());
+    m_routeNames.append(name);
+    return m_routeNames.size() - 1;
+}
+
+int TransitScheduleEngine::routeLoopSeconds(int route) const
+{
+    return m_routeLoopSeconds.value(route);
+}
+
+int TransitScheduleEngine::addVehicle(const QString &id, int route, double progressSeconds, qint64 nowMs)
+{
+    if (route < 0 || route >= m_routeNames.size()) return -1;
+
+    int vehicle = m_vehicleIds.size();
+    m_vehicleIds.append(id);
+    m_vehicleRoute.append(route);
+    m_vehicleProgress.append(progressSeconds);
+    m_vehicleReportMs.append(nowMs);
+    m_vehiclePace.append(1.0);
+    m_vehicleArrivalOffset.append(m_arrivalMs.size());
+    m_arrivalMs.resize(m_arrivalMs.size() + m_routeOffset[route + 1] - m_routeOffset[route]);
+
+    predictVehicle(vehicle);
+    return vehicle;
+}
+
+void TransitScheduleEngine::updateVehicle(int vehicle, double progressSeconds, qint64 reportMs)
+{
+    if (vehicle < 0 || vehicle >= m_vehicleIds.size()) return;
+
+    double travelled = progressSeconds - m_vehicleProgress[vehicle];
+    double elapsed = (reportMs - m_vehicleReportMs[vehicle]) / 1000.0;
+    if (elapsed > 0.0 && travelled >= 0.0) {
+        double observed = qBound(MIN_PACE, travelled / elapsed, MAX_PACE);
+        m_vehiclePace[vehicle] = PACE_ALPHA * observed + (1.0 - PACE_ALPHA) * m_vehiclePace[vehicle];
+    }
+
+    m_vehicleProgress[vehicle] = progressSeconds;
+    m_vehicleReportMs[vehicle] = reportMs;
+
+    predictVehicle(vehicle);
+
+    // Only stations on this vehicle's route can change their best arrival
+    const int route = m_vehicleRoute[vehicle];
+    for (int i = m_routeOffset[route]; i < m_routeOffset[route + 1]; ++i) {
+        refreshStop(m_routeStops[i]);
+    }
+}
+
+void TransitScheduleEngine::predictVehicle(int vehicle)
+{
+    const int route = m_vehicleRoute[vehicle];
+    const int first = m_routeOffset[route];
+    const int count = m_routeOffset[route + 1] - first;
+    const double loop = m_routeLoopSeconds[route];
+    const double position = std::fmod(m_vehicleProgress[vehicle], loop);
+    const double pace = m_vehiclePace[vehicle];
+    const qint64 reportMs = m_vehicleReportMs[vehicle];
+
+    qint64 *arrival = m_arrivalMs.data() + m_vehicleArrivalOffset[vehicle];
+    const int *cumulative = m_routeCumSeconds.constData() + first;
+    for (int i = 0; i < count; ++i) {
+        double ahead = cumulative[i] - position;
+        if (ahead <= 0.0) ahead += loop;
+        arrival[i] = reportMs + qRound64(ahead / pace * 1000.0);
+    }
+}
+
+void TransitScheduleEngine::refreshStop(int stop)
+{
+    if (stop < 0 || stop >= m_stopCount) return;
+
+    qint64 best = -1;
+    int bestVehicle = -1;
+    for (int i = m_stopOffset[stop]; i < m_stopOffset[stop + 1]; ++i) {
+        qint64 arrival = m_arrivalMs[m_stopSlots[i]];
+        if (best < 0 || arrival < best) {
+            best = arrival;
+            bestVehicle = m_slotVehicle[i];
+        }
+    }
+    m_stopBestMs[stop] = best;
+    m_stopBestVehicle[stop] = bestVehicle;
+}
+
+void TransitScheduleEngine::rebuildStopIndex()
+{
+    // Counting sort of (vehicle, route stop) arrival slots by stop
+    QVector<int> counts(m_stopCount + 1, 0);
+    const int vehicles = m_vehicleIds.size();
+    for (int v = 0; v < vehicles; ++v) {
+        int route = m_vehicleRoute[v];
+        for (int i = m_routeOffset[route]; i < m_routeOffset[route + 1]; ++i) {
+            int stop = m_routeStops[i];
+            if (stop >= 0 && stop < m_stopCount) ++counts[stop + 1];
+        }
+    }
+    for (int s = 0; s < m_stopCount; ++s) {
+        counts[s + 1] += counts[s];
+    }
+
+    m_stopOffset = counts;
+    m_stopSlots.resize(counts[m_stopCount]);
+    m_slotVehicle.resize(counts[m_stopCount]);
+    QVector<int> cursor = counts;
+    for (int v = 0; v < vehicles; ++v) {
+        int route = m_vehicleRoute[v];
+        int base = m_vehicleArrivalOffset[v];
+        for (int i = m_routeOffset[route]; i < m_routeOffset[route + 1]; ++i) {
+            int stop = m_routeStops[i];
+            if (stop < 0 || stop >= m_stopCount) continue;
+            int slot = cursor[stop]++;
+            m_stopSlots[slot] = base + (i - m_routeOffset[route]);
+            m_slotVehicle[slot] = v;
+        }
+    }
+
+    m_stopBestMs.fill(-1, m_stopCount);
+    m_stopBestVehicle.fill(-1, m_stopCount);
+    refreshAllStops();
+}
+
+void TransitScheduleEngine::refreshAllStops()
+{
+    for (int s = 0; s < m_stopCount; ++s) {
+        refreshStop(s);
+    }
+}
+
+qint64 TransitScheduleEngine::nextArrival(int stop, qint64 nowMs, int *vehicle) const
+{
+    if (stop < 0 || stop >= m_stopCount) {
+        *vehicle = -1;
+        return -1;
+    }
+
+    // The cached best holds until it falls due
+    *vehicle = m_stopBestVehicle[stop];
+    qint64 best = m_stopBestMs[stop];
+    if (best < 0 || best >= nowMs) return best;
+
+    // Past due: roll each stale prediction forward by whole laps
+    best = -1;
+    for (int i = m_stopOffset[stop]; i < m_stopOffset[stop + 1]; ++i) {
+        const int v = m_slotVehicle[i];
+        qint64 arrival = m_arrivalMs[m_stopSlots[i]];
+        if (arrival < nowMs) {
+            qint64 lapMs = qMax<qint64>(1, qRound64(m_routeLoopSeconds[m_vehicleRoute[v]] / m_vehiclePace[v] * 1000.0));
+            arrival += ((nowMs - arrival) / lapMs + 1) * lapMs;
+        }
+        if (best < 0 || arrival < best) {
+            best = arrival;
+            *vehicle = v;
+        }
+    }
+    return best;
+}
+
+qint64 TransitScheduleEngine::nextArrivalMs(int stop, qint64 nowMs) const
+{
+    int vehicle;
+    return nextArrival(stop, nowMs, &vehicle);
+}
+
+int TransitScheduleEngine::secondsUntilArrival(int stop, qint64 nowMs) const
+{
+    qint64 arrival = nextArrivalMs(stop, nowMs);
+    if (arrival < 0) return -1;
+    return static_cast<int>((arrival - nowMs + 999) / 1000);
+}
+
+int TransitScheduleEngine::nextArrivalVehicle(int stop, qint64 nowMs) const
+{
+    int vehicle;
+    nextArrival(stop, nowMs, &vehicle);
+    return vehicle;
+}
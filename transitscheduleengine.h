@@ -0,0 +1,78 @@
+#ifndef TRANSITSCHEDULEENGINE_H
+#define TRANSITSCHEDULEENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Static loop-route schedule plus live vehicle positions. The schedule is
+// held GTFS-style in flat arrays (route -> stop sequence with cumulative
+// scheduled seconds); each vehicle keeps an absolute predicted arrival for
+// every stop on its route. A position report only touches that vehicle's
+// stops and the stations they serve, so the per-second cost follows the
+// number of reports rather than stations x routes.
+class TransitScheduleEngine
+{
+public:
+    TransitScheduleEngine();
+
+    // Static schedule; stops are station slot indices
+    void setStopCount(int stops);
+    int addRoute(const QString &name, const QVector<int> &stops, const QVector<int> &legSeconds);
+    int routeCount() const { return m_routeNames.size(); }
+    QString routeName(int route) const { return m_routeNames.value(route); }
+    int routeLoopSeconds(int route) const;
+
+    // Vehicles. New vehicles serve no stop until the next
+    // rebuildStopIndex(), so a fleet is loaded with one rebuild at the end.
+    int addVehicle(const QString &id, int route, double progressSeconds, qint64 nowMs);
+    void rebuildStopIndex();
+    int vehicleCount() const { return m_vehicleIds.size(); }
+    QString vehicleId(int vehicle) const { return m_vehicleIds.value(vehicle); }
+    int vehicleRoute(int vehicle) const { return m_vehicleRoute.value(vehicle, -1); }
+    double vehicleProgress(int vehicle) const { return m_vehicleProgress.value(vehicle); }
+    qint64 vehicleReportMs(int vehicle) const { return m_vehicleReportMs.value(vehicle); }
+
+    // Position report: seconds travelled along the route loop at reportMs
+    void updateVehicle(int vehicle, double progressSeconds, qint64 reportMs);
+
+    // Per-stop predictions at nowMs. A vehicle whose predicted arrival has
+    // passed without a new report is counted at its following lap.
+    qint64 nextArrivalMs(int stop, qint64 nowMs) const;     // -1 when unserved
+    int secondsUntilArrival(int stop, qint64 nowMs) const;  // -1 when unserved
+    int nextArrivalVehicle(int stop, qint64 nowMs) const;
+
+private:
+    void predictVehicle(int vehicle);
+    void refreshStop(int stop);
+    void refreshAllStops();
+    qint64 nextArrival(int stop, qint64 nowMs, int *vehicle) const;
+
+    // Routes (CSR): stops of route r live in [m_routeOffset[r], m_routeOffset[r + 1])
+    QStringList m_routeNames;
+    QVector<int> m_routeOffset;
+    QVector<int> m_routeStops;
+    QVector<int> m_routeCumSeconds;    // scheduled seconds from the first stop
+    QVector<int> m_routeLoopSeconds;
+
+    // Vehicles
+    QStringList m_vehicleIds;
+    QVector<int> m_vehicleRoute;
+    QVector<double> m_vehicleProgress;
+    QVector<qint64> m_vehicleReportMs;
+    QVector<double> m_vehiclePace;     // observed / scheduled speed (EWMA)
+    QVector<int> m_vehicleArrivalOffset; // into m_arrivalMs
+
+    // Predicted arrival per (vehicle, route stop), flat
+    QVector<qint64> m_arrivalMs;
+
+    // Stop -> arrival slots serving it (CSR), plus cached best arrival
+    int m_stopCount;
+    QVector<int> m_stopOffset;
+    QVector<int> m_stopSlots;
+    QVector<int> m_slotVehicle;
+    QVector<qint64> m_stopBestMs;
+    QVector<int> m_stopBestVehicle;
+};
+
+#endif // TRANSITSCHEDULEENGINE_H
@@ -0,0 +1,157 @@
+#include "uiupdatescheduler.h"
+#include "tracer.h"
+#include "metricsregistry.h"
+#include <QEvent>
+#include <QElapsedTimer>
+
+UiUpdateScheduler::UiUpdateScheduler()
+    : QObject(nullptr)
+{
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    
+    MetricsRegistry *metrics = MetricsRegistry::instance();
+    m_frameMetric = metrics->histogram("frame_duration_us", "UI scheduler");
+    m_appliedMetric = metrics->counter("updates_applied_total", "UI scheduler");
+    m_coalescedMetric = metrics->counter("updates_coalesced_total", "UI scheduler");
+    m_pendingMetric = metrics->gauge("queue_depth", "UI scheduler");
+    m_parkedMetric = metrics->gauge("parked_updates", "UI scheduler");
+    connect(m_frameTimer, &QTimer::timeout, this, &UiUpdateScheduler::runFrame);
+}
+
+UiUpdateScheduler *UiUpdateScheduler::instance()
+{
+    static UiUpdateScheduler scheduler;
+    return &scheduler;
+}
+
+void UiUpdateScheduler::post(QWidget *page, int region, Priority priority, const std::function<void()> &apply)
+{
+    const QPair<const QObject *, int> key(page, region);
+    int slot = m_slots.value(key, -1);
+    if (slot < 0) {
+        watch(page);
+        if (m_freeSlots.isEmpty()) {
+            slot = m_updates.size();
+            m_updates.append(Update());
+        } else {
+            slot = m_freeSlots.takeLast();
+        }
+        m_updates[slot] = {page, region, priority, nullptr, false, false};
+        m_slots.insert(key, slot);
+    }
+
+    Update &update = m_updates[slot];
+    update.apply = apply;
+    if (update.pending) {
+        // Keeps its place in the queue; only the latest content runs
+        ++m_stats.coalesced;
+        m_coalescedMetric->add();
+        return;
+    }
+    update.pending = true;
+    update.priority = priority;
+    m_queues[priority].append(slot);
+    ++m_stats.pending;
+    // First frame runs in the same wakeup as the tick that posted it
+    if (!m_frameTimer->isActive()) m_frameTimer->start(0);
+}
+
+void UiUpdateScheduler::runFrame()
+{
+    TRACE_SCOPE("UiUpdateScheduler::runFrame");
+    QElapsedTimer clock;
+    clock.start();
+    const qint64 budgetNs = FRAME_BUDGET_MS * 1000000LL;
+
+    bool overBudget = false;
+    int applied = 0;
+    for (int priority = 0; priority < PRIORITY_COUNT; ++priority) {
+        QVector<int> &queue = m_queues[priority];
+        // Updates posted while this frame runs wait for the next one
+        const int count = queue.size();
+        int next = 0;
+        for (; next < count && !overBudget; ++next) {
+            Update &update = m_updates[queue[next]];
+            if (!update.page->isVisible()) {
+                update.parked = true;
+                m_parked.append(queue[next]);
+                ++m_stats.parked;
+                continue;
+            }
+
+            update.pending = false;
+            --m_stats.pending;
+            std::function<void()> apply;
+            apply.swap(update.apply);
+            apply();
+            ++applied;
+            // Always make progress, even when one update alone is over budget
+            overBudget = clock.nsecsElapsed() >= budgetNs;
+        }
+        m_stats.deferred += count - next;
+        queue.remove(0, next);
+    }
+
+    double frameMs = clock.nsecsElapsed() / 1e6;
+    ++m_stats.frames;
+    m_stats.applied += applied;
+    m_stats.hidden = m_parked.size();
+    m_stats.lastFrameMs = frameMs;
+    m_stats.maxFrameMs = qMax(m_stats.maxFrameMs, frameMs);
+    m_frameMetric->record(static_cast<quint64>(frameMs * 1000));
+    m_appliedMetric->add(applied);
+    m_pendingMetric->set(m_stats.pending);
+    m_parkedMetric->set(m_stats.hidden);
+
+    // Only work carried over by the budget keeps the frame clock running;
+    // otherwise idle until something is posted or a parked page is shown
+    if (m_stats.pending > m_parked.size()) m_frameTimer->start(FRAME_MS);
+}
+
+bool UiUpdateScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Show) unpark(static_cast<QWidget *>(watched));
+    return QObject::eventFilter(watched, event);
+}
+
+void UiUpdateScheduler::watch(QWidget *page)
+{
+    if (m_watched.contains(page)) return;
+    m_watched.insert(page);
+    page->installEventFilter(this);
+    connect(page, &QObject::destroyed, this, &UiUpdateScheduler::onPageDestroyed);
+}
+
+void UiUpdateScheduler::unpark(QWidget *page)
+{
+    bool any = false;
+    for (int i = m_parked.size() - 1; i >= 0; --i) {
+        Update &update = m_updates[m_parked[i]];
+        if (update.page != page) continue;
+        update.parked = false;
+        m_queues[update.priority].append(m_parked[i]);
+        m_parked.remove(i);
+        any = true;
+    }
+    m_stats.hidden = m_parked.size();
+    if (any && !m_frameTimer->isActive()) m_frameTimer->start(0);
+}
+
+void UiUpdateScheduler::onPageDestroyed(QObject *page)
+{
+    m_watched.remove(page);
+    for (int slot = 0; slot < m_updates.size(); ++slot) {
+        Update &update = m_updates[slot];
+        if (update.page != page) continue;
+        if (update.pending) {
+            --m_stats.pending;
+            if (update.parked) m_parked.removeOne(slot);
+            else m_queues[update.priority].removeOne(slot);
+        }
+        m_slots.remove(qMakePair(static_cast<const QObject *>(page), update.region));
+        update = Update();
+        m_freeSlots.append(slot);
+    }
+    m_stats.hidden = m_parked.size();
+}
@@ -0,0 +1,99 @@
+#ifndef UIUPDATESCHEDULER_H
+#define UIUPDATESCHEDULER_H
+
+#include <QObject>
+#include <QWidget>
+#include <QTimer>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <functional>
+
+class LatencyHistogram;
+class MetricCounter;
+class MetricGauge;
+
+// Applies widget updates for every page on one frame clock. Pages keep
+// their models current from their TickDriver ticks and post the widget
+// work as dirty regions: a region posted again before it ran is replaced,
+// so a burst of ticks costs one table or chart refresh. A frame runs
+// right after the tick that posted, applying pending regions in priority
+// order until FRAME_BUDGET_MS is spent; the rest is carried to another
+// frame FRAME_MS later, so the frame clock only runs while work is left
+// over. Regions of a page that is not visible (the other pages of the
+// stack) are parked until it is shown. GUI thread only.
+class UiUpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Urgent,      // alert and status the operator acts on
+        High,        // KPI figures
+        Normal,      // tables
+        Low,         // charts and logs
+        PRIORITY_COUNT
+    };
+
+    struct Stats
+    {
+        quint64 frames = 0;
+        quint64 applied = 0;
+        quint64 coalesced = 0;       // posts that replaced a pending update
+        quint64 deferred = 0;        // updates carried over by the frame budget
+        quint64 parked = 0;          // updates held back for a hidden page
+        int pending = 0;
+        int hidden = 0;
+        double lastFrameMs = 0.0;
+        double maxFrameMs = 0.0;
+    };
+
+    static UiUpdateScheduler *instance();
+
+    // Queues the update for this page region, replacing one still pending
+    void post(QWidget *page, int region, Priority priority, const std::function<void()> &apply);
+    const Stats &stats() const { return m_stats; }
+
+    static const int FRAME_MS = 16;
+    static const int FRAME_BUDGET_MS = 8;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void runFrame();
+
+private:
+    struct Update
+    {
+        QWidget *page;
+        int region;
+        int priority;
+        std::function<void()> apply;
+        bool pending;
+        bool parked;
+    };
+
+    UiUpdateScheduler();
+    void watch(QWidget *page);
+    void unpark(QWidget *page);
+    void onPageDestroyed(QObject *page);
+
+    QVector<Update> m_updates;                    // one slot per page region, reused
+    QVector<int> m_freeSlots;
+    QHash<QPair<const QObject *, int>, int> m_slots;
+    QVector<int> m_queues[PRIORITY_COUNT];        // pending slots, oldest first
+    QVector<int> m_parked;
+    QSet<const QObject *> m_watched;
+    QTimer *m_frameTimer;
+    Stats m_stats;
+    
+    LatencyHistogram *m_frameMetric;
+    MetricCounter *m_appliedMetric;
+    MetricCounter *m_coalescedMetric;
+    MetricGauge *m_pendingMetric;
+    MetricGauge *m_parkedMetric;
+};
+
+#endif // UIUPDATESCHEDULER_H
@@ -0,0 +1,288 @@
+#include "whatifsimulator.h"
+#include "simulationthread.h"
+#include "citystabilitymodel.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QTime>
+#include <algorithm>
+
+namespace {
+// Mirrors the security center: a lighting outage and a waste overload add
+// this much risk to the device's zone, and risk drains 1.0 every 5 s
+const double POLE_FAILURE_RISK = 12.0;
+const double OVERFLOW_RISK = 15.0;
+const double RECOVERY_PER_SECOND = 0.2;
+// A crew empties an overflowing bin 20-60 minutes after it fills
+const int COLLECTION_MIN_MINUTES = 20;
+const int COLLECTION_SPAN_MINUTES = 40;
+
+// Model copies made between two simulation steps
+struct ModelCopy
+{
+    RecyclingModel recycling;
+    LightingModel lighting;
+    QSemaphore ready;
+};
+
+// Independent stream per run, whatever thread picks the run up
+quint32 runSeed(quint32 seed, int run)
+{
+    quint32 h = seed ^ (static_cast<quint32>(run) * 0x9E3779B9u);
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+}
+
+int zoneOf(const QStringList &zoneNames, const QString &name)
+{
+    // Unknown places belong to the city core, as in the stability model
+    return qMax(0, zoneNames.indexOf(name));
+}
+
+WhatIfDistribution distribution(QVector<double> &values)
+{
+    WhatIfDistribution d;
+    if (values.isEmpty()) return d;
+
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    d.mean = sum / values.size();
+
+    auto percentile = [&values](double p) {
+        int index = qBound(0, qRound(p * (values.size() - 1)), values.size() - 1);
+        return values[index];
+    };
+    d.p5 = percentile(0.05);
+    d.p50 = percentile(0.50);
+    d.p95 = percentile(0.95);
+    return d;
+}
+}
+
+WhatIfSimulator::WhatIfSimulator(SimulationThread *simulation, QObject *parent)
+    : QThread(parent)
+    , m_simulation(simulation)
+    , m_nextRun(0)
+{
+}
+
+WhatIfSimulator::~WhatIfSimulator()
+{
+    requestInterruption();
+    wait();
+}
+
+bool WhatIfSimulator::runScenario(const WhatIfScenario &scenario)
+{
+    if (isRunning()) return false;
+
+    // The stability tables are GUI-thread state, so they are forked here
+    CityStabilityModel *stability = CityStabilityModel::instance();
+    m_fork.zoneNames = stability->zoneNames();
+    m_fork.risk = stability->riskState();
+    m_fork.baseline = stability->baselineState();
+    m_fork.startMinute = QTime::currentTime().msecsSinceStartOfDay() / 60000;
+
+    m_scenario = scenario;
+    m_report = WhatIfReport();
+    start();
+    return true;
+}
+
+bool WhatIfSimulator::forkModels()
+{
+    // Shared with the command, which may outlive a timed-out wait
+    QSharedPointer<ModelCopy> copy(new ModelCopy);
+    m_simulation->post([copy](RecyclingModel &recycling, LightingModel &lighting) {
+        copy->recycling = recycling;
+        copy->lighting = lighting;
+        copy->ready.release();
+    });
+    if (!copy->ready.tryAcquire(1, FORK_TIMEOUT_MS)) return false;
+
+    m_fork.recycling = copy->recycling;
+    m_fork.lighting = copy->lighting;
+
+    m_fork.binZone.resize(m_fork.recycling.binCount());
+    for (int bin = 0; bin < m_fork.recycling.binCount(); ++bin) {
+        m_fork.binZone[bin] = zoneOf(m_fork.zoneNames, m_fork.recycling.binLocation(bin));
+    }
+    m_fork.poleZone.resize(m_fork.lighting.poleCount());
+    for (int pole = 0; pole < m_fork.lighting.poleCount(); ++pole) {
+        m_fork.poleZone[pole] = zoneOf(m_fork.zoneNames, m_fork.lighting.poleLocation(pole));
+    }
+    return true;
+}
+
+void WhatIfSimulator::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!forkModels()) return;
+
+    const int runs = qMax(0, m_scenario.runs);
+    m_outcomes.resize(runs);
+    m_nextRun.store(0, std::memory_order_relaxed);
+
+    // Workers pull run indices until none are left; each writes its own slot
+    WhatIfOutcome *outcomes = m_outcomes.data();
+    const int threads = qBound(1, QThread::idealThreadCount(), qMax(1, runs));
+    QVector<QThread *> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.append(QThread::create([this, outcomes, runs]() {
+            for (;;) {
+                int index = m_nextRun.fetch_add(1, std::memory_order_relaxed);
+                if (index >= runs || isInterruptionRequested()) break;
+                outcomes[index] = simulate(m_fork, m_scenario, index);
+            }
+        }));
+        workers.last()->start();
+    }
+    for (QThread *worker : workers) {
+        worker->wait();
+        delete worker;
+    }
+
+    if (isInterruptionRequested()) return;
+    summarize(timer.elapsed(), threads);
+}
+
+WhatIfOutcome WhatIfSimulator::simulate(const CityFork &fork, const WhatIfScenario &scenario, int run)
+{
+    const int factors = CityStabilityModel::RISK_FACTOR_COUNT;
+    double weights[CityStabilityModel::RISK_FACTOR_COUNT];
+    for (int f = 0; f < factors; ++f) {
+        weights[f] = CityStabilityModel::factorWeight(static_cast<CityStabilityModel::RiskFactor>(f));
+    }
+
+    // Copy-on-write forks; the first write detaches this run's copy
+    RecyclingModel recycling = fork.recycling;
+    LightingModel lighting = fork.lighting;
+    QVector<double> risk = fork.risk;
+    QRandomGenerator rng(runSeed(scenario.seed, run));
+
+    double penalty = 0.0;
+    for (int i = 0; i < risk.size(); ++i) penalty += risk[i] * weights[i % factors];
+    auto raise = [&](int zone, int factor, double delta) {
+        risk[zone * factors + factor] += delta;
+        penalty += delta * weights[factor];
+    };
+
+    // Each event starts somewhere in its jitter window
+    const int steps = scenario.hours * 3600 / STEP_SECONDS;
+    QVector<int> eventStep(scenario.events.size());
+    for (int e = 0; e < scenario.events.size(); ++e) {
+        const WhatIfEvent &event = scenario.events[e];
+        int jitter = event.jitterMinutes > 0
+                ? rng.bounded(2 * event.jitterMinutes + 1) - event.jitterMinutes : 0;
+        int minute = qRound(event.startHour * 60.0) + jitter;
+        eventStep[e] = qMax(0, minute * 60 / STEP_SECONDS);
+    }
+
+    QVector<int> collectAt(recycling.binCount(), -1);
+    const double startWh = lighting.consumedWh();
+    const double recoveryStep = RECOVERY_PER_SECOND * STEP_SECONDS;
+
+    WhatIfOutcome outcome;
+    outcome.minScore = 100.0;
+    outcome.minutesUnstable = 0.0;
+    outcome.overflows = 0;
+    double scoreSum = 0.0;
+
+    for (int step = 0; step < steps; ++step) {
+        for (int e = 0; e < scenario.events.size(); ++e) {
+            if (eventStep[e] != step) continue;
+            const WhatIfEvent &event = scenario.events[e];
+            switch (event.type) {
+            case WhatIfEvent::LightingFailure:
+                for (int pole = 0; pole < lighting.poleCount(); ++pole) {
+                    if (lighting.poleLocation(pole) != event.zone || !lighting.isPoleActive(pole)) continue;
+                    lighting.setPoleFailed(pole);
+                    raise(fork.poleZone[pole], CityStabilityModel::EnergyRisk, POLE_FAILURE_RISK);
+                }
+                break;
+            case WhatIfEvent::BinOverflowWave:
+                for (int bin = 0; bin < recycling.binCount(); ++bin) {
+                    if (rng.generateDouble() < event.magnitude) recycling.setFillLevel(bin, 100.0);
+                }
+                break;
+            case WhatIfEvent::CyberAttack:
+                raise(zoneOf(fork.zoneNames, event.zone), CityStabilityModel::CyberRisk, event.magnitude);
+                break;
+            }
+        }
+
+        int hourOfDay = ((fork.startMinute + step * STEP_SECONDS / 60) / 60) % 24;
+        recycling.step(STEP_SECONDS, rng);
+        lighting.step(STEP_SECONDS, hourOfDay, rng);
+
+        for (int bin = 0; bin < recycling.binCount(); ++bin) {
+            if (collectAt[bin] < 0) {
+                if (recycling.fillLevel(bin) < 100.0) continue;
+                ++outcome.overflows;
+                raise(fork.binZone[bin], CityStabilityModel::WasteRisk, OVERFLOW_RISK);
+                int minutes = COLLECTION_MIN_MINUTES + rng.bounded(COLLECTION_SPAN_MINUTES + 1);
+                collectAt[bin] = step + minutes * 60 / STEP_SECONDS;
+            } else if (step >= collectAt[bin]) {
+                recycling.setFillLevel(bin, 0.0);
+                collectAt[bin] = -1;
+            }
+        }
+
+        for (int i = 0; i < risk.size(); ++i) {
+            double excess = risk[i] - fork.baseline[i];
+            if (excess <= 0.0) continue;
+            double drop = qMin(recoveryStep, excess);
+            risk[i] -= drop;
+            penalty -= drop * weights[i % factors];
+        }
+
+        double score = qBound(0.0, 100.0 - penalty, 100.0);
+        outcome.minScore = qMin(outcome.minScore, score);
+        scoreSum += score;
+        if (score < STABLE_SCORE) outcome.minutesUnstable += STEP_SECONDS / 60.0;
+    }
+
+    outcome.meanScore = steps > 0 ? scoreSum / steps : 100.0;
+    outcome.energyKWh = (lighting.consumedWh() - startWh) / 1000.0;
+    return outcome;
+}
+
+void WhatIfSimulator::summarize(qint64 wallMs, int threads)
+{
+    const int runs = m_outcomes.size();
+    QVector<double> minScore(runs), meanScore(runs), unstable(runs), overflows(runs), energy(runs);
+    int critical = 0;
+    for (int i = 0; i < runs; ++i) {
+        const WhatIfOutcome &outcome = m_outcomes[i];
+        minScore[i] = outcome.minScore;
+        meanScore[i] = outcome.meanScore;
+        unstable[i] = outcome.minutesUnstable;
+        overflows[i] = outcome.overflows;
+        energy[i] = outcome.energyKWh;
+        if (outcome.minScore < CRITICAL_SCORE) ++critical;
+    }
+
+    WhatIfReport report;
+    report.name = m_scenario.name;
+    report.runs = runs;
+    report.hours = m_scenario.hours;
+    report.seed = m_scenario.seed;
+    report.minScore = distribution(minScore);
+    report.meanScore = distribution(meanScore);
+    report.minutesUnstable = distribution(unstable);
+    report.overflows = distribution(overflows);
+    report.energyKWh = distribution(energy);
+    report.criticalProbability = runs > 0 ? static_cast<double>(critical) / runs : 0.0;
+    report.wallMs = wallMs;
+    report.threads = threads;
+    report.valid = runs > 0;
+    m_report = report;
+}
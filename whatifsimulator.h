@@ -0,0 +1,132 @@
+#ifndef WHATIFSIMULATOR_H
+#define WHATIFSIMULATOR_H
+
+#include <QThread>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include "recyclingmodel.h"
+#include "lightingmodel.h"
+
+class SimulationThread;
+
+// Copy of the live city a batch of scenarios starts from. The models and
+// risk tables are implicitly shared, so every run forks it for free and
+// only detaches what it writes.
+struct CityFork
+{
+    RecyclingModel recycling;
+    LightingModel lighting;
+    QStringList zoneNames;
+    QVector<double> risk;        // [zone * RISK_FACTOR_COUNT + factor]
+    QVector<double> baseline;
+    QVector<int> binZone;
+    QVector<int> poleZone;
+    int startMinute = 0;         // minute of the day at the fork
+};
+
+// Something that goes wrong during a scenario
+struct WhatIfEvent
+{
+    enum Type {
+        LightingFailure,     // every pole in the zone fails
+        BinOverflowWave,     // each bin overflows with probability magnitude
+        CyberAttack          // magnitude cyber risk in the zone
+    };
+
+    Type type;
+    double startHour;        // hours after the fork
+    int jitterMinutes;       // start drawn uniformly within +/- this
+    QString zone;
+    double magnitude;
+};
+
+struct WhatIfScenario
+{
+    QString name;
+    int hours = 24;
+    int runs = 1000;
+    quint32 seed = 1;
+    QVector<WhatIfEvent> events;
+};
+
+// One Monte-Carlo run
+struct WhatIfOutcome
+{
+    double minScore;
+    double meanScore;
+    double minutesUnstable;  // below STABLE_SCORE
+    int overflows;
+    double energyKWh;
+};
+
+struct WhatIfDistribution
+{
+    double mean = 0.0;
+    double p5 = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+};
+
+struct WhatIfReport
+{
+    QString name;
+    int runs = 0;
+    int hours = 0;
+    quint32 seed = 0;
+    WhatIfDistribution minScore;
+    WhatIfDistribution meanScore;
+    WhatIfDistribution minutesUnstable;
+    WhatIfDistribution overflows;
+    WhatIfDistribution energyKWh;
+    double criticalProbability = 0.0;   // runs whose score fell below CRITICAL_SCORE
+    qint64 wallMs = 0;
+    int threads = 0;
+    bool valid = false;
+};
+
+// Runs what-if scenarios against a fork of the live city. The fork takes
+// the stability tables on the GUI thread and the device models from the
+// simulation thread; each run then advances its own copy of the real
+// models in STEP_SECONDS steps, applies the scenario's events and the
+// security center's responses (risk on pole failure and overflow, crews
+// emptying full bins, recovery toward baseline) and scores the city the
+// way the stability model does. Runs are spread over every core, and run
+// i is seeded from (seed, i) alone, so a batch is reproducible whatever
+// the thread count.
+class WhatIfSimulator : public QThread
+{
+public:
+    explicit WhatIfSimulator(SimulationThread *simulation, QObject *parent = nullptr);
+    ~WhatIfSimulator();
+
+    // GUI thread; false while the previous batch is still running
+    bool runScenario(const WhatIfScenario &scenario);
+    // GUI thread, once finished() has fired
+    WhatIfReport report() const { return m_report; }
+
+    // One run of a scenario from a fork; pure, safe on any thread
+    static WhatIfOutcome simulate(const CityFork &fork, const WhatIfScenario &scenario, int run);
+
+    static const int STEP_SECONDS = 10;
+    static const int STABLE_SCORE = 75;
+    static const int CRITICAL_SCORE = 50;
+    static const int FORK_TIMEOUT_MS = 5000;
+
+protected:
+    void run() override;
+
+private:
+    bool forkModels();
+    void summarize(qint64 wallMs, int threads);
+
+    SimulationThread *m_simulation;
+    CityFork m_fork;
+    WhatIfScenario m_scenario;
+    QVector<WhatIfOutcome> m_outcomes;
+    std::atomic<int> m_nextRun;
+    WhatIfReport m_report;
+};
+
+#endif // WHATIFSIMULATOR_H